@@ -0,0 +1,35 @@
+# Runs a single benchmark scene and compares its metrics with the checked-in baseline.
+# Called by ctest as: cmake -DFIREWORKS=... -DPERF_COMPARE=... -DBASELINE=... -DSCENE=... -DFRAMES=... -DOUTPUT=... -P
+# With -DUPDATE=ON the measured values are written into the baseline instead.
+
+foreach (variable FIREWORKS PERF_COMPARE BASELINE SCENE FRAMES OUTPUT)
+    if (NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is not set")
+    endif ()
+endforeach ()
+
+get_filename_component(OUTPUT_DIRECTORY "${OUTPUT}" DIRECTORY)
+file(MAKE_DIRECTORY "${OUTPUT_DIRECTORY}")
+
+execute_process(
+    COMMAND "${FIREWORKS}" --benchmark ${SCENE} --frames ${FRAMES} --metrics "${OUTPUT}"
+    RESULT_VARIABLE BENCHMARK_RESULT
+)
+if (NOT BENCHMARK_RESULT EQUAL 0)
+    message(FATAL_ERROR "Benchmark of ${SCENE} failed: ${BENCHMARK_RESULT}")
+endif ()
+
+set(COMPARE_ARGUMENTS "${BASELINE}" ${SCENE} "${OUTPUT}")
+if (UPDATE)
+    list(APPEND COMPARE_ARGUMENTS --update)
+endif ()
+
+execute_process(
+    COMMAND "${PERF_COMPARE}" ${COMPARE_ARGUMENTS}
+    RESULT_VARIABLE COMPARE_RESULT
+)
+if (NOT COMPARE_RESULT EQUAL 0)
+    message(FATAL_ERROR "${SCENE} regressed against ${BASELINE}.\n"
+            "If the change is intended, or the values were never recorded, record them on the reference machine with:\n"
+            "  cmake --build <build directory> --target perf_baseline")
+endif ()
@@ -0,0 +1,51 @@
+# Renders a video wall with one headless fireworks_cpp per window, stitches their captures and checks that the windows
+# line up at the seams.
+# Called by ctest as: cmake -DFIREWORKS=... -DSTITCH=... -DCHECK=... -DGRID=<c>x<r> -DFRAMES=... -DOUTPUT=... -P
+
+foreach (variable FIREWORKS STITCH CHECK GRID FRAMES OUTPUT)
+    if (NOT DEFINED ${variable})
+        message(FATAL_ERROR "${variable} is not set")
+    endif ()
+endforeach ()
+
+string(REPLACE "x" ";" GRID_SIZE "${GRID}")
+list(GET GRID_SIZE 0 COLUMNS)
+list(GET GRID_SIZE 1 ROWS)
+math(EXPR LAST_COLUMN "${COLUMNS} - 1")
+math(EXPR LAST_ROW "${ROWS} - 1")
+
+file(REMOVE_RECURSE "${OUTPUT}")
+file(MAKE_DIRECTORY "${OUTPUT}")
+string(RANDOM LENGTH 8 ALPHABET 0123456789abcdef WALL_SUFFIX)
+
+# The commands of one execute_process run at the same time, which the windows of a wall have to. Nothing is written
+# to stdout, so chaining their standard streams does not matter.
+set(WINDOW_COMMANDS)
+set(CAPTURES)
+foreach (ROW RANGE ${LAST_ROW})
+    foreach (COLUMN RANGE ${LAST_COLUMN})
+        set(CAPTURE "${OUTPUT}/tile_${COLUMN}_${ROW}.y4m")
+        list(APPEND WINDOW_COMMANDS
+             COMMAND "${FIREWORKS}" --headless --offline --quit-after ${FRAMES} --capture "${CAPTURE}"
+                     --wall /fireworks_wall_test_${WALL_SUFFIX} --wall-grid ${GRID} --wall-tile ${COLUMN},${ROW}
+                     --generate tapers --count 20000 --seed 7)
+        list(APPEND CAPTURES "${CAPTURE}")
+    endforeach ()
+endforeach ()
+
+execute_process(${WINDOW_COMMANDS} RESULTS_VARIABLE WINDOW_RESULTS)
+foreach (WINDOW_RESULT IN LISTS WINDOW_RESULTS)
+    if (NOT WINDOW_RESULT EQUAL 0)
+        message(FATAL_ERROR "A window of the video wall failed: ${WINDOW_RESULTS}")
+    endif ()
+endforeach ()
+
+execute_process(COMMAND "${STITCH}" ${GRID} "${OUTPUT}/wall.y4m" ${CAPTURES} RESULT_VARIABLE STITCH_RESULT)
+if (NOT STITCH_RESULT EQUAL 0)
+    message(FATAL_ERROR "Stitching the captures failed: ${STITCH_RESULT}")
+endif ()
+
+execute_process(COMMAND "${CHECK}" ${GRID} "${OUTPUT}/wall.y4m" RESULT_VARIABLE CHECK_RESULT)
+if (NOT CHECK_RESULT EQUAL 0)
+    message(FATAL_ERROR "The windows of the video wall do not line up, see ${OUTPUT}/wall.y4m")
+endif ()
@@ -0,0 +1,21 @@
+// Written once per frame, see frame_constants_t in frame_constants.hpp. std140, keep both in sync.
+uniform frame_constants {
+    mat4 projection_matrix;
+    // Window size in pixels
+    vec2 viewport_size;
+    // Simulation time in seconds
+    float time;
+    uint frame_index;
+    vec3 background_color;
+    float star_density;
+    // 0 when bloom is disabled
+    float bloom_intensity;
+    // 0 unless the lines are aggregated into densities
+    float density_exposure;
+    // Window pixels of a video wall canvas to the left of and below this window
+    vec2 canvas_offset;
+    // From the world the lines live in to window coordinates
+    mat4 view_matrix;
+    // 1 when the lines fade out their own edges
+    float analytic_antialiasing;
+};
@@ -0,0 +1,11 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+namespace allocation_counter {
+// Number of calls to the global operator new since the start of the program, on all threads.
+[[nodiscard]] std::uint64_t allocations() noexcept;
+}
+
+#endif //ALLOCATION_COUNTER_HPP
@@ -0,0 +1,118 @@
+#include "benchmark.hpp"
+
+#include "globals.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <utility>
+
+using namespace std::string_view_literals;
+
+struct scene_description_t {
+    std::string_view m_name;
+    std::size_t m_line_count;
+    float m_star_density;
+    std::size_t m_lines_per_frame;
+    float m_fading_lifetime;
+};
+
+constexpr std::array<scene_description_t, 5> scene_descriptions = {{
+    {"lines_1k"sv, 1'000, 0.1f, 0, 0.0f},
+    {"lines_100k"sv, 100'000, 0.1f, 0, 0.0f},
+    {"lines_1m"sv, 1'000'000, 0.1f, 0, 0.0f},
+    // Lines that never fade, with lines that fade in half a second added behind them every frame, as when drawing
+    // with a lifetime over a finished picture. The fading ones have to be retired while the others stay.
+    {"lines_mixed"sv, 100'000, 0.1f, 1'000, 0.5f},
+    {"starfield"sv, 0, 0.5f, 0, 0.0f},
+}};
+
+// Fractional part of i * step. Low discrepancy, so the lines cover the window evenly without a random generator.
+float sequence(std::size_t i, double step) {
+    const auto value = static_cast<double>(i) * step;
+    return static_cast<float>(value - std::floor(value));
+}
+
+// The i-th line of a scene. Spread over every layer, batching has to keep the draw calls flat regardless.
+line benchmark_line(std::size_t i, const glm::vec2& window_size, float spawn_time, float lifetime) {
+    const glm::vec2 start{sequence(i, 0.6180339887) * window_size.x, sequence(i, 0.7548776662) * window_size.y};
+    const auto angle = sequence(i, 0.5698402910) * 6.2831853f;
+    const auto length = 20.0f + sequence(i, 0.4301597090) * 80.0f;
+    const auto end = start + glm::vec2{std::cos(angle), std::sin(angle)} * length;
+    const glm::vec3 color{sequence(i, 0.1234567), sequence(i, 0.3456789), sequence(i, 0.5678901)};
+
+    return {start, end, color, 10.0f, 4.0f, line_blend_t::max, static_cast<int>(i % max_line_layers), spawn_time,
+            lifetime};
+}
+
+benchmark_scene_t create_benchmark_scene(std::string_view name, const glm::vec2& window_size) noexcept {
+    for (const auto& description : scene_descriptions) {
+        if (description.m_name != name) {
+            continue;
+        }
+
+        line_storage_t lines;
+        lines.reserve(description.m_line_count);
+        for (std::size_t i = 0; i < description.m_line_count; i++) {
+            lines.push_back(benchmark_line(i, window_size, 0.0f, 0.0f));
+        }
+
+        return {line_scene_t(std::move(lines)), description.m_star_density, description.m_lines_per_frame,
+                description.m_fading_lifetime, window_size, description.m_line_count};
+    }
+
+    std::cerr << "Unknown benchmark scene " << name << ", expected one of:";
+    for (const auto& description : scene_descriptions) {
+        std::cerr << " " << description.m_name;
+    }
+    std::cerr << "\n";
+    std::exit(EXIT_FAILURE);
+}
+
+void advance_benchmark_scene(benchmark_scene_t& scene, float time) {
+    scene.m_lines.retire(time);
+
+    for (std::size_t i = 0; i < scene.m_lines_per_frame; i++) {
+        const auto lifetime = i == scene.m_lines_per_frame / 2 ? 0.0f : scene.m_fading_lifetime;
+        scene.m_lines.add(benchmark_line(scene.m_next_line++, scene.m_window_size, time, lifetime));
+    }
+}
+
+void write_benchmark_metrics(std::ostream& stream,
+                             std::string_view scene,
+                             int frames,
+                             std::span<const benchmark_metric_t> metrics) {
+    stream << "{\n";
+    stream << "  \"scene\": \"" << scene << "\",\n";
+    stream << "  \"frames\": " << frames << ",\n";
+    stream << "  \"metrics\": {";
+    for (std::size_t i = 0; i < metrics.size(); i++) {
+        stream << (i == 0 ? "\n" : ",\n") << "    \"" << metrics[i].m_name << "\": " << metrics[i].m_value;
+    }
+    stream << "\n  }\n}\n";
+}
+
+bool write_benchmark_metrics(std::string_view path,
+                             std::string_view scene,
+                             int frames,
+                             std::span<const benchmark_metric_t> metrics) noexcept {
+    if (path.empty()) {
+        write_benchmark_metrics(std::cout, scene, frames, metrics);
+        return true;
+    }
+
+    std::ofstream file{std::string(path)};
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    write_benchmark_metrics(file, scene, frames, metrics);
+
+    return file.good();
+}
@@ -0,0 +1,44 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <glm/glm.hpp>
+
+#include "line_scene.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+// Frames are rendered at fixed steps of simulation time, so the scenes that change do so the same way in every run.
+constexpr float benchmark_time_step = 1.0f / 60.0f;
+
+struct benchmark_scene_t {
+    line_scene_t m_lines;
+    float m_star_density;
+    // Lines added by every frame, all fading but one that never does, and how long the fading ones live.
+    std::size_t m_lines_per_frame = 0;
+    float m_fading_lifetime = 0.0f;
+    glm::vec2 m_window_size{0.0f};
+    std::size_t m_next_line = 0;
+};
+
+struct benchmark_metric_t {
+    const char* m_name;
+    double m_value;
+};
+
+// Builds one of the fixed synthetic scenes (lines_1k, lines_100k, lines_1m, lines_mixed or starfield).
+// The lines only depend on the scene name and the window size, so every run draws the same thing.
+// Exits with a message on an unknown scene.
+[[nodiscard]] benchmark_scene_t create_benchmark_scene(std::string_view name, const glm::vec2& window_size) noexcept;
+
+// Retires the lines that have faded out at the given time and adds the lines of the frame drawn at it.
+void advance_benchmark_scene(benchmark_scene_t& scene, float time);
+
+// Writes the metrics as a JSON object, to stdout if path is empty. Returns false if the file could not be written.
+bool write_benchmark_metrics(std::string_view path,
+                             std::string_view scene,
+                             int frames,
+                             std::span<const benchmark_metric_t> metrics) noexcept;
+
+#endif //BENCHMARK_HPP
@@ -0,0 +1,30 @@
+#include "camera.hpp"
+
+#include "globals.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+
+glm::mat4 camera_t::view_matrix() const noexcept {
+    const auto scale = glm::scale(glm::mat4(1.0f), glm::vec3(m_zoom, m_zoom, 1.0f));
+    return glm::translate(scale, glm::vec3(-m_position, 0.0f));
+}
+
+void camera_t::pan(const glm::vec2& screen_delta) noexcept {
+    m_position -= screen_delta / m_zoom;
+}
+
+camera_t camera_t::fitting(const glm::vec2& world_size, const glm::vec2& window_size) noexcept {
+    camera_t camera;
+    camera.m_zoom = std::clamp(std::min(window_size.x / world_size.x, window_size.y / world_size.y), min_camera_zoom,
+                               max_camera_zoom);
+    camera.m_position = (world_size - window_size / camera.m_zoom) * 0.5f;
+    return camera;
+}
+
+void camera_t::zoom_at(const glm::vec2& screen_point, float factor) noexcept {
+    const auto anchor = screen_to_world(screen_point);
+    m_zoom = std::clamp(m_zoom * factor, min_camera_zoom, max_camera_zoom);
+    m_position = anchor - screen_point / m_zoom;
+}
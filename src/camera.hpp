@@ -0,0 +1,47 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <glm/glm.hpp>
+
+// Maps the world the lines live in onto the window. The default camera shows the world in window pixels.
+class camera_t {
+    // World point at the top left corner of the window.
+    glm::vec2 m_position{0.0f, 0.0f};
+    // Window pixels per world unit.
+    float m_zoom = 1.0f;
+
+public:
+    [[nodiscard]] constexpr const glm::vec2& position() const noexcept { return m_position; }
+    [[nodiscard]] constexpr float zoom() const noexcept { return m_zoom; }
+
+    // From world coordinates to window pixels.
+    [[nodiscard]] glm::mat4 view_matrix() const noexcept;
+
+    [[nodiscard]] constexpr glm::vec2 screen_to_world(const glm::vec2& point) const noexcept {
+        return m_position + point / m_zoom;
+    }
+
+    [[nodiscard]] constexpr glm::vec2 world_to_screen(const glm::vec2& point) const noexcept {
+        return (point - m_position) * m_zoom;
+    }
+
+    // The same view moved by a distance in window pixels, for a window that shows another part of the canvas.
+    [[nodiscard]] constexpr camera_t shifted(const glm::vec2& screen_offset) const noexcept {
+        auto camera = *this;
+        camera.m_position += screen_offset / m_zoom;
+        return camera;
+    }
+
+    // Moves the world along with the mouse by a distance in window pixels.
+    void pan(const glm::vec2& screen_delta) noexcept;
+
+    // Zooms by factor while keeping the world point under screen_point in place.
+    void zoom_at(const glm::vec2& screen_point, float factor) noexcept;
+
+    bool operator==(const camera_t&) const = default;
+
+    // Shows all of the world from the origin to world_size, as large as it fits and centered in the window.
+    [[nodiscard]] static camera_t fitting(const glm::vec2& world_size, const glm::vec2& window_size) noexcept;
+};
+
+#endif //CAMERA_HPP
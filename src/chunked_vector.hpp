@@ -0,0 +1,213 @@
+#ifndef CHUNKED_VECTOR_HPP
+#define CHUNKED_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+// A sequence stored in chunks of ChunkSize elements that are never moved once constructed.
+// Growing past the last chunk allocates one more chunk instead of reallocating and copying everything, so appending
+// takes a bounded time and references to elements stay valid until they are erased.
+// Elements can also be erased from the front, in FIFO order. Chunks emptied that way are reused at the back, so a
+// sequence that is appended to and erased from at the same rate stays within the same memory.
+template<typename T, std::size_t ChunkSize>
+class chunked_vector_t {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "Indexing relies on a power of two");
+
+    // Uninitialized storage of ChunkSize elements each. The m_size elements from position m_first on are constructed.
+    std::vector<T*> m_chunks;
+    std::size_t m_first = 0;
+    std::size_t m_size = 0;
+
+    static T* allocate_chunk() {
+        return static_cast<T*>(::operator new(ChunkSize * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    static void deallocate_chunk(T* chunk) noexcept {
+        ::operator delete(chunk, std::align_val_t(alignof(T)));
+    }
+
+    // The constructed elements of a chunk, as offsets within it.
+    [[nodiscard]] std::pair<std::size_t, std::size_t> chunk_range(std::size_t chunk) const noexcept {
+        const auto first = chunk == 0 ? m_first : 0;
+        const auto last = std::min(ChunkSize, m_first + m_size - chunk * ChunkSize);
+        return {first, last};
+    }
+
+    void release_chunks() noexcept {
+        for (auto* chunk : m_chunks) {
+            deallocate_chunk(chunk);
+        }
+        m_chunks.clear();
+    }
+
+    template<typename TValue>
+    class iterator_t {
+        friend class chunked_vector_t;
+
+        T* const* m_chunks;
+        std::size_t m_index;
+
+        iterator_t(T* const* chunks, std::size_t index) noexcept : m_chunks(chunks), m_index(index) {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = TValue*;
+        using reference = TValue&;
+
+        iterator_t() noexcept : m_chunks(nullptr), m_index(0) {}
+
+        reference operator*() const noexcept { return m_chunks[m_index / ChunkSize][m_index % ChunkSize]; }
+        pointer operator->() const noexcept { return &**this; }
+
+        iterator_t& operator++() noexcept {
+            m_index++;
+            return *this;
+        }
+
+        iterator_t operator++(int) noexcept {
+            auto previous = *this;
+            m_index++;
+            return previous;
+        }
+
+        bool operator==(const iterator_t& other) const noexcept { return m_index == other.m_index; }
+    };
+
+public:
+    static constexpr std::size_t chunk_size = ChunkSize;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = iterator_t<T>;
+    using const_iterator = iterator_t<const T>;
+
+    chunked_vector_t() = default;
+
+    chunked_vector_t(const chunked_vector_t&) = delete;
+
+    chunked_vector_t& operator=(const chunked_vector_t&) = delete;
+
+    chunked_vector_t(chunked_vector_t&& other) noexcept
+        : m_chunks(std::move(other.m_chunks)),
+          m_first(std::exchange(other.m_first, 0)),
+          m_size(std::exchange(other.m_size, 0)) {
+        other.m_chunks.clear();
+    }
+
+    chunked_vector_t& operator=(chunked_vector_t&& other) noexcept {
+        if (this != &other) {
+            clear();
+            release_chunks();
+            m_chunks = std::move(other.m_chunks);
+            m_first = std::exchange(other.m_first, 0);
+            m_size = std::exchange(other.m_size, 0);
+            other.m_chunks.clear();
+        }
+        return *this;
+    }
+
+    ~chunked_vector_t() noexcept {
+        clear();
+        release_chunks();
+    }
+
+    template<typename... TArguments>
+    T& emplace_back(TArguments&&... arguments) {
+        if (m_size == capacity()) {
+            m_chunks.push_back(allocate_chunk());
+        }
+
+        const auto position = m_first + m_size;
+        auto* element = std::construct_at(&m_chunks[position / ChunkSize][position % ChunkSize],
+                                          std::forward<TArguments>(arguments)...);
+        m_size++;
+        return *element;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+
+    // Allocates the chunks for count elements up front, so appending up to it never allocates.
+    void reserve(std::size_t count) {
+        m_chunks.reserve((m_first + count + ChunkSize - 1) / ChunkSize);
+        while (capacity() < count) {
+            m_chunks.push_back(allocate_chunk());
+        }
+    }
+
+    // Appends copies of value until there are count elements, or destroys the elements past count.
+    void resize(std::size_t count, const T& value) {
+        reserve(count);
+        while (m_size > count) {
+            m_size--;
+            std::destroy_at(&(*this)[m_size]);
+        }
+        while (m_size < count) {
+            emplace_back(value);
+        }
+    }
+
+    // Destroys the first count elements. The ones after them keep their addresses.
+    void erase_front(std::size_t count) noexcept {
+        for (std::size_t i = 0; i < count; i++) {
+            std::destroy_at(&(*this)[i]);
+        }
+        m_size -= count;
+        if (m_size == 0) {
+            m_first = 0;
+            return;
+        }
+
+        // Emptied chunks go to the back, where they are filled again.
+        m_first += count;
+        std::rotate(m_chunks.begin(), m_chunks.begin() + static_cast<std::ptrdiff_t>(m_first / ChunkSize), m_chunks.end());
+        m_first %= ChunkSize;
+    }
+
+    // Destroys the elements but keeps the chunks for reuse.
+    void clear() noexcept {
+        erase_front(m_size);
+    }
+
+    [[nodiscard]] T& operator[](std::size_t index) noexcept {
+        const auto position = m_first + index;
+        return m_chunks[position / ChunkSize][position % ChunkSize];
+    }
+
+    [[nodiscard]] const T& operator[](std::size_t index) const noexcept {
+        const auto position = m_first + index;
+        return m_chunks[position / ChunkSize][position % ChunkSize];
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return m_chunks.size() * ChunkSize - m_first; }
+
+    // The number of chunks holding elements. Every chunk but the first and the last is full.
+    [[nodiscard]] std::size_t chunk_count() const noexcept { return (m_first + m_size + ChunkSize - 1) / ChunkSize; }
+
+    // The elements of a chunk, contiguous in memory. Chunks can be worked on in parallel.
+    [[nodiscard]] std::span<T> chunk(std::size_t chunk) noexcept {
+        const auto [first, last] = chunk_range(chunk);
+        return {m_chunks[chunk] + first, last - first};
+    }
+
+    [[nodiscard]] std::span<const T> chunk(std::size_t chunk) const noexcept {
+        const auto [first, last] = chunk_range(chunk);
+        return {m_chunks[chunk] + first, last - first};
+    }
+
+    [[nodiscard]] iterator begin() noexcept { return {m_chunks.data(), m_first}; }
+    [[nodiscard]] iterator end() noexcept { return {m_chunks.data(), m_first + m_size}; }
+    [[nodiscard]] const_iterator begin() const noexcept { return {m_chunks.data(), m_first}; }
+    [[nodiscard]] const_iterator end() const noexcept { return {m_chunks.data(), m_first + m_size}; }
+};
+
+#endif //CHUNKED_VECTOR_HPP
@@ -0,0 +1,119 @@
+#include "damage_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+damage_rect_t bounding_rect(const damage_rect_t& a, const damage_rect_t& b) {
+    return {glm::min(a.m_min, b.m_min), glm::max(a.m_max, b.m_max)};
+}
+}
+
+damage_rect_t damage_rect_t::around_segment(const glm::vec2& start,
+                                            const glm::vec2& end,
+                                            float width,
+                                            float margin) noexcept {
+    const auto extent = width * 0.5f + margin;
+    const auto min = glm::min(start, end) - glm::vec2(extent);
+    const auto max = glm::max(start, end) + glm::vec2(extent);
+    return {{static_cast<int>(std::floor(min.x)), static_cast<int>(std::floor(min.y))},
+            {static_cast<int>(std::ceil(max.x)) + 1, static_cast<int>(std::ceil(max.y)) + 1}};
+}
+
+void damage_t::add(const damage_rect_t& rect) noexcept {
+    if (m_full || rect.empty()) {
+        return;
+    }
+
+    if (m_count < max_rects) {
+        m_rects[m_count++] = rect;
+        return;
+    }
+
+    auto best = 0;
+    auto best_growth = std::numeric_limits<long long>::max();
+    for (auto i = 0; i < m_count; i++) {
+        const auto growth = bounding_rect(m_rects[i], rect).area() - m_rects[i].area();
+        if (growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    m_rects[best] = bounding_rect(m_rects[best], rect);
+}
+
+void damage_t::add(const damage_t& other) noexcept {
+    if (other.m_full) {
+        m_full = true;
+        return;
+    }
+
+    for (const auto& rect : other.rects()) {
+        add(rect);
+    }
+}
+
+damage_rect_t damage_t::bounds() const noexcept {
+    if (m_count == 0) {
+        return {};
+    }
+
+    auto bounds = m_rects[0];
+    for (const auto& rect : rects().subspan(1)) {
+        bounds = bounding_rect(bounds, rect);
+    }
+    return bounds;
+}
+
+float damage_t::coverage(const glm::ivec2& window_size) const noexcept {
+    const auto window_area = static_cast<float>(window_size.x) * static_cast<float>(window_size.y);
+    if (m_full || window_area <= 0.0f) {
+        return 1.0f;
+    }
+
+    long long area = 0;
+    for (const auto& rect : rects()) {
+        area += rect.area();
+    }
+    return std::min(static_cast<float>(area) / window_area, 1.0f);
+}
+
+damage_tracker_t::damage_tracker_t() noexcept {
+    // Nothing has been drawn yet.
+    m_frame.add_full();
+    for (auto& damage : m_history) {
+        damage.add_full();
+    }
+}
+
+void damage_tracker_t::set_window_size(const glm::ivec2& window_size) noexcept {
+    if (window_size != m_window_size) {
+        m_window_size = window_size;
+        m_frame.add_full();
+    }
+}
+
+void damage_tracker_t::add(const damage_rect_t& rect) noexcept {
+    m_frame.add({glm::max(rect.m_min, glm::ivec2(0)), glm::min(rect.m_max, m_window_size)});
+}
+
+damage_t damage_tracker_t::buffer_damage(int buffer_age) const noexcept {
+    auto damage = m_frame;
+    if (buffer_age <= 0 || buffer_age > max_buffer_age) {
+        damage.add_full();
+        return damage;
+    }
+
+    // A buffer of age 1 holds the previous frame, which only misses this frame's damage.
+    for (auto i = 0; i < buffer_age - 1; i++) {
+        damage.add(m_history[i]);
+    }
+    return damage;
+}
+
+void damage_tracker_t::end_frame() noexcept {
+    std::shift_right(m_history.begin(), m_history.end(), 1);
+    m_history[0] = m_frame;
+    m_frame = {};
+}
@@ -0,0 +1,91 @@
+#ifndef DAMAGE_TRACKER_HPP
+#define DAMAGE_TRACKER_HPP
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <span>
+
+// Window pixels from m_min up to but not including m_max, y pointing down.
+struct damage_rect_t {
+    glm::ivec2 m_min;
+    glm::ivec2 m_max;
+
+    [[nodiscard]] constexpr bool empty() const noexcept { return m_min.x >= m_max.x || m_min.y >= m_max.y; }
+
+    [[nodiscard]] constexpr long long area() const noexcept {
+        return empty() ? 0 : static_cast<long long>(m_max.x - m_min.x) * (m_max.y - m_min.y);
+    }
+
+    // Covers the line from start to end, width wide, grown by margin on every side.
+    [[nodiscard]] static damage_rect_t around_segment(const glm::vec2& start,
+                                                      const glm::vec2& end,
+                                                      float width,
+                                                      float margin = 0.0f) noexcept;
+};
+
+// The parts of a frame that have to be redrawn. A few rectangles, or everything.
+class damage_t {
+public:
+    static constexpr int max_rects = 8;
+
+private:
+    std::array<damage_rect_t, max_rects> m_rects{};
+    int m_count = 0;
+    bool m_full = false;
+
+public:
+    // Merges the rectangle into the one it grows the least once all are in use.
+    void add(const damage_rect_t& rect) noexcept;
+
+    void add(const damage_t& other) noexcept;
+
+    void add_full() noexcept { m_full = true; }
+
+    [[nodiscard]] constexpr bool full() const noexcept { return m_full; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return !m_full && m_count == 0; }
+
+    [[nodiscard]] std::span<const damage_rect_t> rects() const noexcept { return std::span(m_rects).first(m_count); }
+
+    // The smallest rectangle around all of them. Meaningless when full.
+    [[nodiscard]] damage_rect_t bounds() const noexcept;
+
+    // Fraction of the window that is redrawn, overlapping rectangles counted twice.
+    [[nodiscard]] float coverage(const glm::ivec2& window_size) const noexcept;
+};
+
+// Collects the damage of every frame and keeps that of the last few, so a back buffer that still holds an older
+// frame can be brought up to date without redrawing all of it.
+class damage_tracker_t {
+public:
+    // Back buffers older than this are redrawn completely.
+    static constexpr int max_buffer_age = 4;
+
+private:
+    glm::ivec2 m_window_size{0, 0};
+    damage_t m_frame;
+    // The damage of the previous frames, most recent first.
+    std::array<damage_t, max_buffer_age - 1> m_history;
+
+public:
+    damage_tracker_t() noexcept;
+
+    // Everything is damaged when the size changes.
+    void set_window_size(const glm::ivec2& window_size) noexcept;
+
+    // Clipped to the window.
+    void add(const damage_rect_t& rect) noexcept;
+
+    void add_full() noexcept { m_frame.add_full(); }
+
+    // What changed since the previous frame.
+    [[nodiscard]] const damage_t& frame_damage() const noexcept { return m_frame; }
+
+    // What changed since the frame in a back buffer of the given age. Age 0 means the contents are unknown.
+    [[nodiscard]] damage_t buffer_damage(int buffer_age) const noexcept;
+
+    // Moves the frame damage into the history.
+    void end_frame() noexcept;
+};
+
+#endif //DAMAGE_TRACKER_HPP
@@ -0,0 +1,25 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+
+frame_arena_t::frame_arena_t(std::size_t capacity, std::pmr::memory_resource* upstream)
+    : m_buffer(std::make_unique_for_overwrite<std::byte[]>(capacity)), m_capacity(capacity), m_overflow(upstream) {
+}
+
+void* frame_arena_t::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* pointer = m_buffer.get() + m_used;
+    auto space = m_capacity - m_used;
+    if (std::align(alignment, bytes, pointer, space) == nullptr) {
+        m_overflows++;
+        return m_overflow.allocate(bytes, alignment);
+    }
+
+    m_used = m_capacity - space + bytes;
+    m_high_water_mark = std::max(m_high_water_mark, m_used);
+    return pointer;
+}
+
+void frame_arena_t::reset() noexcept {
+    m_used = 0;
+    m_overflow.release();
+}
@@ -0,0 +1,48 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+// Bump allocator for memory that only lives until the end of the frame.
+// reset() at the start of every frame releases everything at once, deallocating does nothing.
+// Requests that do not fit in the buffer go to the upstream resource and are counted, so the capacity can be tuned.
+class frame_arena_t final : public std::pmr::memory_resource {
+    std::unique_ptr<std::byte[]> m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    std::size_t m_high_water_mark = 0;
+    std::uint64_t m_overflows = 0;
+    // Holds the overflow until the next reset.
+    std::pmr::monotonic_buffer_resource m_overflow;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    // Allocates the buffer up front, throws std::bad_alloc if that fails.
+    explicit frame_arena_t(std::size_t capacity,
+                           std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    frame_arena_t(const frame_arena_t&) = delete;
+
+    frame_arena_t& operator=(const frame_arena_t&) = delete;
+
+    void reset() noexcept;
+
+    [[nodiscard]] constexpr std::size_t used() const noexcept { return m_used; }
+    [[nodiscard]] constexpr std::size_t capacity() const noexcept { return m_capacity; }
+    [[nodiscard]] constexpr std::size_t high_water_mark() const noexcept { return m_high_water_mark; }
+    // Number of allocations that did not fit, since the start of the program.
+    [[nodiscard]] constexpr std::uint64_t overflows() const noexcept { return m_overflows; }
+};
+
+#endif //FRAME_ARENA_HPP
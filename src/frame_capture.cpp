@@ -0,0 +1,355 @@
+#include "frame_capture.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+constexpr std::array<std::uint32_t, 256> crc_table = [] {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; i++) {
+        auto crc = i;
+        for (auto bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+std::uint32_t crc32(std::uint32_t crc, std::span<const std::uint8_t> data) {
+    crc = ~crc;
+    for (auto byte : data) {
+        crc = crc_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::uint32_t adler32(std::span<const std::uint8_t> data) {
+    constexpr std::uint32_t modulus = 65521;
+    // The sums can go 5552 bytes before they have to be reduced.
+    constexpr std::size_t block_size = 5552;
+
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (std::size_t start = 0; start < data.size(); start += block_size) {
+        const auto end = std::min(start + block_size, data.size());
+        for (auto i = start; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= modulus;
+        b %= modulus;
+    }
+    return b << 16 | a;
+}
+
+void append_big_endian(std::vector<std::uint8_t>& buffer, std::uint32_t value) {
+    buffer.push_back(static_cast<std::uint8_t>(value >> 24));
+    buffer.push_back(static_cast<std::uint8_t>(value >> 16));
+    buffer.push_back(static_cast<std::uint8_t>(value >> 8));
+    buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Fills in the length of the chunk that starts at length_offset and appends its CRC.
+void finish_png_chunk(std::vector<std::uint8_t>& buffer, std::size_t length_offset) {
+    const auto type_offset = length_offset + 4;
+    const auto length = static_cast<std::uint32_t>(buffer.size() - type_offset - 4);
+    buffer[length_offset] = static_cast<std::uint8_t>(length >> 24);
+    buffer[length_offset + 1] = static_cast<std::uint8_t>(length >> 16);
+    buffer[length_offset + 2] = static_cast<std::uint8_t>(length >> 8);
+    buffer[length_offset + 3] = static_cast<std::uint8_t>(length);
+
+    const auto crc = crc32(0, std::span(buffer).subspan(type_offset));
+    append_big_endian(buffer, crc);
+}
+
+std::size_t begin_png_chunk(std::vector<std::uint8_t>& buffer, const char (&type)[5]) {
+    const auto length_offset = buffer.size();
+    append_big_endian(buffer, 0);
+    buffer.insert(buffer.end(), type, type + 4);
+    return length_offset;
+}
+
+int close_file(std::FILE* file) {
+    return file == stdout ? std::fflush(file) : std::fclose(file);
+}
+}
+
+frame_encoder_t::frame_encoder_t(capture_format_t format,
+                                 const glm::ivec2& size,
+                                 std::string_view path,
+                                 file_t file) noexcept
+    : m_format(format), m_size(size), m_path(path), m_file(std::move(file)) {
+    m_thread = std::jthread([this] { encoder_main(); });
+}
+
+frame_encoder_t::~frame_encoder_t() noexcept {
+    m_stopping.store(true, std::memory_order_relaxed);
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_one();
+    m_thread.join();
+}
+
+void frame_encoder_t::submit(std::span<const std::uint8_t> pixels) noexcept {
+    const auto frame = m_submitted.load(std::memory_order_relaxed);
+    m_frames[frame % max_frames] = pixels;
+    // Publishes the slot to the encoder thread.
+    m_submitted.store(frame + 1, std::memory_order_release);
+
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_one();
+}
+
+void frame_encoder_t::wait_written(std::uint64_t count) const noexcept {
+    for (auto written = m_written.load(std::memory_order_acquire); written < count;
+         written = m_written.load(std::memory_order_acquire)) {
+        m_written.wait(written, std::memory_order_acquire);
+    }
+}
+
+void frame_encoder_t::finish() noexcept {
+    wait_written(submitted());
+    if (m_file) {
+        std::fflush(m_file.get());
+    }
+}
+
+void frame_encoder_t::encoder_main() noexcept {
+    TRACE_THREAD_NAME("capture encoder");
+
+    for (;;) {
+        // Read before checking for frames, so a submission in between changes it and the wait returns immediately.
+        const auto epoch = m_epoch.load(std::memory_order_acquire);
+        const auto frame = m_written.load(std::memory_order_relaxed);
+
+        if (frame < m_submitted.load(std::memory_order_acquire)) {
+            const auto pixels = m_frames[frame % max_frames];
+            {
+                TRACE_ZONE("encode frame");
+                switch (m_format) {
+                    case capture_format_t::png:
+                        write_png(pixels, frame);
+                        break;
+
+                    case capture_format_t::y4m:
+                        write_y4m(pixels);
+                        break;
+
+                    case capture_format_t::raw:
+                        write_raw(pixels);
+                        break;
+                }
+            }
+
+            // Hands the slot and the pixels back.
+            m_written.store(frame + 1, std::memory_order_release);
+            m_written.notify_all();
+        } else if (m_stopping.load(std::memory_order_relaxed)) {
+            return;
+        } else {
+            m_epoch.wait(epoch, std::memory_order_acquire);
+        }
+    }
+}
+
+void frame_capture_t::capture() noexcept {
+    // Hand over whatever has been read back in the meantime.
+    release_written();
+    while (submit_next(false)) {
+    }
+
+    if (m_ring.full()) {
+        if (!m_wait) {
+            // Stalling here would show up as a hitch, losing a frame of the recording is the lesser evil.
+            m_dropped++;
+            return;
+        }
+
+        // The oldest buffer frees up once the encoder has written it.
+        if (m_ring.mapped() == 0 && !submit_next(true)) {
+            std::cerr << "Failed to read back a captured frame" << std::endl;
+            m_dropped++;
+            return;
+        }
+        m_encoder->wait_written(m_released + 1);
+        release_written();
+    }
+
+    m_ring.read_back_buffer();
+}
+
+void frame_capture_t::finish() noexcept {
+    while (m_ring.mapped() < m_ring.pending()) {
+        if (!submit_next(true)) {
+            std::cerr << "Failed to read back a captured frame" << std::endl;
+            break;
+        }
+    }
+
+    m_encoder->finish();
+    release_written();
+}
+
+void frame_capture_t::release_written() noexcept {
+    for (const auto written = m_encoder->written(); m_released < written; m_released++) {
+        m_ring.unmap_oldest();
+    }
+}
+
+bool frame_capture_t::submit_next(bool wait) noexcept {
+    const auto pixels = m_ring.try_map_next(wait);
+    if (!pixels) {
+        return false;
+    }
+
+    m_encoder->submit(*pixels);
+    return true;
+}
+
+void frame_encoder_t::write_png(std::span<const std::uint8_t> pixels, std::uint64_t frame) noexcept {
+    const auto size = m_size;
+    const auto row_size = static_cast<std::size_t>(size.x) * 3 + 1;
+
+    // Filter type 0 scanlines, top row first, alpha dropped.
+    m_pixels.resize(row_size * static_cast<std::size_t>(size.y));
+    for (auto y = 0; y < size.y; y++) {
+        auto destination = m_pixels.data() + static_cast<std::size_t>(y) * row_size;
+        auto source = pixels.data() + static_cast<std::size_t>(size.y - 1 - y) * static_cast<std::size_t>(size.x) * 4;
+        *destination++ = 0;
+        for (auto x = 0; x < size.x; x++) {
+            *destination++ = source[0];
+            *destination++ = source[1];
+            *destination++ = source[2];
+            source += 4;
+        }
+    }
+
+    m_encoded.clear();
+    constexpr std::array<std::uint8_t, 8> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    m_encoded.insert(m_encoded.end(), signature.begin(), signature.end());
+
+    auto chunk = begin_png_chunk(m_encoded, "IHDR");
+    append_big_endian(m_encoded, static_cast<std::uint32_t>(size.x));
+    append_big_endian(m_encoded, static_cast<std::uint32_t>(size.y));
+    // 8 bit RGB, deflate, adaptive filtering, no interlacing.
+    m_encoded.insert(m_encoded.end(), {8, 2, 0, 0, 0});
+    finish_png_chunk(m_encoded, chunk);
+
+    // The image data is stored uncompressed in deflate blocks. Compressing would cost more time than
+    // the bigger files cost disk, and the frames usually go through a video encoder afterwards anyway.
+    chunk = begin_png_chunk(m_encoded, "IDAT");
+    m_encoded.insert(m_encoded.end(), {0x78, 0x01});
+    constexpr std::size_t max_block_size = 65535;
+    for (std::size_t offset = 0; offset < m_pixels.size(); offset += max_block_size) {
+        const auto block_size = std::min(max_block_size, m_pixels.size() - offset);
+        const auto last = offset + block_size == m_pixels.size();
+        m_encoded.push_back(last ? 1 : 0);
+        m_encoded.push_back(static_cast<std::uint8_t>(block_size));
+        m_encoded.push_back(static_cast<std::uint8_t>(block_size >> 8));
+        m_encoded.push_back(static_cast<std::uint8_t>(~block_size));
+        m_encoded.push_back(static_cast<std::uint8_t>(~block_size >> 8));
+        m_encoded.insert(m_encoded.end(), m_pixels.begin() + static_cast<std::ptrdiff_t>(offset),
+                         m_pixels.begin() + static_cast<std::ptrdiff_t>(offset + block_size));
+    }
+    append_big_endian(m_encoded, adler32(m_pixels));
+    finish_png_chunk(m_encoded, chunk);
+
+    chunk = begin_png_chunk(m_encoded, "IEND");
+    finish_png_chunk(m_encoded, chunk);
+
+    // frame.png becomes frame_000000.png, frame_000001.png, ...
+    const auto extension = m_path.find_last_of('.');
+    std::ostringstream path;
+    path << m_path.substr(0, extension) << '_' << std::setw(6) << std::setfill('0') << frame
+         << m_path.substr(extension);
+
+    const auto file = std::fopen(path.str().c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Failed to open file " << path.str() << std::endl;
+        return;
+    }
+    std::fwrite(m_encoded.data(), 1, m_encoded.size(), file);
+    std::fclose(file);
+}
+
+void frame_encoder_t::write_y4m(std::span<const std::uint8_t> pixels) noexcept {
+    const auto size = m_size;
+    const auto plane_size = static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y);
+
+    // BT.601 limited range, which is what encoders assume for Y4M without colour metadata.
+    m_pixels.resize(plane_size * 3);
+    auto y_plane = m_pixels.data();
+    auto u_plane = y_plane + plane_size;
+    auto v_plane = u_plane + plane_size;
+    for (auto y = 0; y < size.y; y++) {
+        auto source = pixels.data() + static_cast<std::size_t>(size.y - 1 - y) * static_cast<std::size_t>(size.x) * 4;
+        for (auto x = 0; x < size.x; x++) {
+            const int r = source[0];
+            const int g = source[1];
+            const int b = source[2];
+            source += 4;
+
+            *y_plane++ = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            *u_plane++ = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            *v_plane++ = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    std::fputs("FRAME\n", m_file.get());
+    std::fwrite(m_pixels.data(), 1, m_pixels.size(), m_file.get());
+}
+
+void frame_encoder_t::write_raw(std::span<const std::uint8_t> pixels) noexcept {
+    const auto size = m_size;
+    const auto row_size = static_cast<std::size_t>(size.x) * 4;
+
+    for (auto y = size.y - 1; y >= 0; y--) {
+        std::fwrite(pixels.data() + static_cast<std::size_t>(y) * row_size, 1, row_size, m_file.get());
+    }
+}
+
+frame_capture_t frame_capture_t::create(std::string_view path,
+                                        const glm::ivec2& size,
+                                        int frame_rate,
+                                        bool wait) noexcept {
+    const auto ends_with = [&](std::string_view extension) {
+        return path.size() >= extension.size() && path.substr(path.size() - extension.size()) == extension;
+    };
+
+    const auto format = path == "-" || ends_with(".y4m") ? capture_format_t::y4m
+                        : ends_with(".png")              ? capture_format_t::png
+                                                         : capture_format_t::raw;
+
+    frame_encoder_t::file_t file{nullptr, close_file};
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        file.reset(stdout);
+    } else if (format != capture_format_t::png) {
+        file.reset(std::fopen(std::string(path).c_str(), "wb"));
+        if (!file) {
+            std::cerr << "Failed to open file " << path << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (format == capture_format_t::y4m) {
+        std::fprintf(file.get(), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444 XCOLORRANGE=LIMITED\n", size.x, size.y,
+                     frame_rate);
+    }
+
+    return frame_capture_t{gl::pixel_buffer_ring_t::create(size),
+                           std::make_unique<frame_encoder_t>(format, size, path, std::move(file)), wait};
+}
@@ -0,0 +1,142 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <glm/glm.hpp>
+
+#include "wrappers/opengl/pixel_buffer_ring.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class capture_format_t {
+    // Numbered RGB PNG files next to the given path.
+    png,
+    // YUV 4:4:4 stream, to a file, a named pipe or stdout.
+    y4m,
+    // Headerless RGBA, top row first.
+    raw
+};
+
+// Converts the read back frames and writes them out on a thread of its own, in the order they were submitted,
+// so neither the encoding nor a slow disk or pipe holds up the render thread.
+class [[nodiscard]] frame_encoder_t {
+public:
+    using file_t = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+    static constexpr int max_frames = gl::pixel_buffer_ring_t::buffers_in_flight;
+
+private:
+    capture_format_t m_format;
+    glm::ivec2 m_size;
+    std::string m_path;
+    file_t m_file;
+
+    // Submitted frames by frame number modulo max_frames. A slot is only reused after its frame has been written.
+    std::array<std::span<const std::uint8_t>, max_frames> m_frames{};
+    std::atomic<std::uint64_t> m_submitted = 0;
+    std::atomic<std::uint64_t> m_written = 0;
+    // Bumped on every submission and on shutdown, the encoder thread sleeps on it.
+    std::atomic<std::uint32_t> m_epoch = 0;
+    std::atomic<bool> m_stopping = false;
+
+    // Only used by the encoder thread, reused between frames so writing does not allocate.
+    std::vector<std::uint8_t> m_pixels;
+    std::vector<std::uint8_t> m_encoded;
+
+    std::jthread m_thread;
+
+    void encoder_main() noexcept;
+
+    void write_png(std::span<const std::uint8_t> pixels, std::uint64_t frame) noexcept;
+
+    void write_y4m(std::span<const std::uint8_t> pixels) noexcept;
+
+    void write_raw(std::span<const std::uint8_t> pixels) noexcept;
+
+public:
+    [[nodiscard]] frame_encoder_t(capture_format_t format,
+                                  const glm::ivec2& size,
+                                  std::string_view path,
+                                  file_t file) noexcept;
+
+    frame_encoder_t(const frame_encoder_t&) = delete;
+
+    frame_encoder_t& operator=(const frame_encoder_t&) = delete;
+
+    // Writes the frames that are still queued before it returns.
+    ~frame_encoder_t() noexcept;
+
+    // Queues a frame of size pixels, RGBA bottom row first. The pixels have to stay valid until written() counts it,
+    // and at most max_frames may be queued at a time.
+    void submit(std::span<const std::uint8_t> pixels) noexcept;
+
+    [[nodiscard]] std::uint64_t submitted() const noexcept { return m_submitted.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] std::uint64_t written() const noexcept { return m_written.load(std::memory_order_acquire); }
+
+    // Blocks until at least count frames have been written.
+    void wait_written(std::uint64_t count) const noexcept;
+
+    // Waits for every queued frame and flushes the output.
+    void finish() noexcept;
+};
+
+// Records the composited frames through a pixel buffer ring and hands them to the encoder once they have been
+// read back. The buffers stay mapped while the encoder reads them, so the pixels are never copied on this thread.
+class [[nodiscard]] frame_capture_t {
+    gl::pixel_buffer_ring_t m_ring;
+    // Declared after the ring, so it has stopped reading the mapped buffers before they are deleted.
+    std::unique_ptr<frame_encoder_t> m_encoder;
+    // Offline captures wait for the oldest frame instead of dropping the new one when the ring is full.
+    bool m_wait;
+    // Frames the encoder has written whose buffers have been released back to the ring.
+    std::uint64_t m_released = 0;
+    std::uint64_t m_dropped = 0;
+
+    [[nodiscard]] frame_capture_t(gl::pixel_buffer_ring_t ring,
+                                  std::unique_ptr<frame_encoder_t> encoder,
+                                  bool wait) noexcept
+        : m_ring(std::move(ring)), m_encoder(std::move(encoder)), m_wait(wait) {
+    }
+
+    // Unmaps the buffers of the frames the encoder is done with.
+    void release_written() noexcept;
+
+    // Hands the oldest frame that has been read back but not submitted to the encoder.
+    // Returns false if there is none or it has not been read back yet.
+    bool submit_next(bool wait) noexcept;
+
+public:
+    frame_capture_t() = delete;
+
+    frame_capture_t(const frame_capture_t&) = delete;
+
+    [[nodiscard]] frame_capture_t(frame_capture_t&&) noexcept = default;
+
+    // Call after the scene has been rendered to the back buffer, before anything that should not be recorded.
+    void capture() noexcept;
+
+    // Waits for and writes every frame still in flight.
+    void finish() noexcept;
+
+    [[nodiscard]] constexpr std::uint64_t written() const noexcept { return m_released; }
+    [[nodiscard]] constexpr std::uint64_t dropped() const noexcept { return m_dropped; }
+
+    // The format is picked from the path: "-" and .y4m stream Y4M, .png writes a sequence, anything else is raw.
+    // Exits with a message if the output cannot be opened.
+    [[nodiscard]] static frame_capture_t create(std::string_view path,
+                                                const glm::ivec2& size,
+                                                int frame_rate,
+                                                bool wait) noexcept;
+};
+
+#endif //FRAME_CAPTURE_HPP
@@ -0,0 +1,46 @@
+#ifndef FRAME_CONSTANTS_HPP
+#define FRAME_CONSTANTS_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// The frame_constants uniform block every shader can include from embed/frame_constants.glsl.
+// Members are in std140 order and offsets, checked below. Keep the padding zeroed, the buffer is only uploaded when
+// the bytes change.
+struct frame_constants_t {
+    glm::mat4 m_projection_matrix{1.0f};
+    glm::vec2 m_viewport_size{0.0f, 0.0f};
+    float m_time = 0.0f;
+    std::uint32_t m_frame_index = 0;
+    // A vec3 starts on 16 bytes and the next float fills the rest of it.
+    glm::vec3 m_background_color{0.0f, 0.0f, 0.0f};
+    // Already scaled by the quality settings.
+    float m_star_density = 0.0f;
+    float m_bloom_intensity = 0.0f;
+    // 0 unless the lines are aggregated into densities.
+    float m_density_exposure = 0.0f;
+    // Window pixels of a video wall canvas to the left of and below this window, 0 outside of one.
+    glm::vec2 m_canvas_offset{0.0f, 0.0f};
+    // From the world the lines live in to window coordinates, the camera. Everything else is in window coordinates.
+    glm::mat4 m_view_matrix{1.0f};
+    // 1 when the lines fade out their own edges, 0 when multisampling or a post pass anti-aliases them.
+    float m_analytic_antialiasing = 0.0f;
+    float m_padding[3] = {};
+};
+
+static_assert(offsetof(frame_constants_t, m_projection_matrix) == 0);
+static_assert(offsetof(frame_constants_t, m_viewport_size) == 64);
+static_assert(offsetof(frame_constants_t, m_time) == 72);
+static_assert(offsetof(frame_constants_t, m_frame_index) == 76);
+static_assert(offsetof(frame_constants_t, m_background_color) == 80);
+static_assert(offsetof(frame_constants_t, m_star_density) == 92);
+static_assert(offsetof(frame_constants_t, m_bloom_intensity) == 96);
+static_assert(offsetof(frame_constants_t, m_density_exposure) == 100);
+static_assert(offsetof(frame_constants_t, m_canvas_offset) == 104);
+static_assert(offsetof(frame_constants_t, m_view_matrix) == 112);
+static_assert(offsetof(frame_constants_t, m_analytic_antialiasing) == 176);
+static_assert(sizeof(frame_constants_t) == 192);
+
+#endif //FRAME_CONSTANTS_HPP
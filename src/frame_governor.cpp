@@ -0,0 +1,110 @@
+#include "frame_governor.hpp"
+
+#include <algorithm>
+
+// Ladders are ordered from the best to the cheapest quality.
+template<typename T, std::size_t N>
+bool step_cheaper(T& value, const std::array<T, N>& ladder) noexcept {
+    for (const auto& rung : ladder) {
+        if (rung < value) {
+            value = rung;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<typename T, std::size_t N>
+bool step_better(T& value, const std::array<T, N>& ladder) noexcept {
+    for (auto it = ladder.rbegin(); it != ladder.rend(); ++it) {
+        if (*it > value) {
+            value = *it;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void frame_governor_t::add_frame(float cpu_time, float gpu_time) noexcept {
+    m_cpu_time_sum += cpu_time;
+    m_gpu_time_sum += gpu_time;
+    m_frames_in_window++;
+
+    if (m_frames_in_window < frames_per_window) {
+        return;
+    }
+
+    m_cpu_time = m_cpu_time_sum / static_cast<float>(m_frames_in_window);
+    m_gpu_time = m_gpu_time_sum / static_cast<float>(m_frames_in_window);
+    m_cpu_time_sum = 0.0f;
+    m_gpu_time_sum = 0.0f;
+    m_frames_in_window = 0;
+
+    if (!m_enabled) {
+        m_over_budget_windows = 0;
+        m_under_budget_windows = 0;
+        return;
+    }
+
+    const auto load = std::max(m_cpu_time, m_gpu_time) / m_target_frame_time;
+
+    if (load > lower_threshold) {
+        m_over_budget_windows++;
+        m_under_budget_windows = 0;
+    } else if (load < raise_threshold) {
+        m_under_budget_windows++;
+        m_over_budget_windows = 0;
+    } else {
+        m_over_budget_windows = 0;
+        m_under_budget_windows = 0;
+    }
+
+    if (m_over_budget_windows >= windows_before_lowering) {
+        lower_quality();
+        m_over_budget_windows = 0;
+    } else if (m_under_budget_windows >= windows_before_raising) {
+        raise_quality();
+        m_under_budget_windows = 0;
+    }
+}
+
+void frame_governor_t::set_max_msaa_samples(int max_msaa_samples) noexcept {
+    m_max_msaa_samples = std::max(max_msaa_samples, 1);
+    m_settings.m_msaa_samples = std::min(m_settings.m_msaa_samples, m_max_msaa_samples);
+}
+
+bool frame_governor_t::lower_quality() noexcept {
+    // MSAA goes first since it is the least visible, the stars go last.
+    if (m_msaa_active && !m_lock_msaa_samples && step_cheaper(m_settings.m_msaa_samples, msaa_sample_counts)) {
+        return true;
+    }
+    if (!m_lock_render_scale && step_cheaper(m_settings.m_render_scale, render_scales)) {
+        return true;
+    }
+    if (!m_lock_star_density && step_cheaper(m_settings.m_star_density_scale, star_density_scales)) {
+        return true;
+    }
+
+    return false;
+}
+
+bool frame_governor_t::raise_quality() noexcept {
+    // The reverse order of lower_quality.
+    if (!m_lock_star_density && step_better(m_settings.m_star_density_scale, star_density_scales)) {
+        return true;
+    }
+    if (!m_lock_render_scale && step_better(m_settings.m_render_scale, render_scales)) {
+        return true;
+    }
+    if (m_msaa_active && !m_lock_msaa_samples && m_settings.m_msaa_samples < m_max_msaa_samples) {
+        auto samples = m_settings.m_msaa_samples;
+        if (step_better(samples, msaa_sample_counts) && samples <= m_max_msaa_samples) {
+            m_settings.m_msaa_samples = samples;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,83 @@
+#ifndef FRAME_GOVERNOR_HPP
+#define FRAME_GOVERNOR_HPP
+
+#include <array>
+
+// Knobs the governor can turn to keep the frame time within budget.
+struct quality_settings_t {
+    // Lines frame buffer size relative to the window.
+    float m_render_scale = 1.0f;
+    // Multiplied with the star density from the debug menu.
+    float m_star_density_scale = 1.0f;
+    // Sample count of the lines frame buffer.
+    int m_msaa_samples = 4;
+
+    bool operator==(const quality_settings_t&) const = default;
+};
+
+// Watches recent CPU and GPU frame times and lowers or raises the quality settings to stay within a target budget.
+// Raising requires a long streak of cheap frames and a much lower load than lowering,
+// so the settings settle instead of oscillating around the budget.
+class frame_governor_t {
+public:
+    static constexpr std::array<float, 4> render_scales = {1.0f, 0.85f, 0.7f, 0.5f};
+    static constexpr std::array<float, 3> star_density_scales = {1.0f, 0.5f, 0.25f};
+    static constexpr std::array<int, 4> msaa_sample_counts = {8, 4, 2, 1};
+
+private:
+    // Frames averaged before each decision.
+    static constexpr int frames_per_window = 30;
+    // Load above which the quality is lowered.
+    static constexpr float lower_threshold = 0.95f;
+    // Load below which the quality is raised.
+    static constexpr float raise_threshold = 0.7f;
+    // Consecutive windows needed before acting.
+    static constexpr int windows_before_lowering = 2;
+    static constexpr int windows_before_raising = 6;
+
+    quality_settings_t m_settings;
+    int m_max_msaa_samples = 4;
+
+    float m_cpu_time_sum = 0.0f;
+    float m_gpu_time_sum = 0.0f;
+    int m_frames_in_window = 0;
+
+    float m_cpu_time = 0.0f;
+    float m_gpu_time = 0.0f;
+
+    int m_over_budget_windows = 0;
+    int m_under_budget_windows = 0;
+
+    bool lower_quality() noexcept;
+
+    bool raise_quality() noexcept;
+
+public:
+    bool m_enabled = true;
+    float m_target_frame_time = 1000.0f / 60.0f;
+
+    bool m_lock_render_scale = false;
+    bool m_lock_star_density = false;
+    bool m_lock_msaa_samples = false;
+    // Whether the lines are multisampled at all. Otherwise the sample count costs nothing and is left alone.
+    bool m_msaa_active = true;
+
+    // Times are in milliseconds.
+    void add_frame(float cpu_time, float gpu_time) noexcept;
+
+    // Clamps the MSAA sample count to what the GL implementation supports.
+    void set_max_msaa_samples(int max_msaa_samples) noexcept;
+
+    [[nodiscard]] constexpr const quality_settings_t& settings() const noexcept { return m_settings; }
+
+    // For manual adjustments from the debug menu. Only meaningful for locked knobs.
+    [[nodiscard]] constexpr quality_settings_t& settings() noexcept { return m_settings; }
+
+    [[nodiscard]] constexpr int max_msaa_samples() const noexcept { return m_max_msaa_samples; }
+
+    // Averages over the last finished window.
+    [[nodiscard]] constexpr float cpu_time() const noexcept { return m_cpu_time; }
+    [[nodiscard]] constexpr float gpu_time() const noexcept { return m_gpu_time; }
+};
+
+#endif //FRAME_GOVERNOR_HPP
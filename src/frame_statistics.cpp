@@ -0,0 +1,144 @@
+#include "frame_statistics.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+void frame_statistics_t::add_frame(const frame_time_t& frame, float refresh_period) noexcept {
+    m_frames[m_next] = frame;
+    m_next = (m_next + 1) % capacity;
+    m_count = std::min(m_count + 1, capacity);
+    m_total_frames++;
+
+    if (refresh_period > 0.0f && frame.m_frame_time > refresh_period * 1.5f) {
+        m_swap_interval_misses++;
+    }
+
+    // Uses the median of the last summary, it moves slowly enough that this does not matter.
+    if (m_summary.m_frame_time.m_p50 > 0.0f && frame.m_frame_time > m_summary.m_frame_time.m_p50 * 2.0f) {
+        m_hitches++;
+    }
+}
+
+percentiles_t frame_statistics_t::compute_percentiles(float frame_time_t::* member) const noexcept {
+    if (m_count == 0) {
+        return {};
+    }
+
+    for (std::size_t i = 0; i < m_count; i++) {
+        m_scratch[i] = m_frames[i].*member;
+    }
+
+    const auto begin = m_scratch.begin();
+    const auto end = m_scratch.begin() + static_cast<std::ptrdiff_t>(m_count);
+
+    // Each selection only partitions the range above the previous one.
+    const auto select = [&](auto first, float percentile) {
+        const auto index = static_cast<std::ptrdiff_t>(percentile * static_cast<float>(m_count - 1));
+        const auto nth = begin + index;
+        std::nth_element(first, nth, end);
+        return nth;
+    };
+
+    percentiles_t result;
+    auto nth = select(begin, 0.50f);
+    result.m_p50 = *nth;
+    nth = select(nth, 0.95f);
+    result.m_p95 = *nth;
+    nth = select(nth, 0.99f);
+    result.m_p99 = *nth;
+    result.m_max = *std::max_element(nth, end);
+
+    return result;
+}
+
+void frame_statistics_t::summarize() noexcept {
+    m_summary.m_cpu_time = compute_percentiles(&frame_time_t::m_cpu_time);
+    m_summary.m_gpu_time = compute_percentiles(&frame_time_t::m_gpu_time);
+    m_summary.m_frame_time = compute_percentiles(&frame_time_t::m_frame_time);
+
+    m_histogram.fill(0.0f);
+    for (std::size_t i = 0; i < m_count; i++) {
+        const auto bin = static_cast<std::size_t>(m_frames[i].m_frame_time / histogram_max_time *
+                                                  static_cast<float>(histogram_bins));
+        m_histogram[std::min(bin, histogram_bins - 1)] += 1.0f;
+    }
+}
+
+const frame_time_t& frame_statistics_t::operator[](std::size_t i) const noexcept {
+    // When the ring is not full yet the oldest frame is at the start.
+    const auto oldest = m_count < capacity ? 0 : m_next;
+    return m_frames[(oldest + i) % capacity];
+}
+
+bool frame_statistics_t::export_to_file(std::string_view path) const noexcept {
+    if (path.ends_with(".json")) {
+        return export_json(path);
+    }
+
+    return export_csv(path);
+}
+
+bool frame_statistics_t::export_csv(std::string_view path) const noexcept {
+    std::ofstream file{std::string(path)};
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    file << "frame,cpu_ms,gpu_ms,frame_ms\n";
+    for (std::size_t i = 0; i < m_count; i++) {
+        const auto& frame = (*this)[i];
+        file << i << ',' << frame.m_cpu_time << ',' << frame.m_gpu_time << ',' << frame.m_frame_time << '\n';
+    }
+
+    return file.good();
+}
+
+void write_percentiles_json(std::ofstream& file, const char* name, const percentiles_t& percentiles) {
+    file << "    \"" << name << "\": {\"p50\": " << percentiles.m_p50 << ", \"p95\": " << percentiles.m_p95
+         << ", \"p99\": " << percentiles.m_p99 << ", \"max\": " << percentiles.m_max << "}";
+}
+
+bool frame_statistics_t::export_json(std::string_view path) const noexcept {
+    std::ofstream file{std::string(path)};
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"total_frames\": " << m_total_frames << ",\n";
+    file << "  \"swap_interval_misses\": " << m_swap_interval_misses << ",\n";
+    file << "  \"hitches\": " << m_hitches << ",\n";
+    file << "  \"summary\": {\n";
+    write_percentiles_json(file, "cpu_ms", m_summary.m_cpu_time);
+    file << ",\n";
+    write_percentiles_json(file, "gpu_ms", m_summary.m_gpu_time);
+    file << ",\n";
+    write_percentiles_json(file, "frame_ms", m_summary.m_frame_time);
+    file << "\n  },\n";
+    file << "  \"frames\": [";
+    for (std::size_t i = 0; i < m_count; i++) {
+        const auto& frame = (*this)[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\"cpu_ms\": " << frame.m_cpu_time << ", \"gpu_ms\": "
+             << frame.m_gpu_time << ", \"frame_ms\": " << frame.m_frame_time << "}";
+    }
+    file << "\n  ]\n}\n";
+
+    return file.good();
+}
+
+std::string replace_extension(std::string_view path, std::string_view extension) {
+    // Only a dot in the file name starts an extension, not one in a directory name.
+    const auto dot = path.rfind('.');
+    const auto separator = path.find_last_of("/\\");
+    if (dot != std::string_view::npos && (separator == std::string_view::npos || dot > separator)) {
+        path = path.substr(0, dot);
+    }
+
+    std::string result(path);
+    result += extension;
+    return result;
+}
@@ -0,0 +1,88 @@
+#ifndef FRAME_STATISTICS_HPP
+#define FRAME_STATISTICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct frame_time_t {
+    // All times are in milliseconds.
+    float m_cpu_time;
+    float m_gpu_time;
+    // Time between the start of this frame and the start of the previous one.
+    float m_frame_time;
+};
+
+struct percentiles_t {
+    float m_p50 = 0.0f;
+    float m_p95 = 0.0f;
+    float m_p99 = 0.0f;
+    float m_max = 0.0f;
+};
+
+struct frame_statistics_summary_t {
+    percentiles_t m_cpu_time;
+    percentiles_t m_gpu_time;
+    percentiles_t m_frame_time;
+};
+
+// Keeps the times of the most recent frames in a fixed size ring and derives percentiles and a histogram from them.
+// Averages hide stutter, percentiles and the hitch counters do not.
+class frame_statistics_t {
+public:
+    static constexpr std::size_t capacity = 1024;
+    static constexpr std::size_t histogram_bins = 40;
+    // Upper edge of the last histogram bin in milliseconds. Slower frames are put in the last bin.
+    static constexpr float histogram_max_time = 50.0f;
+
+private:
+    std::array<frame_time_t, capacity> m_frames{};
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    std::uint64_t m_total_frames = 0;
+
+    // Frames that took longer than one and a half refresh periods, i.e. missed their swap interval.
+    std::uint64_t m_swap_interval_misses = 0;
+    // Frames that took more than twice the median frame time.
+    std::uint64_t m_hitches = 0;
+
+    frame_statistics_summary_t m_summary;
+    std::array<float, histogram_bins> m_histogram{};
+
+    // Scratch space for the percentile selection so that summarizing does not allocate.
+    mutable std::array<float, capacity> m_scratch{};
+
+    [[nodiscard]] percentiles_t compute_percentiles(float frame_time_t::* member) const noexcept;
+
+public:
+    // refresh_period is the display refresh period in milliseconds, or 0 if unknown.
+    void add_frame(const frame_time_t& frame, float refresh_period) noexcept;
+
+    // Recomputes the percentiles and the histogram from the frames in the ring.
+    void summarize() noexcept;
+
+    [[nodiscard]] constexpr const frame_statistics_summary_t& summary() const noexcept { return m_summary; }
+    [[nodiscard]] constexpr const std::array<float, histogram_bins>& histogram() const noexcept { return m_histogram; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return m_count; }
+    [[nodiscard]] constexpr std::uint64_t total_frames() const noexcept { return m_total_frames; }
+    [[nodiscard]] constexpr std::uint64_t swap_interval_misses() const noexcept { return m_swap_interval_misses; }
+    [[nodiscard]] constexpr std::uint64_t hitches() const noexcept { return m_hitches; }
+
+    // Returns the i'th oldest frame in the ring.
+    [[nodiscard]] const frame_time_t& operator[](std::size_t i) const noexcept;
+
+    // Writes the frames in the ring, the format is picked from the file extension (.csv or .json).
+    // Returns false if the file could not be written.
+    bool export_to_file(std::string_view path) const noexcept;
+
+    bool export_csv(std::string_view path) const noexcept;
+
+    bool export_json(std::string_view path) const noexcept;
+};
+
+// The path with its extension replaced by extension, such as ".csv", or added if it has none.
+[[nodiscard]] std::string replace_extension(std::string_view path, std::string_view extension);
+
+#endif //FRAME_STATISTICS_HPP
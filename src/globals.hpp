@@ -5,6 +5,64 @@
 #ifndef GLOBALS_HPP
 #define GLOBALS_HPP
 
-constexpr int multisample_samples = 8;
+// Lines are grouped by layer within each blend mode, layers outside the range are clamped.
+constexpr int max_line_layers = 8;
+
+// Lines per job when building the line instances.
+constexpr int line_batch_grain = 16384;
+
+// Lines per chunk of the line storage. A multiple of the batch grain, so no job spans two chunks.
+constexpr int line_storage_chunk_size = 1 << 16;
+
+// Work groups the line culling compute pass is dispatched with at most, the invocations loop over the rest.
+constexpr unsigned int max_line_cull_work_groups = 65535;
+
+// Window pixels per world unit the camera zooms between.
+constexpr float min_camera_zoom = 1.0f / 64.0f;
+constexpr float max_camera_zoom = 64.0f;
+// Zoom factor of one mouse wheel step.
+constexpr float camera_zoom_step = 1.25f;
+
+// Texels along the side of a baked canvas tile, and of the square atlas the tiles are cached in.
+constexpr int tile_resolution = 256;
+constexpr int tile_atlas_size = 4096;
+// Coarser levels searched for a baked tile to show while a tile is missing.
+constexpr int max_tile_fallback_levels = 4;
+
+// Number of half resolution frame buffers allocated for the bloom mip chain.
+constexpr int max_bloom_levels = 8;
+
+// The simulation is updated at a fixed rate, independent of the display refresh rate.
+constexpr double simulation_rate = 120.0;
+// Maximum number of simulation steps to catch up on in a single frame.
+constexpr int max_simulation_steps = 8;
+
+// Bytes of the per frame arena. Allocations that do not fit still succeed, they are counted as overflows.
+constexpr int frame_arena_size = 1 << 20;
+
+// Events taken off the queue at a time. A high rate mouse queues thousands of motion events per second.
+constexpr int event_batch_size = 256;
+
+// Records in the shared memory ring external producers write lines to, and the most taken out of it per frame.
+constexpr int line_ring_capacity = 1 << 16;
+constexpr int max_ingested_lines_per_frame = 1 << 16;
+
+// Lines the leader of a video wall can add in one frame, more are not seen by the other processes.
+constexpr int video_wall_line_capacity = 1 << 17;
+// Processes a video wall can have, and the seconds they wait for each other before giving up.
+constexpr int max_video_wall_processes = 64;
+constexpr double video_wall_timeout = 10.0;
+
+// Frames the low latency mode lets the driver queue at most.
+constexpr int max_low_latency_frames_in_flight = 3;
+
+// Seconds without resize events before the render targets follow the window size.
+constexpr double resize_settle_time = 0.2;
+
+// Frames between recomputing the frame time percentiles.
+constexpr int statistics_summary_interval = 30;
+
+// Frames rendered before a benchmark starts measuring, so buffers and render targets have reached their size.
+constexpr int benchmark_warmup_frames = 10;
 
 #endif //GLOBALS_HPP
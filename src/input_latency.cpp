@@ -0,0 +1,77 @@
+#include "input_latency.hpp"
+
+#include <algorithm>
+
+void input_latency_t::add_event(std::uint32_t timestamp) noexcept {
+    if (m_frame.m_event_count < max_frame_events) {
+        m_frame.m_timestamps[m_frame.m_event_count++] = timestamp;
+    }
+}
+
+void input_latency_t::end_frame(std::uint64_t frame) noexcept {
+    if (m_frame.m_event_count == 0) {
+        return;
+    }
+
+    // The frame fences keep no more frames in flight than this, so only a stalled GPU gets here.
+    if (m_pending_count == max_pending_frames) {
+        m_oldest = (m_oldest + 1) % max_pending_frames;
+        m_pending_count--;
+        m_lost_frames++;
+    }
+
+    m_frame.m_frame = frame;
+    m_pending[(m_oldest + m_pending_count) % max_pending_frames] = m_frame;
+    m_pending_count++;
+    m_frame.m_event_count = 0;
+}
+
+void input_latency_t::frames_completed(std::uint64_t frame, std::uint32_t time) noexcept {
+    while (m_pending_count > 0 && m_pending[m_oldest].m_frame <= frame) {
+        const auto& pending = m_pending[m_oldest];
+        for (std::size_t i = 0; i < pending.m_event_count; i++) {
+            // The clock wraps after 49 days, unsigned subtraction gets that right.
+            m_latencies[m_next] = static_cast<float>(time - pending.m_timestamps[i]);
+            m_next = (m_next + 1) % capacity;
+            m_count = std::min(m_count + 1, capacity);
+            m_total_events++;
+        }
+
+        m_oldest = (m_oldest + 1) % max_pending_frames;
+        m_pending_count--;
+    }
+}
+
+void input_latency_t::summarize() noexcept {
+    m_summary = {};
+    m_histogram.fill(0.0f);
+    if (m_count == 0) {
+        return;
+    }
+
+    std::copy_n(m_latencies.begin(), m_count, m_scratch.begin());
+    const auto begin = m_scratch.begin();
+    const auto end = m_scratch.begin() + static_cast<std::ptrdiff_t>(m_count);
+
+    // Each selection only partitions the range above the previous one.
+    const auto select = [&](auto first, float percentile) {
+        const auto index = static_cast<std::ptrdiff_t>(percentile * static_cast<float>(m_count - 1));
+        const auto nth = begin + index;
+        std::nth_element(first, nth, end);
+        return nth;
+    };
+
+    auto nth = select(begin, 0.50f);
+    m_summary.m_p50 = *nth;
+    nth = select(nth, 0.95f);
+    m_summary.m_p95 = *nth;
+    nth = select(nth, 0.99f);
+    m_summary.m_p99 = *nth;
+    m_summary.m_max = *std::max_element(nth, end);
+
+    for (std::size_t i = 0; i < m_count; i++) {
+        const auto bin = static_cast<std::size_t>(m_latencies[i] / histogram_max_latency *
+                                                  static_cast<float>(histogram_bins));
+        m_histogram[std::min(bin, histogram_bins - 1)] += 1.0f;
+    }
+}
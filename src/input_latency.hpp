@@ -0,0 +1,72 @@
+#ifndef INPUT_LATENCY_HPP
+#define INPUT_LATENCY_HPP
+
+#include "frame_statistics.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Time from input events to the GPU finishing the swap of the frame that handled them, the closest to input to photon
+// that can be measured without a camera. Each frame holds on to the timestamps of its events until its fence signals,
+// then the latencies go into a fixed size ring that percentiles and a histogram are derived from.
+class input_latency_t {
+public:
+    static constexpr std::size_t capacity = 1024;
+    static constexpr std::size_t histogram_bins = 40;
+    // Upper edge of the last histogram bin in milliseconds. Slower events are put in the last bin.
+    static constexpr float histogram_max_latency = 100.0f;
+
+    // Frames that can wait for their fence at once, and events measured per frame. The later events of a busy frame
+    // are not measured, they would have the lowest latencies of it.
+    static constexpr std::size_t max_pending_frames = 8;
+    static constexpr std::size_t max_frame_events = 64;
+
+private:
+    struct pending_frame_t {
+        std::uint64_t m_frame;
+        std::size_t m_event_count;
+        // In milliseconds, on the clock of the SDL event timestamps.
+        std::array<std::uint32_t, max_frame_events> m_timestamps;
+    };
+
+    std::array<pending_frame_t, max_pending_frames> m_pending{};
+    std::size_t m_oldest = 0;
+    std::size_t m_pending_count = 0;
+    // The frame being built, it goes into the pending ring when it is swapped.
+    pending_frame_t m_frame{};
+
+    std::array<float, capacity> m_latencies{};
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    std::uint64_t m_total_events = 0;
+    // Frames that were retired before their events could be measured, because too many were pending.
+    std::uint64_t m_lost_frames = 0;
+
+    percentiles_t m_summary;
+    std::array<float, histogram_bins> m_histogram{};
+
+    // Scratch space for the percentile selection so that summarizing does not allocate.
+    std::array<float, capacity> m_scratch{};
+
+public:
+    // An input event handled in the frame being built.
+    void add_event(std::uint32_t timestamp) noexcept;
+
+    // The frame being built was swapped as frame. Frames without input events are not kept.
+    void end_frame(std::uint64_t frame) noexcept;
+
+    // The GPU finished every frame up to frame at time, on the clock of the event timestamps.
+    void frames_completed(std::uint64_t frame, std::uint32_t time) noexcept;
+
+    // Recomputes the percentiles and the histogram from the latencies in the ring.
+    void summarize() noexcept;
+
+    [[nodiscard]] constexpr const percentiles_t& summary() const noexcept { return m_summary; }
+    [[nodiscard]] constexpr const std::array<float, histogram_bins>& histogram() const noexcept { return m_histogram; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return m_count; }
+    [[nodiscard]] constexpr std::uint64_t total_events() const noexcept { return m_total_events; }
+    [[nodiscard]] constexpr std::uint64_t lost_frames() const noexcept { return m_lost_frames; }
+};
+
+#endif //INPUT_LATENCY_HPP
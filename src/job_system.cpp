@@ -0,0 +1,204 @@
+#include "job_system.hpp"
+#include "trace.hpp"
+
+namespace {
+// Index of the worker the calling thread belongs to. Threads outside the job system count as worker 0.
+thread_local std::size_t current_worker_index = 0;
+
+// Spins before an idle worker goes to sleep, jobs tend to arrive in bursts within a frame.
+constexpr int idle_spins = 64;
+}
+
+bool job_deque_t::push(job_t* job) noexcept {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed);
+    const auto top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= capacity) {
+        return false;
+    }
+
+    m_jobs[bottom % capacity].store(job, std::memory_order_relaxed);
+    // Publishes the job, and the slot it points to, to the thieves.
+    m_bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+bool job_deque_t::full() const noexcept {
+    return m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_acquire) >= capacity;
+}
+
+job_t* job_deque_t::pop() noexcept {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto job = m_jobs[bottom % capacity].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // The last job, a thief may be taking it at the same time.
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+job_t* job_deque_t::steal() noexcept {
+    auto top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    const auto job = m_jobs[top % capacity].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        // Lost the race against the owner or another thief.
+        return nullptr;
+    }
+    return job;
+}
+
+struct job_system_t::worker_t {
+    job_deque_t m_deque;
+    // Jobs are stored here and the deque holds pointers to them. A slot is only reused after twice the deque
+    // capacity more jobs have been queued on this worker, by then the job has long been taken.
+    std::array<job_t, 2 * job_deque_t::capacity> m_jobs;
+    std::size_t m_next_job = 0;
+
+    std::atomic<std::uint64_t> m_busy_nanoseconds = 0;
+    std::uint64_t m_sampled_busy_nanoseconds = 0;
+};
+
+job_system_t::job_system_t(std::size_t worker_count) : m_last_sample(std::chrono::steady_clock::now()) {
+    worker_count = std::max<std::size_t>(worker_count, 1);
+
+    m_workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; i++) {
+        m_workers.push_back(std::make_unique<worker_t>());
+    }
+    m_utilization.resize(worker_count);
+
+    m_threads.reserve(worker_count - 1);
+    for (std::size_t i = 1; i < worker_count; i++) {
+        m_threads.emplace_back([this, i] { worker_main(i); });
+    }
+}
+
+job_system_t::~job_system_t() {
+    // Released by the epoch bump as well, a worker that sees the new epoch also sees that it has to stop.
+    m_stopping.store(true, std::memory_order_release);
+    wake_workers();
+    m_threads.clear();
+}
+
+void job_system_t::submit(const job_t& job) noexcept {
+    auto& worker = *m_workers[current_worker_index];
+    if (worker.m_deque.full()) {
+        // The job is run right away instead, without taking a slot. Slots have to stay in use as long as the jobs
+        // queued before them, a thief may still be reading one it has just taken.
+        auto unqueued = job;
+        execute(&unqueued, worker);
+        return;
+    }
+
+    auto& slot = worker.m_jobs[worker.m_next_job++ % worker.m_jobs.size()];
+    slot = job;
+    // Cannot fail, only the owner pushes and the deque had room.
+    static_cast<void>(worker.m_deque.push(&slot));
+}
+
+void job_system_t::wake_workers() noexcept {
+    m_work_epoch.fetch_add(1, std::memory_order_release);
+    m_work_epoch.notify_all();
+}
+
+job_t* job_system_t::find_job(std::size_t worker_index) noexcept {
+    if (const auto job = m_workers[worker_index]->m_deque.pop()) {
+        return job;
+    }
+
+    for (std::size_t i = 1; i < m_workers.size(); i++) {
+        if (const auto job = m_workers[(worker_index + i) % m_workers.size()]->m_deque.steal()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void job_system_t::execute(job_t* job, worker_t& worker) noexcept {
+    // Copied, the slot may be reused once the counter reaches zero.
+    const auto [function, context, begin, end, counter] = *job;
+
+    TRACE_ZONE("job");
+    const auto start = std::chrono::steady_clock::now();
+    function(context, begin, end);
+    const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    worker.m_busy_nanoseconds.fetch_add(static_cast<std::uint64_t>(busy.count()), std::memory_order_relaxed);
+
+    counter->m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+void job_system_t::worker_main(std::size_t worker_index) noexcept {
+    current_worker_index = worker_index;
+    TRACE_THREAD_NAME("worker");
+    auto& worker = *m_workers[worker_index];
+
+    auto spins = 0;
+    while (true) {
+        // Read before looking for jobs, so a submission in between changes it and the wait returns immediately.
+        const auto epoch = m_work_epoch.load(std::memory_order_acquire);
+        // Checked after the epoch is read, so a stop requested after this point has bumped the epoch past it.
+        if (m_stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        if (const auto job = find_job(worker_index)) {
+            execute(job, worker);
+            spins = 0;
+        } else if (spins < idle_spins) {
+            std::this_thread::yield();
+            spins++;
+        } else {
+            m_work_epoch.wait(epoch, std::memory_order_acquire);
+            spins = 0;
+        }
+    }
+}
+
+void job_system_t::wait(const job_counter_t& counter) noexcept {
+    const auto worker_index = current_worker_index;
+    auto& worker = *m_workers[worker_index];
+
+    while (!counter.done()) {
+        if (const auto job = find_job(worker_index)) {
+            execute(job, worker);
+        } else {
+            // The remaining jobs are running on other workers.
+            std::this_thread::yield();
+        }
+    }
+}
+
+void job_system_t::sample_utilization() noexcept {
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last_sample).count();
+    m_last_sample = now;
+    if (elapsed <= 0) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < m_workers.size(); i++) {
+        auto& worker = *m_workers[i];
+        const auto busy = worker.m_busy_nanoseconds.load(std::memory_order_relaxed);
+        m_utilization[i] = std::min(static_cast<float>(busy - worker.m_sampled_busy_nanoseconds) /
+                                    static_cast<float>(elapsed), 1.0f);
+        worker.m_sampled_busy_nanoseconds = busy;
+    }
+}
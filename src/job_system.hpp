@@ -0,0 +1,135 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Number of jobs of a group that have not finished yet.
+class job_counter_t {
+    friend class job_system_t;
+
+    std::atomic<std::size_t> m_pending = 0;
+
+public:
+    [[nodiscard]] bool done() const noexcept { return m_pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Runs function(m_context, m_begin, m_end) and then counts down m_counter.
+struct job_t {
+    void (*m_function)(const void* context, std::size_t begin, std::size_t end) noexcept;
+    const void* m_context;
+    std::size_t m_begin;
+    std::size_t m_end;
+    job_counter_t* m_counter;
+};
+
+// Chase-Lev work stealing deque of a fixed size.
+// The owning worker pushes and pops at the bottom, the other workers steal from the top.
+class job_deque_t {
+public:
+    static constexpr std::int64_t capacity = 4096;
+
+private:
+    alignas(64) std::atomic<std::int64_t> m_top = 0;
+    alignas(64) std::atomic<std::int64_t> m_bottom = 0;
+    std::array<std::atomic<job_t*>, capacity> m_jobs{};
+
+public:
+    // Only fails when the deque is full.
+    [[nodiscard]] bool push(job_t* job) noexcept;
+
+    // Only exact on the owning worker, the thieves can only make room.
+    [[nodiscard]] bool full() const noexcept;
+
+    [[nodiscard]] job_t* pop() noexcept;
+
+    [[nodiscard]] job_t* steal() noexcept;
+};
+
+// Work stealing thread pool. Every worker has a deque, and idle workers steal from the others.
+// Worker 0 is the thread that created the job system. It has no thread of its own but runs jobs while it waits,
+// so jobs may only be submitted from that thread or from inside other jobs.
+class job_system_t {
+    struct worker_t;
+
+    std::vector<std::unique_ptr<worker_t>> m_workers;
+    std::vector<std::jthread> m_threads;
+    // Bumped whenever jobs are submitted, idle workers sleep on it.
+    std::atomic<std::uint32_t> m_work_epoch = 0;
+    std::atomic<bool> m_stopping = false;
+
+    std::chrono::steady_clock::time_point m_last_sample;
+    std::vector<float> m_utilization;
+
+    template<typename TFunction>
+    static void invoke(const void* context, std::size_t begin, std::size_t end) noexcept {
+        (*static_cast<const TFunction*>(context))(begin, end);
+    }
+
+    void submit(const job_t& job) noexcept;
+
+    void wake_workers() noexcept;
+
+    [[nodiscard]] job_t* find_job(std::size_t worker_index) noexcept;
+
+    void execute(job_t* job, worker_t& worker) noexcept;
+
+    void worker_main(std::size_t worker_index) noexcept;
+
+public:
+    explicit job_system_t(std::size_t worker_count = std::thread::hardware_concurrency());
+
+    job_system_t(const job_system_t&) = delete;
+
+    job_system_t& operator=(const job_system_t&) = delete;
+
+    ~job_system_t();
+
+    [[nodiscard]] std::size_t worker_count() const noexcept { return m_workers.size(); }
+
+    // Splits [begin, end) into chunks of grain indices and queues a call of function(chunk_begin, chunk_end) for each.
+    // function has to outlive the jobs, wait on counter before it goes out of scope.
+    template<typename TFunction>
+    void run(job_counter_t& counter,
+             std::size_t begin,
+             std::size_t end,
+             std::size_t grain,
+             const TFunction& function) noexcept {
+        if (begin >= end) {
+            return;
+        }
+
+        grain = std::max<std::size_t>(grain, 1);
+        counter.m_pending.fetch_add((end - begin + grain - 1) / grain, std::memory_order_relaxed);
+        for (auto chunk_begin = begin; chunk_begin < end; chunk_begin += std::min(grain, end - chunk_begin)) {
+            submit({&invoke<TFunction>, &function, chunk_begin, chunk_begin + std::min(grain, end - chunk_begin),
+                    &counter});
+        }
+        wake_workers();
+    }
+
+    // Runs queued jobs until every job of counter has finished.
+    void wait(const job_counter_t& counter) noexcept;
+
+    template<typename TFunction>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const TFunction& function) noexcept {
+        job_counter_t counter;
+        run(counter, begin, end, grain, function);
+        wait(counter);
+    }
+
+    // Updates the fraction of the time since the previous call that each worker spent running jobs.
+    void sample_utilization() noexcept;
+
+    [[nodiscard]] std::span<const float> utilization() const noexcept { return m_utilization; }
+};
+
+#endif //JOB_SYSTEM_HPP
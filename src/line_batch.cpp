@@ -0,0 +1,124 @@
+#include "line_batch.hpp"
+
+#include "globals.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+constexpr int line_group_count = line_blend_count * max_line_layers;
+
+static_assert(line_storage_t::chunk_size % line_batch_grain == 0);
+constexpr std::size_t grains_per_storage_chunk = line_storage_t::chunk_size / line_batch_grain;
+
+// The instance arrays are rebuilt completely, so when they have to grow their old contents are dropped instead of
+// copied. The capacity doubles so a growing scene rarely gets here.
+template<typename TValue>
+void resize_instances(std::vector<TValue>& instances, std::size_t count) {
+    if (count > instances.capacity()) {
+        instances.clear();
+        instances.reserve(std::bit_ceil(count));
+    }
+    instances.resize(count);
+}
+
+// Groups are ordered by blend mode first, so the groups of a blend mode are adjacent.
+int line_group(const line& line) {
+    return static_cast<int>(line.blend()) * max_line_layers + std::clamp(line.layer(), 0, max_line_layers - 1);
+}
+
+void line_batch_t::build(const line_scene_t& lines,
+                         GLuint vertex_count,
+                         std::pmr::memory_resource& frame_memory,
+                         job_system_t& jobs) noexcept {
+    TRACE_ZONE("line_batch build");
+    // Counting sort in chunks of lines that are counted and placed in parallel. Within a group the lines of a chunk
+    // come after the lines of the earlier chunks, so the order is the same as sorting them one by one.
+    const auto chunk_count = std::max<std::size_t>(1, lines.chunk_count() * grains_per_storage_chunk);
+    // A chunk is a part of one storage chunk, so its lines are contiguous. The first and last storage chunks of the
+    // lasting and of the fading lines are only partly filled, the chunks past their lines are empty.
+    const auto chunk_lines = [&](std::size_t chunk) -> std::span<const line> {
+        if (lines.empty()) {
+            return {};
+        }
+
+        const auto storage_chunk = lines.chunk(chunk / grains_per_storage_chunk);
+        const auto first = chunk % grains_per_storage_chunk * line_batch_grain;
+        if (first >= storage_chunk.size()) {
+            return {};
+        }
+        return storage_chunk.subspan(first, std::min<std::size_t>(line_batch_grain, storage_chunk.size() - first));
+    };
+
+    // The number of lines of each group in a chunk, and later the index of the next line of the group.
+    std::pmr::vector<std::array<std::uint32_t, line_group_count>> chunk_indices(chunk_count, &frame_memory);
+    std::pmr::vector<double> chunk_lengths(chunk_count, &frame_memory);
+    jobs.parallel_for(0, chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto chunk = begin; chunk < end; chunk++) {
+            for (const auto& line : chunk_lines(chunk)) {
+                chunk_indices[chunk][line_group(line)]++;
+                chunk_lengths[chunk] += line.length();
+            }
+        }
+    });
+
+    auto total_length = 0.0;
+    for (const auto length : chunk_lengths) {
+        total_length += length;
+    }
+    m_average_length = lines.empty() ? 0.0f : static_cast<float>(total_length / static_cast<double>(lines.size()));
+
+    std::array<std::uint32_t, line_group_count> group_sizes;
+    std::array<std::uint32_t, line_group_count> group_offsets;
+    std::uint32_t offset = 0;
+    for (auto group = 0; group < line_group_count; group++) {
+        group_offsets[group] = offset;
+        for (auto& indices : chunk_indices) {
+            const auto size = indices[group];
+            indices[group] = offset;
+            offset += size;
+        }
+        group_sizes[group] = offset - group_offsets[group];
+    }
+
+    resize_instances(m_model_matrixes, lines.size());
+    resize_instances(m_model_colors, lines.size());
+    resize_instances(m_vertex_widths, lines.size());
+    resize_instances(m_lifetimes, lines.size());
+
+    jobs.parallel_for(0, chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto chunk = begin; chunk < end; chunk++) {
+            auto& next_index = chunk_indices[chunk];
+            for (const auto& line : chunk_lines(chunk)) {
+                const auto index = next_index[line_group(line)]++;
+                m_model_matrixes[index] = line.transform_matrix();
+                m_model_colors[index] = line.color();
+                m_vertex_widths[index] = {line.start_width(), line.end_width(),
+                                          std::max(line.start_width(), line.end_width())};
+                m_lifetimes[index] = {line.spawn_time(), line.lifetime()};
+            }
+        }
+    });
+
+    // At most one command per group and one range per blend mode.
+    auto& commands = m_commands.emplace(&frame_memory);
+    auto& pipeline_ranges = m_pipeline_ranges.emplace(&frame_memory);
+    commands.reserve(line_group_count);
+    pipeline_ranges.reserve(line_blend_count);
+    for (auto blend = 0; blend < line_blend_count; blend++) {
+        const auto first_command = commands.size();
+        for (auto layer = 0; layer < max_line_layers; layer++) {
+            const auto group = blend * max_line_layers + layer;
+            if (group_sizes[group] > 0) {
+                commands.push_back({vertex_count, group_sizes[group], 0, group_offsets[group]});
+            }
+        }
+
+        if (commands.size() > first_command) {
+            pipeline_ranges.push_back({static_cast<line_blend_t>(blend), first_command,
+                                       commands.size() - first_command});
+        }
+    }
+}
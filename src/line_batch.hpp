@@ -0,0 +1,65 @@
+#ifndef LINE_BATCH_HPP
+#define LINE_BATCH_HPP
+
+#include <glm/glm.hpp>
+
+#include "wrappers/opengl/attribute_buffer_object.hpp"
+#include "line_scene.hpp"
+#include "primitives.hpp"
+#include "job_system.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Commands in [m_first_command, m_first_command + m_command_count) share a blend mode,
+// so they are submitted with a single multi-draw.
+struct line_pipeline_range_t {
+    line_blend_t m_blend;
+    std::size_t m_first_command;
+    std::size_t m_command_count;
+};
+
+// Packs the lines of every blend mode and layer into one set of instance arrays, grouped so that each
+// group is a contiguous run of instances drawn by one indirect command. The number of draw calls then
+// depends on the number of blend modes in use, not on the number of groups.
+// The instance arrays are kept between frames, so rebuilding does not allocate once they have grown.
+// The commands only live for a frame and are allocated from the frame memory.
+class line_batch_t {
+    std::vector<glm::mat4> m_model_matrixes;
+    std::vector<glm::vec3> m_model_colors;
+    std::vector<glm::vec3> m_vertex_widths;
+    // Spawn time and lifetime, the vertex shader fades the line out from them.
+    std::vector<glm::vec2> m_lifetimes;
+    std::optional<std::pmr::vector<gl::draw_arrays_indirect_command_t>> m_commands;
+    std::optional<std::pmr::vector<line_pipeline_range_t>> m_pipeline_ranges;
+    float m_average_length = 0.0f;
+
+public:
+    // vertex_count is the number of vertices of the instanced quad.
+    // The commands and pipeline ranges are valid until frame_memory is released.
+    void build(const line_scene_t& lines,
+               GLuint vertex_count,
+               std::pmr::memory_resource& frame_memory,
+               job_system_t& jobs) noexcept;
+
+    [[nodiscard]] constexpr const std::vector<glm::mat4>& model_matrixes() const noexcept { return m_model_matrixes; }
+    [[nodiscard]] constexpr const std::vector<glm::vec3>& model_colors() const noexcept { return m_model_colors; }
+    [[nodiscard]] constexpr const std::vector<glm::vec3>& vertex_widths() const noexcept { return m_vertex_widths; }
+    [[nodiscard]] constexpr const std::vector<glm::vec2>& lifetimes() const noexcept { return m_lifetimes; }
+
+    // Of the lines in the batch, in window pixels. 0 when there are none.
+    [[nodiscard]] constexpr float average_length() const noexcept { return m_average_length; }
+
+    [[nodiscard]] std::span<const gl::draw_arrays_indirect_command_t> commands() const noexcept {
+        return m_commands ? std::span(*m_commands) : std::span<const gl::draw_arrays_indirect_command_t>();
+    }
+
+    [[nodiscard]] std::span<const line_pipeline_range_t> pipeline_ranges() const noexcept {
+        return m_pipeline_ranges ? std::span(*m_pipeline_ranges) : std::span<const line_pipeline_range_t>();
+    }
+};
+
+#endif //LINE_BATCH_HPP
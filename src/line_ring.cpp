@@ -0,0 +1,133 @@
+#include "line_ring.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// The records start on their own cache line after the header.
+constexpr std::size_t records_offset = (sizeof(line_ring_header_t) + 63) / 64 * 64;
+
+[[noreturn]] void fail(std::string_view what, std::string_view name) noexcept {
+    std::cerr << what << " " << name << ": " << std::strerror(errno) << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+void* map(int descriptor, std::size_t size, std::string_view name) noexcept {
+    const auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (memory == MAP_FAILED) {
+        close(descriptor);
+        fail("Failed to map shared memory", name);
+    }
+    close(descriptor);
+    return memory;
+}
+}
+
+line_ring_t::line_ring_t(std::string_view name,
+                         line_ring_header_t* header,
+                         std::uint64_t capacity,
+                         std::size_t mapping_size,
+                         bool owner) noexcept
+    : m_name(name),
+      m_header(header),
+      m_records(reinterpret_cast<line_record_t*>(reinterpret_cast<std::byte*>(header) + records_offset)),
+      m_capacity(capacity),
+      m_mapping_size(mapping_size),
+      m_owner(owner) {
+}
+
+line_ring_t::line_ring_t(line_ring_t&& other) noexcept
+    : m_name(std::move(other.m_name)),
+      m_header(other.m_header),
+      m_records(other.m_records),
+      m_capacity(other.m_capacity),
+      m_mapping_size(other.m_mapping_size),
+      m_owner(other.m_owner),
+      m_received(other.m_received),
+      m_sequence_errors(other.m_sequence_errors) {
+    other.m_moved = true;
+}
+
+line_ring_t::~line_ring_t() {
+    if (!m_moved) {
+        std::cerr << "Deleted line ring" << std::endl;
+        munmap(m_header, m_mapping_size);
+        if (m_owner) {
+            shm_unlink(m_name.c_str());
+        }
+    }
+}
+
+bool line_ring_t::try_push(line_record_t record) noexcept {
+    const auto write_index = m_header->m_write_index.load(std::memory_order_relaxed);
+    if (write_index - m_header->m_read_index.load(std::memory_order_acquire) >= m_capacity) {
+        m_header->m_overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    record.m_sequence = write_index;
+    m_records[write_index % m_capacity] = record;
+    m_header->m_write_index.store(write_index + 1, std::memory_order_release);
+    return true;
+}
+
+line_ring_t line_ring_t::create(std::string_view name, std::size_t capacity) noexcept {
+    const std::string shm_name(name);
+    // Producers of an earlier ring keep the old memory, new ones only find this one.
+    shm_unlink(shm_name.c_str());
+    const auto descriptor = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor == -1) {
+        fail("Failed to create shared memory", name);
+    }
+
+    const auto size = records_offset + capacity * sizeof(line_record_t);
+    if (ftruncate(descriptor, static_cast<off_t>(size)) == -1) {
+        close(descriptor);
+        fail("Failed to size shared memory", name);
+    }
+
+    const auto header = new(map(descriptor, size, name)) line_ring_header_t{
+        line_ring_header_t::magic, line_ring_header_t::version, capacity, 0, 0, 0};
+
+    return {name, header, capacity, size, true};
+}
+
+line_ring_t line_ring_t::open(std::string_view name) noexcept {
+    const std::string shm_name(name);
+    const auto descriptor = shm_open(shm_name.c_str(), O_RDWR, 0);
+    if (descriptor == -1) {
+        fail("Failed to open shared memory", name);
+    }
+
+    struct stat status{};
+    if (fstat(descriptor, &status) == -1) {
+        close(descriptor);
+        fail("Failed to read the size of shared memory", name);
+    }
+
+    const auto size = static_cast<std::size_t>(status.st_size);
+    if (size < records_offset) {
+        std::cerr << "Shared memory " << name << " is not a line ring" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    const auto header = static_cast<line_ring_header_t*>(map(descriptor, size, name));
+    const auto capacity = header->m_capacity;
+    if (header->m_magic != line_ring_header_t::magic || header->m_version != line_ring_header_t::version ||
+        capacity == 0 || capacity > (size - records_offset) / sizeof(line_record_t)) {
+        std::cerr << "Shared memory " << name << " is not a version " << line_ring_header_t::version
+                  << " line ring" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    return {name, header, capacity, size, false};
+}
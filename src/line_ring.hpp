@@ -0,0 +1,125 @@
+#ifndef LINE_RING_HPP
+#define LINE_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// A line as written by an external producer. The layout is shared between processes, so it is fixed.
+struct line_record_t {
+    // Index of the record in the stream, the consumer uses it to notice lost or torn records.
+    std::uint64_t m_sequence;
+    float m_start_position[2];
+    float m_end_position[2];
+    float m_color[3];
+    float m_start_width;
+    float m_end_width;
+    // line_blend_t
+    std::uint32_t m_blend;
+    std::int32_t m_layer;
+    std::uint32_t m_padding;
+};
+
+static_assert(std::is_trivially_copyable_v<line_record_t>);
+static_assert(sizeof(line_record_t) == 56);
+
+// Start of the shared memory, followed by the records.
+struct line_ring_header_t {
+    static constexpr std::uint32_t magic = 0x4C52'4646; // "FFRL"
+    static constexpr std::uint32_t version = 1;
+
+    std::uint32_t m_magic;
+    std::uint32_t m_version;
+    std::uint64_t m_capacity;
+
+    // Written by the producer.
+    alignas(64) std::atomic<std::uint64_t> m_write_index;
+    // Records the producer dropped because the ring was full.
+    std::atomic<std::uint64_t> m_overruns;
+
+    // Written by the consumer.
+    alignas(64) std::atomic<std::uint64_t> m_read_index;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The indexes are shared between processes");
+
+// Single producer, single consumer ring of line records in POSIX shared memory.
+// The renderer creates the ring and reads the records in place, another process opens it by name and writes.
+class [[nodiscard]] line_ring_t {
+    std::string m_name;
+    line_ring_header_t* m_header;
+    line_record_t* m_records;
+    // Copied out of the header when the ring is mapped. The header is writable by the other process, a capacity read
+    // from it later could index past the mapping.
+    std::uint64_t m_capacity;
+    std::size_t m_mapping_size;
+    bool m_owner;
+    bool m_moved = false;
+
+    // Consumer side statistics.
+    std::uint64_t m_received = 0;
+    std::uint64_t m_sequence_errors = 0;
+
+    [[nodiscard]] line_ring_t(std::string_view name,
+                              line_ring_header_t* header,
+                              std::uint64_t capacity,
+                              std::size_t mapping_size,
+                              bool owner) noexcept;
+
+public:
+    line_ring_t() = delete;
+
+    line_ring_t(const line_ring_t&) = delete;
+
+    [[nodiscard]] line_ring_t(line_ring_t&& other) noexcept;
+
+    ~line_ring_t();
+
+    // Producer: appends a record and stamps its sequence number. Returns false and counts an overrun when full.
+    bool try_push(line_record_t record) noexcept;
+
+    // Consumer: calls function(const line_record_t&) on at most max_records records, straight in the shared memory,
+    // and then releases them to the producer. Returns the number of records consumed.
+    template<typename TFunction>
+    std::size_t drain(std::size_t max_records, TFunction&& function) noexcept {
+        const auto read_index = m_header->m_read_index.load(std::memory_order_relaxed);
+        const auto write_index = m_header->m_write_index.load(std::memory_order_acquire);
+        const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(write_index - read_index, max_records));
+
+        for (std::size_t i = 0; i < count; i++) {
+            const auto& record = m_records[(read_index + i) % m_capacity];
+            if (record.m_sequence != read_index + i) {
+                m_sequence_errors++;
+                continue;
+            }
+            function(record);
+        }
+
+        m_header->m_read_index.store(read_index + count, std::memory_order_release);
+        m_received += count;
+        return count;
+    }
+
+    [[nodiscard]] std::uint64_t received() const noexcept { return m_received; }
+    [[nodiscard]] std::uint64_t sequence_errors() const noexcept { return m_sequence_errors; }
+
+    [[nodiscard]] std::uint64_t overruns() const noexcept {
+        return m_header->m_overruns.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+
+    // Creates a new shared memory object for the ring. An existing one of the same name, stale or of another renderer,
+    // is unlinked first and keeps its memory for whoever has it open. The name is removed again when the ring is
+    // destroyed. Exits with a message on failure.
+    static line_ring_t create(std::string_view name, std::size_t capacity) noexcept;
+
+    // Opens a ring created by another process. Exits with a message on failure.
+    static line_ring_t open(std::string_view name) noexcept;
+};
+
+#endif //LINE_RING_HPP
@@ -0,0 +1,33 @@
+#include "line_scene.hpp"
+
+std::size_t line_scene_t::retire(float time) noexcept {
+    // The vertex shader fades the lines out, they are only erased once they are gone. A fading line that lives
+    // longer than the ones added after it still holds them back, but no longer than the longest lifetime.
+    std::size_t expired = 0;
+    while (expired < m_fading.size() && m_fading[expired].expired(time)) {
+        expired++;
+    }
+    m_fading.erase_front(expired);
+
+    if (expired > 0) {
+        m_fading_bounds.reset();
+        for (const auto& value : m_fading) {
+            include_fading(value);
+        }
+    }
+    return expired;
+}
+
+void line_scene_t::include_fading(const line& value) noexcept {
+    // The line is a rectangle, its first column spans the width and its second the length, both around the center.
+    const auto& transform = value.transform_matrix();
+    const auto center = glm::vec2(transform[3]);
+    const auto extent = (glm::abs(glm::vec2(transform[0])) + glm::abs(glm::vec2(transform[1]))) * 0.5f;
+
+    if (!m_fading_bounds) {
+        m_fading_bounds = world_bounds_t{center - extent, center + extent};
+        return;
+    }
+    m_fading_bounds->m_min = glm::min(m_fading_bounds->m_min, center - extent);
+    m_fading_bounds->m_max = glm::max(m_fading_bounds->m_max, center + extent);
+}
@@ -0,0 +1,69 @@
+#ifndef LINE_SCENE_HPP
+#define LINE_SCENE_HPP
+
+#include <glm/glm.hpp>
+
+#include "primitives.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+
+// A rectangle of the world, with the minimum and maximum corner.
+struct world_bounds_t {
+    glm::vec2 m_min;
+    glm::vec2 m_max;
+};
+
+// The lines of a scene. Lines that never fade are kept apart from the ones that do, so a line that stays cannot hold
+// back the retirement of the faded lines added after it. The fading lines are retired in the order they were added.
+class line_scene_t {
+    line_storage_t m_lasting;
+    line_storage_t m_fading;
+    // Around every fading line, widths included. Grows as they are added and is recomputed when some are retired.
+    std::optional<world_bounds_t> m_fading_bounds;
+
+    void include_fading(const line& value) noexcept;
+
+public:
+    line_scene_t() = default;
+
+    // A scene of lines that are already stored, e.g. generated ones. They must not fade.
+    explicit line_scene_t(line_storage_t lasting) noexcept : m_lasting(std::move(lasting)) {
+    }
+
+    // Stores the line with the others of its kind. Returns the stored line.
+    const line& add(const line& value) {
+        if (value.lifetime() <= 0.0f) {
+            return m_lasting.emplace_back(value);
+        }
+        include_fading(value);
+        return m_fading.emplace_back(value);
+    }
+
+    template<typename... TArguments>
+    const line& emplace(TArguments&&... arguments) {
+        return add(line(std::forward<TArguments>(arguments)...));
+    }
+
+    // Erases the fading lines that have faded out completely at the given simulation time. Returns how many.
+    std::size_t retire(float time) noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_lasting.size() + m_fading.size(); }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] std::size_t fading_count() const noexcept { return m_fading.size(); }
+
+    // Where the fading lines are, none if there are none. They change every frame until they are retired.
+    [[nodiscard]] const std::optional<world_bounds_t>& fading_bounds() const noexcept { return m_fading_bounds; }
+
+    // The chunks of the lasting lines followed by the chunks of the fading ones, see chunked_vector_t::chunk().
+    [[nodiscard]] std::size_t chunk_count() const noexcept { return m_lasting.chunk_count() + m_fading.chunk_count(); }
+
+    [[nodiscard]] std::span<const line> chunk(std::size_t chunk) const noexcept {
+        const auto lasting_chunks = m_lasting.chunk_count();
+        return chunk < lasting_chunks ? m_lasting.chunk(chunk) : m_fading.chunk(chunk - lasting_chunks);
+    }
+};
+
+#endif //LINE_SCENE_HPP
@@ -15,21 +15,57 @@
 #include "wrappers/opengl.hpp"
 #include "wrappers/opengl/attribute_buffer_object.hpp"
 #include "wrappers/opengl/frame_buffer_object.hpp"
+#include "wrappers/opengl/frame_fence_ring.hpp"
+#include "wrappers/opengl/primitive_query.hpp"
+#include "wrappers/opengl/timer_query.hpp"
+#include "wrappers/opengl/uniform_buffer_object.hpp"
 
 #include "primitives.hpp"
+#include "line_batch.hpp"
+#include "line_scene.hpp"
+#include "stroke.hpp"
+#include "simulation.hpp"
+#include "frame_governor.hpp"
+#include "frame_statistics.hpp"
+#include "input_latency.hpp"
+#include "frame_capture.hpp"
+#include "frame_arena.hpp"
+#include "frame_constants.hpp"
+#include "damage_tracker.hpp"
+#include "camera.hpp"
+#include "tile_cache.hpp"
+#include "job_system.hpp"
+#include "trace.hpp"
+#ifdef LINE_RING_SUPPORTED
+#include "line_ring.hpp"
+#endif
+#ifdef VIDEO_WALL_SUPPORTED
+#include "video_wall.hpp"
+#endif
+#include "options.hpp"
+#include "benchmark.hpp"
+#include "scene_generator.hpp"
+#include "allocation_counter.hpp"
 #include "globals.hpp"
 
 #include "resources.hpp"
+#include "shader_bindings.hpp"
 
 #include <cstdlib>
+#include <cstdint>
+#include <cmath>
 #include <array>
 #include <iostream>
 #include <string>
 #include <string_view>
 #include <format>
+#include <memory_resource>
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <limits>
+#include <optional>
+#include <span>
 
 using namespace std::string_view_literals;
 
@@ -42,6 +78,14 @@ constexpr std::array<glm::vec2, 4> vertex_uvs = {glm::vec2{0.0f, 0.0f}, {1.0f, 0
 
 constexpr std::array<GLuint, 4> vertex_indices = {0, 1, 2, 3};
 
+// A line through the middle of the quad above, along its length.
+constexpr std::array<glm::vec2, 2> density_vertex_positions = {glm::vec2{0.0f, -0.5f}, {0.0f, 0.5f}};
+
+constexpr std::array<glm::vec2, 4> fullscreen_vertex_positions = {glm::vec2{-1.0f, -1.0f},
+                                                                  {1.0f, -1.0f},
+                                                                  {1.0f, 1.0f},
+                                                                  {-1.0f, 1.0f}};
+
 struct star_shader_stuff_t {
     gl::program_t program;
     gl::vertex_shader_t vertex_shader;
@@ -49,16 +93,24 @@ struct star_shader_stuff_t {
     gl::vertex_array_object_t vertex_array_object;
     gl::vertex_buffer_object_t vertex_buffer_object;
     gl::index_buffer_object_t index_buffer_object;
-    gl::uniform_location_t projection_uniform;
-    gl::uniform_location_t background_color_uniform;
-    gl::uniform_location_t star_density_uniform;
+};
+
+// Culls the instances of the line batch against the view and compacts the visible ones, which are drawn instead.
+// Runs on the GPU and feeds the draw commands directly, the number of visible lines is only read back through a query.
+struct line_cull_stuff_t {
+    gl::program_t program;
+    gl::compute_shader_t compute_shader;
+    gl::model_matrix_buffer_object_t model_matrix_buffer_object;
+    gl::model_color_buffer_object_t model_color_buffer_object;
+    gl::vertex_width_buffer_object_t vertex_width_buffer_object;
+    gl::line_lifetime_buffer_object_t lifetime_buffer_object;
+    gl::primitive_counter_t primitive_counter;
 };
 
 struct line_shader_stuff_t {
     gl::program_t program;
     gl::vertex_shader_t vertex_shader;
     gl::fragment_shader_t fragment_shader;
-    gl::uniform_location_t projection_uniform;
     gl::vertex_array_object_t vertex_array_object;
     gl::vertex_buffer_object_t vertex_buffer_object;
     gl::index_buffer_object_t index_buffer_object;
@@ -66,7 +118,37 @@ struct line_shader_stuff_t {
     gl::model_matrix_buffer_object_t model_matrix_buffer_object;
     gl::model_color_buffer_object_t model_color_buffer_object;
     gl::vertex_width_buffer_object_t vertex_width_buffer_object;
-    gl::frame_buffer_object_t frame_buffer_object;
+    gl::line_lifetime_buffer_object_t lifetime_buffer_object;
+    gl::indirect_buffer_object_t indirect_buffer_object;
+    gl::render_target_handle_t frame_buffer_target;
+    // Only where compute shaders are supported.
+    std::optional<line_cull_stuff_t> cull_stuff;
+};
+
+// Splats the lines as one pixel wide lines into a floating point frame buffer, where they add up to a density per
+// pixel. For scenes with so many lines that drawing every one of them is bound by fill rate and saturates into noise.
+struct density_shader_stuff_t {
+    gl::program_t program;
+    gl::vertex_shader_t vertex_shader;
+    gl::fragment_shader_t fragment_shader;
+    gl::vertex_array_object_t vertex_array_object;
+    gl::vertex_buffer_object_t vertex_buffer_object;
+    gl::model_matrix_buffer_object_t model_matrix_buffer_object;
+    gl::model_color_buffer_object_t model_color_buffer_object;
+    gl::line_lifetime_buffer_object_t lifetime_buffer_object;
+    gl::render_target_handle_t frame_buffer_target;
+};
+
+// Shows the lines from tiles baked into an atlas, see tile_cache_t. Panning and zooming only moves the tiles around.
+struct tile_shader_stuff_t {
+    gl::program_t program;
+    gl::vertex_shader_t vertex_shader;
+    gl::fragment_shader_t fragment_shader;
+    gl::vertex_array_object_t vertex_array_object;
+    gl::vertex_buffer_object_t vertex_buffer_object;
+    gl::tile_rect_buffer_object_t tile_rect_buffer_object;
+    gl::tile_rect_buffer_object_t atlas_rect_buffer_object;
+    gl::render_target_handle_t atlas_target;
 };
 
 struct combiner_shader_stuff_t {
@@ -77,16 +159,68 @@ struct combiner_shader_stuff_t {
     gl::vertex_buffer_object_t vertex_buffer_object;
     gl::index_buffer_object_t index_buffer_object;
     gl::texture_coordinate_buffer_object_t texture_coordinate_buffer_object;
-    gl::uniform_location_t projection_uniform;
-    gl::uniform_location_t lines_frame_buffer_uniform;
+    gl::typed_uniform_location_t<glm::vec2> lines_uv_scale_uniform;
+    gl::typed_uniform_location_t<glm::vec2> bloom_uv_scale_uniform;
+    gl::typed_uniform_location_t<glm::vec2> density_uv_scale_uniform;
+};
+
+// A full screen quad through a fragment shader that reads one frame buffer.
+struct fullscreen_pass_stuff_t {
+    gl::program_t program;
+    gl::vertex_shader_t vertex_shader;
+    gl::fragment_shader_t fragment_shader;
+    gl::vertex_array_object_t vertex_array_object;
+    gl::vertex_buffer_object_t vertex_buffer_object;
+    gl::index_buffer_object_t index_buffer_object;
+    gl::texture_coordinate_buffer_object_t texture_coordinate_buffer_object;
+    gl::typed_uniform_location_t<glm::vec2> texel_size_uniform;
+    gl::typed_uniform_location_t<glm::vec2> source_uv_scale_uniform;
+};
+
+// Smooths the edges of the lines after they are drawn, when they are neither multisampled nor anti-aliased by their
+// fragment shader.
+struct post_antialiasing_stuff_t {
+    fullscreen_pass_stuff_t pass;
+    gl::render_target_handle_t frame_buffer_target;
+};
+
+struct bloom_shader_stuff_t {
+    fullscreen_pass_stuff_t downsample_pass;
+    fullscreen_pass_stuff_t upsample_pass;
+    // Level i is 1 / 2^(i + 1) of the lines frame buffer size.
+    std::array<gl::render_target_handle_t, max_bloom_levels> mip_chain;
 };
 
 struct shader_stuff_t {
     star_shader_stuff_t star_shader_stuff;
     line_shader_stuff_t line_shader_stuff;
+    density_shader_stuff_t density_shader_stuff;
+    tile_shader_stuff_t tile_shader_stuff;
+    post_antialiasing_stuff_t post_antialiasing_stuff;
+    bloom_shader_stuff_t bloom_shader_stuff;
     combiner_shader_stuff_t combiner_shader_stuff;
+    gl::uniform_buffer_object_t<frame_constants_t> frame_constants;
+};
+
+// When the lines are aggregated into densities instead of drawn one by one.
+enum class line_aggregation_t {
+    automatic,
+    never,
+    always,
+};
+
+// How the edges of the lines are smoothed.
+enum class line_antialiasing_t {
+    // The lines frame buffer is multisampled and resolved with a blit.
+    multisample,
+    // The fragment shader fades the edges out over a pixel.
+    analytic,
+    // A full screen pass blurs along the edges it finds in the drawn lines.
+    post_process,
 };
 
+constexpr int line_antialiasing_count = 3;
+
 struct window_state_t {
     // Stars
     glm::vec3 m_stars_background_color = glm::vec3(0.0f);
@@ -96,23 +230,379 @@ struct window_state_t {
     glm::vec3 m_line_color = glm::vec3(1.0f);
     float m_start_width = 50.0f;
     float m_end_width = 20.0f;
-
+    line_blend_t m_line_blend = line_blend_t::max;
+    int m_line_layer = 0;
+    // Seconds until a new line has faded out, 0 keeps it forever.
+    float m_line_lifetime = 0.0f;
+    line_antialiasing_t m_line_antialiasing = line_antialiasing_t::multisample;
+    // Draw strokes by holding the button instead of clicking both ends of a line.
+    bool m_freehand = false;
+    float m_stroke_tolerance = 1.0f;
+
+    // Density
+    line_aggregation_t m_line_aggregation = line_aggregation_t::automatic;
+    // Automatically from this many lines on, or when the lines are shorter than this on average.
+    int m_aggregation_line_count = 4'000'000;
+    float m_aggregation_average_length = 2.0f;
+    // How fast the brightness rises with the number of lines through a pixel.
+    float m_density_exposure = 0.1f;
+
+    // Canvas
+    // Draw the lines from baked tiles, for canvases much larger than the window.
+    bool m_tiled_canvas = false;
+    // Tiles baked per frame at most, the others show a coarser level meanwhile.
+    int m_tile_bake_budget = 8;
+
+    // Bloom
+    bool m_bloom_enabled = true;
+    int m_bloom_levels = 5;
+    float m_bloom_intensity = 1.0f;
 
     // Misc.
     bool m_show_fps = true;
+    // Only redraw the parts of the window that changed.
+    bool m_partial_redraw = true;
+    // Cull the lines on the GPU when it can.
+    bool m_gpu_culling = true;
+
+    // Latency
+    // Wait for the GPU before reading the events, so the driver does not queue more than this many frames.
+    bool m_low_latency = false;
+    int m_max_frames_in_flight = 1;
+};
+
+// Everything that changes pixels that have already been drawn. When any of it changes, the whole frame is redrawn.
+struct redraw_key_t {
+    glm::ivec2 m_window_size;
+    glm::ivec2 m_render_target_size;
+    quality_settings_t m_quality_settings;
+    glm::vec3 m_stars_background_color;
+    float m_stars_density;
+    bool m_bloom_enabled;
+    int m_bloom_levels;
+    float m_bloom_intensity;
+    bool m_partial_redraw;
+    bool m_gpu_culling;
+    bool m_aggregate_lines;
+    float m_density_exposure;
+    camera_t m_camera;
+    bool m_tiled_canvas;
+    line_antialiasing_t m_line_antialiasing;
+
+    bool operator==(const redraw_key_t&) const = default;
+};
+
+struct redraw_statistics_t {
+    int m_buffer_age = 0;
+    float m_coverage = 1.0f;
+};
+
+// What the leader of a video wall hands the other windows every frame, along with the lines it added.
+struct video_wall_state_t {
+    simulation_state_t m_simulation_state;
+    camera_t m_camera;
+    window_state_t m_window_state;
+    quality_settings_t m_quality_settings;
+};
+
+// GPU milliseconds of drawing the lines, including the resolve or the post pass, last measured with each
+// anti-aliasing mode.
+struct antialiasing_statistics_t {
+    std::array<float, line_antialiasing_count> m_lines_gpu_time{};
+};
+
+// Lines that survived the GPU culling a few frames ago, out of all lines.
+struct culling_statistics_t {
+    std::uint64_t m_visible_lines = 0;
+    std::size_t m_total_lines = 0;
 };
 
-shader_stuff_t init_gl(const glm::ivec2& window_size);
+shader_stuff_t init_gl(gl::render_target_pool_t& render_target_pool, const glm::ivec2& window_size);
 
-void render(const shader_stuff_t& stuff,
+void render(shader_stuff_t& stuff,
+            gl::render_target_pool_t& render_target_pool,
             const glm::mat4& projection_matrix,
+            const camera_t& camera,
+            const glm::vec2& canvas_offset,
             const window_state_t& window_state,
-            const std::vector<line>& lines,
-            const glm::ivec2& window_size);
+            const quality_settings_t& quality_settings,
+            const line_scene_t& lines,
+            line_batch_t& line_batch,
+            bool aggregate_lines,
+            tile_cache_t* tile_cache,
+            gl::gpu_timer_t* lines_timer,
+            std::pmr::memory_resource& frame_memory,
+            job_system_t& jobs,
+            const damage_t& lines_damage,
+            const damage_t& back_buffer_damage,
+            const glm::ivec2& window_size,
+            const glm::ivec2& render_target_size,
+            float time,
+            std::uint32_t frame_index);
+
+// Whether the lines are aggregated into densities this frame.
+bool should_aggregate_lines(const window_state_t& window_state,
+                            const camera_t& camera,
+                            std::size_t line_count,
+                            const line_batch_t& line_batch);
+
+int run_benchmark(const options_t& options,
+                  const sdl::window_t& window,
+                  shader_stuff_t& stuff,
+                  gl::render_target_pool_t& render_target_pool,
+                  gl::gpu_timer_t& gpu_timer,
+                  frame_statistics_t& frame_statistics,
+                  job_system_t& jobs,
+                  const glm::mat4& projection_matrix,
+                  const glm::ivec2& window_size);
 
 void GLAPIENTRY debug_message_callback(GLenum, GLenum, GLuint, GLenum, GLsizei, const GLchar*, const void*);
 
-void render_debug_menu(window_state_t& window_state, bool render_imgui) {
+// Lines received from external producers through the shared memory ring.
+struct ingest_statistics_t {
+    bool m_enabled = false;
+    float m_lines_per_second = 0.0f;
+    std::uint64_t m_received = 0;
+    std::uint64_t m_overruns = 0;
+    std::uint64_t m_sequence_errors = 0;
+};
+
+// Memory used by the frame loop. Frames without events are expected to allocate nothing from the heap.
+struct frame_memory_t {
+    frame_arena_t m_arena{frame_arena_size};
+    // The arena is reset before the debug menu is built, so the menu shows what the previous frame used.
+    std::size_t m_last_frame_arena_used = 0;
+    std::uint64_t m_last_frame_allocations = 0;
+    std::uint64_t m_allocating_idle_frames = 0;
+};
+
+void render_performance_tab(frame_governor_t& governor,
+                            const gl::render_target_pool_t& render_target_pool,
+                            const frame_memory_t& frame_memory,
+                            const job_system_t& jobs,
+                            const redraw_statistics_t& redraw_statistics,
+                            const culling_statistics_t& culling_statistics,
+                            window_state_t& window_state) {
+    TRACE_ZONE("render_performance_tab");
+    ImGui::Text("CPU: %.2f ms", governor.cpu_time());
+    ImGui::Text("GPU: %.2f ms", governor.gpu_time());
+    ImGui::Text("Render target allocations: %zu (%.1f MiB)", render_target_pool.allocation_count(),
+                static_cast<double>(render_target_pool.allocated_bytes()) / (1024.0 * 1024.0));
+    ImGui::Text("Frame arena: %zu / %zu KiB last frame (peak %zu KiB, %llu overflows)",
+                frame_memory.m_last_frame_arena_used / 1024,
+                frame_memory.m_arena.capacity() / 1024, frame_memory.m_arena.high_water_mark() / 1024,
+                static_cast<unsigned long long>(frame_memory.m_arena.overflows()));
+    ImGui::Text("Heap allocations last frame: %llu, idle frames that allocated: %llu",
+                static_cast<unsigned long long>(frame_memory.m_last_frame_allocations),
+                static_cast<unsigned long long>(frame_memory.m_allocating_idle_frames));
+
+    ImGui::Checkbox("Partial Redraw", &window_state.m_partial_redraw);
+    ImGui::Text("Redrawn: %.0f%% (buffer age %d, swap with damage %s)", redraw_statistics.m_coverage * 100.0f,
+                redraw_statistics.m_buffer_age, sdl::gl_supports_swap_with_damage() ? "yes" : "no");
+
+    if (gl::supports_compute_shaders()) {
+        ImGui::Checkbox("GPU Culling", &window_state.m_gpu_culling);
+        if (window_state.m_gpu_culling) {
+            ImGui::Text("Visible lines: %llu / %zu", static_cast<unsigned long long>(culling_statistics.m_visible_lines),
+                        culling_statistics.m_total_lines);
+        }
+    } else {
+        ImGui::Text("GPU Culling: needs OpenGL 4.3");
+    }
+
+    const auto utilization = jobs.utilization();
+    for (std::size_t i = 0; i < utilization.size(); i++) {
+        std::array<char, 32> label{};
+        std::format_to_n(label.data(), label.size() - 1, "Worker {}: {:.0f}%", i, utilization[i] * 100.0f);
+        ImGui::ProgressBar(utilization[i], ImVec2(-1.0f, 0.0f), label.data());
+    }
+    ImGui::Separator();
+
+    ImGui::Checkbox("Governor", &governor.m_enabled);
+    ImGui::DragFloat("Target Frame Time", &governor.m_target_frame_time, 0.1f, 1.0f, 100.0f, "%.1f ms",
+                     ImGuiSliderFlags_AlwaysClamp);
+    ImGui::Separator();
+
+    // Locked knobs are left alone by the governor and can be set by hand.
+    auto& settings = governor.settings();
+
+    ImGui::Checkbox("##lock_render_scale", &governor.m_lock_render_scale);
+    ImGui::SameLine();
+    if (governor.m_lock_render_scale) {
+        ImGui::SliderFloat("Render Scale", &settings.m_render_scale, 0.25f, 1.0f, "%.2f",
+                           ImGuiSliderFlags_AlwaysClamp);
+    } else {
+        ImGui::Text("Render Scale: %.2f", settings.m_render_scale);
+    }
+
+    ImGui::Checkbox("##lock_star_density", &governor.m_lock_star_density);
+    ImGui::SameLine();
+    if (governor.m_lock_star_density) {
+        ImGui::SliderFloat("Star Density Scale", &settings.m_star_density_scale, 0.0f, 1.0f, "%.2f",
+                           ImGuiSliderFlags_AlwaysClamp);
+    } else {
+        ImGui::Text("Star Density Scale: %.2f", settings.m_star_density_scale);
+    }
+
+    ImGui::Checkbox("##lock_msaa_samples", &governor.m_lock_msaa_samples);
+    ImGui::SameLine();
+    if (governor.m_lock_msaa_samples) {
+        ImGui::SliderInt("MSAA Samples", &settings.m_msaa_samples, 1, governor.max_msaa_samples(), "%d",
+                         ImGuiSliderFlags_AlwaysClamp);
+    } else {
+        ImGui::Text("MSAA Samples: %d", settings.m_msaa_samples);
+    }
+}
+
+void render_canvas_tab(camera_t& camera, const tile_cache_t& tile_cache, window_state_t& window_state) {
+    TRACE_ZONE("render_canvas_tab");
+    ImGui::Text("Zoom: %.3fx (tile level %d), position: %.0f, %.0f", camera.zoom(), tile_level(camera.zoom()),
+                camera.position().x, camera.position().y);
+    ImGui::TextUnformatted("Right drag to pan, scroll to zoom");
+    if (ImGui::Button("Reset View")) {
+        camera = {};
+    }
+    ImGui::Separator();
+
+    ImGui::Checkbox("Tiled Canvas", &window_state.m_tiled_canvas);
+    ImGui::SliderInt("Tiles Baked per Frame", &window_state.m_tile_bake_budget, 1, 64, "%d",
+                     ImGuiSliderFlags_AlwaysClamp);
+    if (window_state.m_tiled_canvas) {
+        ImGui::TextUnformatted("Tiles are anti-aliased analytically, whatever the Lines setting");
+        ImGui::Text("Cache hit rate: %.0f%%%s", tile_cache.hit_rate() * 100.0f,
+                    tile_cache.complete() ? "" : " (baking)");
+        ImGui::Text("Atlas occupancy: %.0f%% of %zu tiles", tile_cache.occupancy() * 100.0f, tile_cache.slot_count());
+    }
+}
+
+void render_antialiasing_tab(window_state_t& window_state,
+                             const quality_settings_t& quality_settings,
+                             const antialiasing_statistics_t& antialiasing_statistics) {
+    TRACE_ZONE("render_antialiasing_tab");
+    constexpr const char* antialiasing_names[] = {"Multisample", "Analytic", "Post Process"};
+    auto antialiasing = static_cast<int>(window_state.m_line_antialiasing);
+    if (ImGui::Combo("Lines", &antialiasing, antialiasing_names, line_antialiasing_count)) {
+        window_state.m_line_antialiasing = static_cast<line_antialiasing_t>(antialiasing);
+    }
+    if (window_state.m_line_antialiasing == line_antialiasing_t::multisample) {
+        ImGui::Text("Samples: %d, see Performance", quality_settings.m_msaa_samples);
+    }
+
+    // Switch between the modes to compare them on the same scene.
+    ImGui::Separator();
+    ImGui::Text("Lines GPU time:");
+    for (auto i = 0; i < line_antialiasing_count; i++) {
+        if (antialiasing_statistics.m_lines_gpu_time[i] > 0.0f) {
+            ImGui::Text("%s: %.3f ms", antialiasing_names[i], antialiasing_statistics.m_lines_gpu_time[i]);
+        } else {
+            ImGui::Text("%s: not measured", antialiasing_names[i]);
+        }
+    }
+}
+
+void render_percentiles_row(const char* name, const percentiles_t& percentiles) {
+    TRACE_ZONE("render_percentiles_row");
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(name);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f", percentiles.m_p50);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f", percentiles.m_p95);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f", percentiles.m_p99);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.2f", percentiles.m_max);
+}
+
+void render_statistics_tab(const frame_statistics_t& frame_statistics, const options_t& options) {
+    TRACE_ZONE("render_statistics_tab");
+    const auto& summary = frame_statistics.summary();
+
+    ImGui::Text("Last %zu frames (ms)", frame_statistics.size());
+    if (ImGui::BeginTable("percentiles", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+        render_percentiles_row("Frame", summary.m_frame_time);
+        render_percentiles_row("CPU", summary.m_cpu_time);
+        render_percentiles_row("GPU", summary.m_gpu_time);
+        ImGui::EndTable();
+    }
+
+    const auto& histogram = frame_statistics.histogram();
+    ImGui::PlotHistogram("##frame_time_histogram", histogram.data(), static_cast<int>(histogram.size()), 0,
+                         "Frame time 0-50 ms", 0.0f, 3.4e38f, ImVec2(0.0f, 80.0f));
+
+    ImGui::Text("Swap interval misses: %llu", static_cast<unsigned long long>(frame_statistics.swap_interval_misses()));
+    ImGui::Text("Hitches (> 2x median): %llu", static_cast<unsigned long long>(frame_statistics.hitches()));
+
+    // Each format gets its own file, named after the --frame-stats path if there is one.
+    const auto export_path = [&](std::string_view extension) {
+        return replace_extension(options.m_frame_statistics_path.value_or("frame_statistics"), extension);
+    };
+    if (ImGui::Button("Export CSV")) {
+        frame_statistics.export_csv(export_path(".csv"));
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export JSON")) {
+        frame_statistics.export_json(export_path(".json"));
+    }
+}
+
+void render_latency_tab(window_state_t& window_state, const input_latency_t& input_latency, float fence_wait_time) {
+    TRACE_ZONE("render_latency_tab");
+    ImGui::Checkbox("Low Latency", &window_state.m_low_latency);
+    ImGui::SliderInt("Frames in Flight", &window_state.m_max_frames_in_flight, 1, max_low_latency_frames_in_flight,
+                     "%d", ImGuiSliderFlags_AlwaysClamp);
+    if (window_state.m_low_latency) {
+        ImGui::Text("Fence wait: %.2f ms", fence_wait_time);
+    }
+    ImGui::Separator();
+
+    // Without the low latency mode the fences are only checked once a frame, which adds up to a frame.
+    ImGui::Text("Input to swap completion, last %zu events (ms)", input_latency.size());
+    if (ImGui::BeginTable("latency_percentiles", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+        render_percentiles_row("Input", input_latency.summary());
+        ImGui::EndTable();
+    }
+
+    const auto& histogram = input_latency.histogram();
+    ImGui::PlotHistogram("##latency_histogram", histogram.data(), static_cast<int>(histogram.size()), 0,
+                         "Latency 0-100 ms", 0.0f, 3.4e38f, ImVec2(0.0f, 80.0f));
+    ImGui::Text("Events measured: %llu, frames lost: %llu",
+                static_cast<unsigned long long>(input_latency.total_events()),
+                static_cast<unsigned long long>(input_latency.lost_frames()));
+}
+
+void render_debug_menu(window_state_t& window_state,
+                       frame_governor_t& governor,
+                       const gl::render_target_pool_t& render_target_pool,
+                       const frame_statistics_t& frame_statistics,
+                       const options_t& options,
+                       const simulation_state_t& simulation_state,
+                       const stroke_simplifier_t& stroke,
+                       const frame_memory_t& frame_memory,
+                       const job_system_t& jobs,
+                       const ingest_statistics_t& ingest_statistics,
+                       const redraw_statistics_t& redraw_statistics,
+                       const culling_statistics_t& culling_statistics,
+                       const antialiasing_statistics_t& antialiasing_statistics,
+                       const input_latency_t& input_latency,
+                       float fence_wait_time,
+                       camera_t& camera,
+                       const tile_cache_t& tile_cache,
+                       bool render_imgui) {
+    TRACE_ZONE("render_debug_menu");
     constexpr const char* tab_id = "tab_id";
 
     if (render_imgui) {
@@ -127,10 +617,81 @@ void render_debug_menu(window_state_t& window_state, bool render_imgui) {
                 ImGui::ColorPicker3("Color", glm::value_ptr(window_state.m_line_color));
                 ImGui::DragFloat("Start Width", &window_state.m_start_width, 1.0f, 1.0f, 50.0f);
                 ImGui::DragFloat("End Width", &window_state.m_end_width, 1.0f, 1.0f, 50.0f);
+                constexpr const char* blend_names[] = {"Max", "Additive"};
+                auto blend = static_cast<int>(window_state.m_line_blend);
+                if (ImGui::Combo("Blend", &blend, blend_names, line_blend_count)) {
+                    window_state.m_line_blend = static_cast<line_blend_t>(blend);
+                }
+                ImGui::SliderInt("Layer", &window_state.m_line_layer, 0, max_line_layers - 1, "%d",
+                                 ImGuiSliderFlags_AlwaysClamp);
+                ImGui::DragFloat("Lifetime", &window_state.m_line_lifetime, 0.1f, 0.0f, 60.0f,
+                                 window_state.m_line_lifetime > 0.0f ? "%.1f s" : "Forever",
+                                 ImGuiSliderFlags_AlwaysClamp);
+                ImGui::Separator();
+                ImGui::Checkbox("Freehand", &window_state.m_freehand);
+                ImGui::SliderFloat("Stroke Tolerance", &window_state.m_stroke_tolerance, 0.1f, 5.0f, "%.1f px",
+                                   ImGuiSliderFlags_AlwaysClamp);
+                ImGui::Text("Stroke points: %llu, vertices: %llu",
+                            static_cast<unsigned long long>(stroke.input_points()),
+                            static_cast<unsigned long long>(stroke.vertices()));
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Density")) {
+                constexpr const char* aggregation_names[] = {"Automatic", "Never", "Always"};
+                auto aggregation = static_cast<int>(window_state.m_line_aggregation);
+                if (ImGui::Combo("Aggregate Lines", &aggregation, aggregation_names, 3)) {
+                    window_state.m_line_aggregation = static_cast<line_aggregation_t>(aggregation);
+                }
+                ImGui::DragInt("From Line Count", &window_state.m_aggregation_line_count, 10'000.0f, 0, 100'000'000,
+                               "%d", ImGuiSliderFlags_AlwaysClamp);
+                ImGui::DragFloat("Below Average Length", &window_state.m_aggregation_average_length, 0.1f, 0.0f, 100.0f,
+                                 "%.1f px", ImGuiSliderFlags_AlwaysClamp);
+                ImGui::DragFloat("Exposure", &window_state.m_density_exposure, 0.001f, 0.001f, 10.0f, "%.3f",
+                                 ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Canvas")) {
+                render_canvas_tab(camera, tile_cache, window_state);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Anti-aliasing")) {
+                render_antialiasing_tab(window_state, governor.settings(), antialiasing_statistics);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Bloom")) {
+                ImGui::Checkbox("Enabled", &window_state.m_bloom_enabled);
+                ImGui::SliderInt("Levels", &window_state.m_bloom_levels, 1, max_bloom_levels, "%d",
+                                 ImGuiSliderFlags_AlwaysClamp);
+                ImGui::DragFloat("Intensity", &window_state.m_bloom_intensity, 0.01f, 0.0f, 4.0f, "%.2f",
+                                 ImGuiSliderFlags_AlwaysClamp);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Performance")) {
+                render_performance_tab(governor, render_target_pool, frame_memory, jobs, redraw_statistics,
+                                       culling_statistics, window_state);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Statistics")) {
+                render_statistics_tab(frame_statistics, options);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Latency")) {
+                render_latency_tab(window_state, input_latency, fence_wait_time);
                 ImGui::EndTabItem();
             }
             if (ImGui::BeginTabItem("Misc.")) {
                 ImGui::Checkbox("Show FPS", &window_state.m_show_fps);
+                ImGui::Text("Simulation tick: %llu", static_cast<unsigned long long>(simulation_state.m_tick));
+                ImGui::Text("Simulation time: %.3f s", simulation_state.m_time);
+                if (ingest_statistics.m_enabled) {
+                    ImGui::Separator();
+                    ImGui::Text("Ingested lines: %llu (%.0f/s)",
+                                static_cast<unsigned long long>(ingest_statistics.m_received),
+                                ingest_statistics.m_lines_per_second);
+                    ImGui::Text("Ring overruns: %llu, sequence errors: %llu",
+                                static_cast<unsigned long long>(ingest_statistics.m_overruns),
+                                static_cast<unsigned long long>(ingest_statistics.m_sequence_errors));
+                }
                 ImGui::EndTabItem();
             }
             ImGui::EndTabBar();
@@ -139,48 +700,125 @@ void render_debug_menu(window_state_t& window_state, bool render_imgui) {
     }
 }
 
+// How far the bloom spreads a line, in window pixels.
+float bloom_damage_margin(const window_state_t& window_state, const quality_settings_t& quality_settings) {
+    if (!window_state.m_bloom_enabled) {
+        return 0.0f;
+    }
+
+    // Every level halves the resolution and its filter reaches a texel or two further.
+    const auto levels = std::clamp(window_state.m_bloom_levels, 1, max_bloom_levels);
+    return static_cast<float>(4 << levels) / quality_settings.m_render_scale;
+}
+
+// The bounds of every ImGui window.
+damage_t imgui_damage(const ImDrawData& draw_data) {
+    damage_t damage;
+    for (const auto* draw_list : draw_data.CmdLists) {
+        if (draw_list->VtxBuffer.empty()) {
+            continue;
+        }
+
+        glm::vec2 min{std::numeric_limits<float>::max()};
+        glm::vec2 max{std::numeric_limits<float>::lowest()};
+        for (const auto& vertex : draw_list->VtxBuffer) {
+            min = glm::min(min, glm::vec2{vertex.pos.x, vertex.pos.y});
+            max = glm::max(max, glm::vec2{vertex.pos.x, vertex.pos.y});
+        }
+        damage.add(damage_rect_t::around_segment(min, max, 0.0f, 1.0f));
+    }
+    return damage;
+}
+
+// Events the user waits to see the result of, the ones the input latency is measured for.
+bool is_input_event(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEWHEEL:
+        case SDL_KEYDOWN:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void on_resize(glm::mat<4, 4, float>& projection_matrix, glm::vec2& window_size, Sint32 x, Sint32 y) {
     projection_matrix = glm::ortho(0.0f, static_cast<float>(x), static_cast<float>(y), 0.0f, -1.0f, 1.0f);
     glViewport(0, 0, x, y);
     window_size = {x, y};
 }
 
-extern "C" int main(int, char**) {
+extern "C" int main(int argc, char** argv) {
+    const auto options = parse_options(argc, argv);
+    TRACE_THREAD_NAME("main");
+
     sdl::init_sub_system(SDL_INIT_TIMER);
     sdl::init_sub_system(SDL_INIT_VIDEO);
     sdl::init_sub_system(SDL_INIT_EVENTS); //
     {
-        std::vector<line> lines;
+        line_scene_t lines;
+        line_batch_t line_batch;
         auto quit = false;
         bool got_first_point = false;
         glm::vec2 first_point = glm::vec2{0.0f};
 
+        std::array<SDL_Event, event_batch_size> events;
+
         auto last_fps_update = 1.0f;
         auto frames_this_update = 0;
-        std::string fps;
+        std::uint32_t frame_index = 0;
+        // Formatted in place, so updating it does not allocate.
+        std::array<char, 16> fps{};
+
+        frame_memory_t frame_memory;
+        job_system_t job_system;
 
-        auto render_imgui = true;
+        // The top left window of a video wall leads, the others take over its scene and only render.
+        const auto wall_leader = options.m_wall_name && options.m_wall_column == 0 && options.m_wall_row == 0;
+        const auto wall_follower = options.m_wall_name && !wall_leader;
+        const glm::vec2 wall_tile{options.m_wall_column, options.m_wall_row};
+        const glm::vec2 wall_grid{options.m_wall_columns, options.m_wall_rows};
+
+        auto render_imgui = !options.m_headless && !wall_follower;
 
         const auto performance_frequency = static_cast<double>(sdl::get_performance_frequency());
         auto delta_time = 0.016f; // 1 frame at 60 fps initially.
-        auto last_time = static_cast<float>(static_cast<double>(sdl::get_performance_counter()) /
-                                            performance_frequency);
+        auto last_time = static_cast<double>(sdl::get_performance_counter()) / performance_frequency;
+
+        fixed_timestep_t timestep(simulation_rate, max_simulation_steps);
+        simulation_state_t previous_simulation_state;
+        simulation_state_t simulation_state;
 
         sdl::gl_set_attribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
         sdl::gl_set_attribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
         sdl::gl_set_attribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-        sdl::gl_set_attribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
-        sdl::gl_set_attribute(SDL_GL_MULTISAMPLESAMPLES, multisample_samples);
-
+        // The lines are anti-aliased in their own frame buffer, see line_antialiasing_t. Everything drawn to the
+        // window is a full screen quad, multisampling it would only cost bandwidth.
+        sdl::gl_set_attribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
+
+        // Benchmarks run in a hidden window of a fixed size so the results do not depend on the desktop.
+        // Captures keep the size they started with, so the window cannot be resized while recording. Neither can the
+        // windows of a video wall, they all have the same size.
+        const auto window_flags = options.m_benchmark_scene || options.m_headless
+                                          ? SDL_WINDOW_HIDDEN | SDL_WINDOW_OPENGL
+                                  : options.m_capture_path || options.m_wall_name
+                                          ? SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL
+                                          : SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE |
+                                                    SDL_WINDOW_ALLOW_HIGHDPI;
         auto window = sdl::create_window("Hello World!", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1280, 720,
-                                         SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE |
-                                         SDL_WINDOW_ALLOW_HIGHDPI);
+                                         window_flags);
 
         auto gl_context = sdl::gl_create_context(window);
         glew::init();
 
-        // Use vsync
-        sdl::gl_try_use_vsync();
+        // Use vsync, unless benchmarking or exporting
+        if (options.m_benchmark_scene || options.m_offline) {
+            sdl::gl_disable_vsync();
+        } else {
+            sdl::gl_try_use_vsync();
+        }
 
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
@@ -198,53 +836,368 @@ extern "C" int main(int, char**) {
         // Set the window size and projection matrix
         on_resize(projection_matrix, window_size, 1280, 720);
 
-        auto stuff = init_gl(window_size);
+        // Declared before the shader stuff so the render targets outlive everything that refers to them.
+        gl::render_target_pool_t render_target_pool;
+        auto stuff = init_gl(render_target_pool, window_size);
+
+        // While the window is being resized the render targets keep their old size and get stretched.
+        // They only follow once the size has settled, so a drag does not reallocate them on every event.
+        glm::ivec2 render_target_size = window_size;
+        auto last_resize_time = 0.0;
 
         window_state_t window_state;
 
+        stroke_simplifier_t stroke(window_state.m_stroke_tolerance);
+        auto stroking = false;
+        // Last vertex of the stroke that has been turned into a line.
+        glm::vec2 stroke_vertex{0.0f};
+
+        damage_tracker_t damage_tracker;
+        // New lines also change the bloom around them.
+        auto line_damage_margin = 0.0f;
+        // ImGui is drawn on top of the scene, so where it was in the last frame has to be redrawn as well.
+        damage_t previous_ui_damage;
+        std::optional<redraw_key_t> previous_redraw_key;
+        redraw_statistics_t redraw_statistics;
+        culling_statistics_t culling_statistics;
+
+        camera_t camera;
+        auto panning = false;
+        tile_cache_t tile_cache;
+
+        // The tiles the line is drawn over have to be baked again.
+        const auto invalidate_tiles = [&](const glm::vec2& start_position, const glm::vec2& end_position,
+                                          float width) {
+            const auto extent = glm::vec2(width * 0.5f);
+            tile_cache.invalidate(glm::min(start_position, end_position) - extent,
+                                  glm::max(start_position, end_position) + extent);
+        };
+
+#ifdef VIDEO_WALL_SUPPORTED
+        std::optional<video_wall_t> video_wall;
+        const auto wall_processes = static_cast<std::uint32_t>(options.m_wall_columns * options.m_wall_rows);
+        if (wall_leader) {
+            video_wall.emplace(video_wall_t::create(*options.m_wall_name, wall_processes, video_wall_line_capacity));
+        } else if (wall_follower) {
+            video_wall.emplace(video_wall_t::open(*options.m_wall_name, wall_processes));
+        }
+#endif
+
+        // The lines the leader of a video wall adds are drawn by every window.
+        const auto share_line = [&]([[maybe_unused]] const line& value) {
+#ifdef VIDEO_WALL_SUPPORTED
+            if (wall_leader) {
+                video_wall->add_line(value);
+            }
+#endif
+        };
+
+        // The points are in window pixels, and so are the widths at the zoom the line is drawn at.
+        const auto add_line = [&](const glm::vec2& start_point, const glm::vec2& end_point) {
+            const auto start_position = camera.screen_to_world(start_point);
+            const auto end_position = camera.screen_to_world(end_point);
+            share_line(lines.emplace(start_position, end_position, window_state.m_line_color,
+                                     window_state.m_start_width / camera.zoom(),
+                                     window_state.m_end_width / camera.zoom(), window_state.m_line_blend,
+                                     window_state.m_line_layer, static_cast<float>(simulation_state.m_time),
+                                     window_state.m_line_lifetime));
+
+            const auto max_width = std::max(window_state.m_start_width, window_state.m_end_width);
+            damage_tracker.add(damage_rect_t::around_segment(start_point, end_point, max_width, line_damage_margin));
+            if (window_state.m_tiled_canvas) {
+                invalidate_tiles(start_position, end_position, max_width / camera.zoom());
+            }
+        };
+
+        // Every window of a video wall generates the same lines, rather than receiving them, and the wall as a whole
+        // shows all of them.
+        if (options.m_generate_preset && !options.m_benchmark_scene) {
+            const auto& preset = generator_preset(*options.m_generate_preset);
+            lines = line_scene_t(generate_lines(preset, options.m_generate_count.value_or(preset.m_default_count),
+                                                options.m_generate_seed, job_system));
+            camera = camera_t::fitting(generator_canvas_size, window_size * wall_grid);
+        }
+
+        frame_governor_t governor;
+        governor.set_max_msaa_samples(std::min(gl::get_integer(GL_MAX_SAMPLES), 8));
+        // The leader picks the quality of the whole video wall, the windows would not match otherwise.
+        governor.m_enabled = !wall_follower;
+        auto gpu_timer = gl::gpu_timer_t::create();
+        auto gpu_frame_time = 0.0f;
+        auto lines_timer = gl::gpu_timer_t::create();
+        antialiasing_statistics_t antialiasing_statistics;
+
+        frame_statistics_t frame_statistics;
+        auto frame_fences = gl::frame_fence_ring_t::create();
+        input_latency_t input_latency;
+        auto fence_wait_time = 0.0f;
+        const auto retire_frames = [&](int max_pending) {
+            if (const auto frame = frame_fences.retire(max_pending)) {
+                input_latency.frames_completed(*frame, sdl::get_ticks());
+            }
+        };
+        const auto refresh_rate = sdl::get_window_refresh_rate(window);
+        const auto refresh_period = refresh_rate > 0 ? 1000.0f / static_cast<float>(refresh_rate) : 0.0f;
+
+        std::optional<frame_capture_t> frame_capture;
+        if (options.m_capture_path) {
+            frame_capture.emplace(frame_capture_t::create(*options.m_capture_path, window_size,
+                                                          options.m_capture_frame_rate, options.m_offline));
+        }
+        const auto offline_delta_time = 1.0f / static_cast<float>(options.m_capture_frame_rate);
+
+        ingest_statistics_t ingest_statistics;
+        std::uint64_t ingested_at_last_update = 0;
+#ifdef LINE_RING_SUPPORTED
+        std::optional<line_ring_t> line_ring;
+        if (options.m_ingest_name) {
+            line_ring.emplace(line_ring_t::create(*options.m_ingest_name, line_ring_capacity));
+            ingest_statistics.m_enabled = true;
+        }
+#endif
+
+        auto exit_code = EXIT_SUCCESS;
+        if (options.m_benchmark_scene) {
+            exit_code = run_benchmark(options, window, stuff, render_target_pool, gpu_timer, frame_statistics,
+                                      job_system, projection_matrix, window_size);
+            quit = true;
+        }
 
         while (!quit) {
-            for (auto pool_event_result = sdl::pool_event(); pool_event_result.pending_event;
-                 pool_event_result = sdl::pool_event()) {
-                ImGui_ImplSDL2_ProcessEvent(&pool_event_result.event);
-
-                switch (pool_event_result.event.type) {
-                    case SDL_QUIT:
-                        std::cout << "Quitting..." << std::endl;
-                        quit = true;
-                        break;
-
-                    case SDL_MOUSEBUTTONDOWN:
-                        if (pool_event_result.event.button.button == SDL_BUTTON_LEFT && !ImGui::IsWindowHovered(
-                                    ImGuiHoveredFlags_AnyWindow)) {
-                            auto x = pool_event_result.event.button.x;
-                            auto y = pool_event_result.event.button.y;
-                            if (!got_first_point) {
-                                first_point = glm::vec2{x, y};
-                                got_first_point = true;
-                            } else {
-                                glm::vec2 end_position{x, y};
-                                lines.emplace_back(first_point, end_position, window_state.m_line_color, window_state.m_start_width, window_state.m_end_width);
-                                got_first_point = false;
+            TRACE_ZONE("frame");
+
+            // Waiting for the GPU here, before the events are read, rather than in a swap that blocks on a full queue,
+            // shows the input in the next frame instead of behind the frames the driver has queued.
+            if (window_state.m_low_latency) {
+                TRACE_ZONE("fence wait");
+                const auto wait_start = sdl::get_performance_counter();
+                retire_frames(window_state.m_max_frames_in_flight - 1);
+                fence_wait_time = static_cast<float>(
+                        static_cast<double>(sdl::get_performance_counter() - wait_start) / performance_frequency *
+                        1000.0);
+            }
+
+            const auto frame_start = sdl::get_performance_counter();
+            const auto frame_start_allocations = allocation_counter::allocations();
+            frame_memory.m_arena.reset();
+            line_damage_margin = bloom_damage_margin(window_state, governor.settings());
+
+            // The queue is drained in batches rather than an event at a time.
+            sdl::pump_events();
+            std::size_t frame_events = 0;
+            for (auto event_count = events.size(); event_count == events.size();) {
+                TRACE_ZONE("events");
+                event_count = sdl::peep_events(events);
+                frame_events += event_count;
+
+                for (const auto& event : std::span(events).first(event_count)) {
+                    ImGui_ImplSDL2_ProcessEvent(&event);
+                    if (is_input_event(event)) {
+                        input_latency.add_event(event.common.timestamp);
+                    }
+
+                    switch (event.type) {
+                        case SDL_QUIT:
+                            // Not stdout, a capture may be streaming there.
+                            std::clog << "Quitting..." << std::endl;
+                            quit = true;
+                            break;
+
+                        case SDL_MOUSEBUTTONDOWN:
+                            // Only the leader of a video wall draws and moves the camera.
+                            if (wall_follower) {
+                                break;
+                            }
+                            if (event.button.button == SDL_BUTTON_LEFT && !ImGui::IsWindowHovered(
+                                        ImGuiHoveredFlags_AnyWindow)) {
+                                auto x = event.button.x;
+                                auto y = event.button.y;
+                                if (window_state.m_freehand) {
+                                    stroke.set_tolerance(window_state.m_stroke_tolerance);
+                                    stroke.begin(glm::vec2{x, y});
+                                    stroke_vertex = glm::vec2{x, y};
+                                    stroking = true;
+                                } else if (!got_first_point) {
+                                    first_point = glm::vec2{x, y};
+                                    got_first_point = true;
+                                } else {
+                                    glm::vec2 end_position{x, y};
+                                    add_line(first_point, end_position);
+                                    got_first_point = false;
+                                }
+                            } else if (event.button.button == SDL_BUTTON_RIGHT && !ImGui::IsWindowHovered(
+                                               ImGuiHoveredFlags_AnyWindow)) {
+                                panning = true;
                             }
-                        }
-                        break;
-
-                    case SDL_WINDOWEVENT:
-                        if (pool_event_result.event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                            auto x = pool_event_result.event.window.data1;
-                            auto y = pool_event_result.event.window.data2;
-
-                            on_resize(projection_matrix, window_size, x, y);
-                        }
-                        break;
-
-                    case SDL_KEYDOWN:
-                        if (pool_event_result.event.key.keysym.scancode == SDL_SCANCODE_F9) {
-                            render_imgui = !render_imgui;
-                        }
-                        break;
+                            break;
+
+                        case SDL_MOUSEMOTION:
+                            if (panning) {
+                                camera.pan(glm::vec2{event.motion.xrel, event.motion.yrel});
+                            }
+                            // Only the simplified stroke becomes lines, not every motion event.
+                            if (stroking) {
+                                if (const auto vertex = stroke.add(glm::vec2{event.motion.x, event.motion.y})) {
+                                    add_line(stroke_vertex, *vertex);
+                                    stroke_vertex = *vertex;
+                                }
+                            }
+                            break;
+
+                        case SDL_MOUSEBUTTONUP:
+                            if (stroking && event.button.button == SDL_BUTTON_LEFT) {
+                                if (const auto vertex = stroke.end()) {
+                                    add_line(stroke_vertex, *vertex);
+                                }
+                                stroking = false;
+                            }
+                            if (event.button.button == SDL_BUTTON_RIGHT) {
+                                panning = false;
+                            }
+                            break;
+
+                        case SDL_MOUSEWHEEL:
+                            // Around the mouse, so what is under it stays there.
+                            if (!wall_follower && event.wheel.y != 0 &&
+                                !ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow)) {
+                                const auto mouse = sdl::get_mouse_position();
+                                const auto steps = event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y
+                                                                                                 : event.wheel.y;
+                                camera.zoom_at(glm::vec2{mouse.x, mouse.y},
+                                               std::pow(camera_zoom_step, static_cast<float>(steps)));
+                            }
+                            break;
+
+                        case SDL_WINDOWEVENT:
+                            if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+                                auto x = event.window.data1;
+                                auto y = event.window.data2;
+
+                                on_resize(projection_matrix, window_size, x, y);
+                                last_resize_time = static_cast<double>(sdl::get_performance_counter()) /
+                                                   performance_frequency;
+                            }
+                            break;
+
+                        case SDL_KEYDOWN:
+                            if (event.key.keysym.scancode == SDL_SCANCODE_F9) {
+                                render_imgui = !render_imgui;
+                            }
+#ifdef TRACING_ENABLED
+                            if (event.key.keysym.scancode == SDL_SCANCODE_F10) {
+                                const auto path = options.m_trace_path.value_or("trace.json");
+                                if (trace::export_json(path)) {
+                                    std::clog << "Wrote the trace to " << path << std::endl;
+                                }
+                            }
+#endif
+                            break;
+                    }
+                }
+            }
+
+#ifdef LINE_RING_SUPPORTED
+            // The records are turned into lines where they are, in the shared memory.
+            if (line_ring) {
+                TRACE_ZONE("ingest");
+                // Tiles are invalidated for batches of records that lie close together. A call per record goes over
+                // the whole atlas every time, and a single rectangle around all of them would cover most of the canvas.
+                const auto batch_extent = tile_key_t{tile_level(camera.zoom()), {0, 0}}.world_size();
+                glm::vec2 batch_min{std::numeric_limits<float>::max()};
+                glm::vec2 batch_max{std::numeric_limits<float>::lowest()};
+                const auto invalidate_batch = [&] {
+                    if (window_state.m_tiled_canvas && batch_min.x <= batch_max.x) {
+                        tile_cache.invalidate(batch_min, batch_max);
+                    }
+                    batch_min = glm::vec2{std::numeric_limits<float>::max()};
+                    batch_max = glm::vec2{std::numeric_limits<float>::lowest()};
+                };
+                frame_events += line_ring->drain(max_ingested_lines_per_frame, [&](const line_record_t& record) {
+                    const glm::vec2 start_position{record.m_start_position[0], record.m_start_position[1]};
+                    const glm::vec2 end_position{record.m_end_position[0], record.m_end_position[1]};
+                    share_line(lines.emplace(
+                            start_position, end_position,
+                            glm::vec3{record.m_color[0], record.m_color[1], record.m_color[2]},
+                            record.m_start_width, record.m_end_width,
+                            static_cast<line_blend_t>(std::min<std::uint32_t>(record.m_blend, line_blend_count - 1)),
+                            record.m_layer, static_cast<float>(simulation_state.m_time),
+                            window_state.m_line_lifetime));
+
+                    // Records are in world coordinates.
+                    const auto max_width = std::max(record.m_start_width, record.m_end_width);
+                    damage_tracker.add(damage_rect_t::around_segment(
+                            camera.world_to_screen(start_position), camera.world_to_screen(end_position),
+                            max_width * camera.zoom(), line_damage_margin));
+                    const auto extent = glm::vec2(max_width * 0.5f);
+                    const auto record_min = glm::min(start_position, end_position) - extent;
+                    const auto record_max = glm::max(start_position, end_position) + extent;
+                    const auto merged_size = glm::max(batch_max, record_max) - glm::min(batch_min, record_min);
+                    if (merged_size.x > batch_extent || merged_size.y > batch_extent) {
+                        invalidate_batch();
+                    }
+                    batch_min = glm::min(batch_min, record_min);
+                    batch_max = glm::max(batch_max, record_max);
+                });
+                invalidate_batch();
+                ingest_statistics.m_received = line_ring->received();
+                ingest_statistics.m_overruns = line_ring->overruns();
+                ingest_statistics.m_sequence_errors = line_ring->sequence_errors();
+            }
+#endif
+
+            const auto simulation_steps = timestep.advance(delta_time);
+            for (auto i = 0; i < simulation_steps; i++) {
+                TRACE_ZONE("simulation step");
+                previous_simulation_state = simulation_state;
+                update_simulation(simulation_state, timestep.step());
+            }
+            auto render_simulation_state = interpolate_simulation(previous_simulation_state, simulation_state,
+                                                                  timestep.alpha());
+
+#ifdef VIDEO_WALL_SUPPORTED
+            // The followers show the scene of the leader at the time of the leader, not their own.
+            if (wall_leader) {
+                TRACE_ZONE("video wall publish");
+                video_wall->publish(video_wall_state_t{render_simulation_state, camera, window_state,
+                                                       governor.settings()});
+            } else if (wall_follower) {
+                TRACE_ZONE("video wall receive");
+                video_wall_state_t wall_state;
+                auto received_lines = false;
+                const auto received = video_wall->receive(wall_state, [&](const line& value) {
+                    lines.add(value);
+                    received_lines = true;
+                });
+                if (!received) {
+                    break;
                 }
+
+                render_simulation_state = wall_state.m_simulation_state;
+                camera = wall_state.m_camera;
+                window_state = wall_state.m_window_state;
+                governor.settings() = wall_state.m_quality_settings;
+                if (received_lines) {
+                    tile_cache.invalidate_all();
+                }
+            }
+#endif
+
+            // Every window of a video wall shows its own part of the canvas. Stars are seeded by canvas pixels, which
+            // OpenGL counts from the bottom.
+            const auto view_camera = camera.shifted(wall_tile * window_size);
+            const glm::vec2 canvas_offset{wall_tile.x * window_size.x,
+                                          (wall_grid.y - 1.0f - wall_tile.y) * window_size.y};
+
+            // The vertex shader fades the lines out, they are only erased once they are gone. Taken before they are,
+            // the bounds cover both the lines that are still fading and the ones that disappear this frame.
+            const auto fading_bounds = lines.fading_bounds();
+            lines.retire(static_cast<float>(render_simulation_state.m_time));
+
+            // Lines added while the canvas is not tiled are not tracked.
+            if (!window_state.m_tiled_canvas) {
+                tile_cache.invalidate_all();
+            } else if (fading_bounds) {
+                tile_cache.invalidate(fading_bounds->m_min, fading_bounds->m_max);
             }
 
             if (render_imgui) {
@@ -255,7 +1208,12 @@ extern "C" int main(int, char**) {
 
             if (last_fps_update >= 1.0f) {
                 auto frames = static_cast<float>(frames_this_update) / last_fps_update;
-                fps = std::format("{:.0f} fps", frames);
+                const auto result = std::format_to_n(fps.data(), fps.size() - 1, "{:.0f} fps", frames);
+                *result.out = '\0';
+                job_system.sample_utilization();
+                ingest_statistics.m_lines_per_second = static_cast<float>(
+                        ingest_statistics.m_received - ingested_at_last_update) / last_fps_update;
+                ingested_at_last_update = ingest_statistics.m_received;
                 last_fps_update = 0.0f;
                 frames_this_update = 0;
             }
@@ -263,32 +1221,199 @@ extern "C" int main(int, char**) {
             last_fps_update += delta_time;
             frames_this_update++;
 
-            render_debug_menu(window_state, render_imgui);
+            if (render_target_size != glm::ivec2(window_size) &&
+                static_cast<double>(frame_start) / performance_frequency - last_resize_time >= resize_settle_time) {
+                render_target_size = window_size;
+            }
+
+            render_debug_menu(window_state, governor, render_target_pool, frame_statistics, options,
+                              render_simulation_state, stroke, frame_memory, job_system,
+                              ingest_statistics, redraw_statistics, culling_statistics, antialiasing_statistics,
+                              input_latency, fence_wait_time, camera, tile_cache, render_imgui);
 
             if (window_state.m_show_fps && render_imgui) {
                 ImGui::GetForegroundDrawList()->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(0.0f, 0.0f),
-                                                        ImColor(1.0f, 1.0f, 1.0f), fps.c_str(), nullptr, 0.0f, nullptr);
+                                                        ImColor(1.0f, 1.0f, 1.0f), fps.data(), nullptr, 0.0f, nullptr);
             }
 
             //ImGui::ShowDemoWindow();
 
-            render(stuff, projection_matrix, window_state, lines, window_size);
-
+            // Built before the scene is drawn, so the damage it causes is known.
+            damage_t ui_damage;
             if (render_imgui) {
+                TRACE_ZONE("ImGui::Render");
                 ImGui::Render();
+                ui_damage = imgui_damage(*ImGui::GetDrawData());
+            }
+
+            // Switching between drawing and aggregating the lines changes every pixel.
+            const auto aggregate_lines = should_aggregate_lines(window_state, view_camera, lines.size(), line_batch);
+            const redraw_key_t redraw_key{window_size, render_target_size, governor.settings(),
+                                          window_state.m_stars_background_color, window_state.m_stars_density,
+                                          window_state.m_bloom_enabled, window_state.m_bloom_levels,
+                                          window_state.m_bloom_intensity, window_state.m_partial_redraw,
+                                          window_state.m_gpu_culling, aggregate_lines,
+                                          window_state.m_density_exposure, view_camera,
+                                          window_state.m_tiled_canvas, window_state.m_line_antialiasing};
+            damage_tracker.set_window_size(window_size);
+            // Tiles that could not be baked yet show a coarser level until a later frame gets to them. The followers of
+            // a video wall do not track where the lines of the leader land.
+            if (!window_state.m_partial_redraw || redraw_key != previous_redraw_key ||
+                (window_state.m_tiled_canvas && !tile_cache.complete()) || wall_follower) {
+                damage_tracker.add_full();
+            }
+            if (fading_bounds) {
+                damage_tracker.add(damage_rect_t::around_segment(view_camera.world_to_screen(fading_bounds->m_min),
+                                                                 view_camera.world_to_screen(fading_bounds->m_max),
+                                                                 0.0f, line_damage_margin));
+            }
+            previous_redraw_key = redraw_key;
+
+            // The lines frame buffer keeps its contents, so it only needs this frame's damage.
+            const auto lines_damage = damage_tracker.frame_damage();
+            for (const auto& rect : previous_ui_damage.rects()) {
+                damage_tracker.add(rect);
+            }
+            for (const auto& rect : ui_damage.rects()) {
+                damage_tracker.add(rect);
+            }
+            previous_ui_damage = ui_damage;
+
+            const auto buffer_age = sdl::gl_back_buffer_age();
+            const auto back_buffer_damage = damage_tracker.buffer_damage(buffer_age);
+            redraw_statistics = {buffer_age, back_buffer_damage.coverage(window_size)};
+
+            gpu_timer.begin();
+            render(stuff, render_target_pool, projection_matrix, view_camera, canvas_offset, window_state,
+                   governor.settings(), lines, line_batch, aggregate_lines,
+                   window_state.m_tiled_canvas ? &tile_cache : nullptr, &lines_timer, frame_memory.m_arena,
+                   job_system, lines_damage, back_buffer_damage, window_size, render_target_size,
+                   static_cast<float>(render_simulation_state.m_time), frame_index++);
+            gpu_timer.end();
+
+            // Before ImGui, the debug menu does not belong in the recording.
+            if (frame_capture) {
+                TRACE_ZONE("capture");
+                frame_capture->capture();
+            }
+
+            if (render_imgui) {
+                TRACE_ZONE("ImGui_ImplOpenGL3_RenderDrawData");
                 ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
             }
 
-            auto now = static_cast<float>(static_cast<double>(sdl::get_performance_counter()) / performance_frequency);
-            delta_time = now - last_time;
+            if (const auto gpu_time = gpu_timer.try_read()) {
+                gpu_frame_time = *gpu_time;
+            }
+            // Results arrive a few frames late, each is filed under the mode it was measured in.
+            if (const auto lines_time = lines_timer.try_read_tagged()) {
+                antialiasing_statistics.m_lines_gpu_time[lines_time->m_tag] = lines_time->m_milliseconds;
+            }
+            if (auto& cull_stuff = stuff.line_shader_stuff.cull_stuff) {
+                if (const auto primitives = cull_stuff->primitive_counter.try_read()) {
+                    // Every instance is a fan of vertex_indices.size() - 2 triangles.
+                    culling_statistics = {*primitives / (vertex_indices.size() - 2), lines.size()};
+                }
+            }
+            const auto frame_end = sdl::get_performance_counter();
+            const auto cpu_frame_time = static_cast<float>(
+                    static_cast<double>(frame_end - frame_start) / performance_frequency * 1000.0);
+            // Measured at the same point as the CPU time, so the interval ends with the work of this frame.
+            const auto now = static_cast<double>(frame_end) / performance_frequency;
+            const auto frame_interval = static_cast<float>(now - last_time);
             last_time = now;
+            delta_time = options.m_offline ? offline_delta_time : frame_interval;
+
+            governor.m_msaa_active = window_state.m_line_antialiasing == line_antialiasing_t::multisample;
+            governor.add_frame(cpu_frame_time, gpu_frame_time);
+
+            frame_statistics.add_frame({cpu_frame_time, gpu_frame_time, frame_interval * 1000.0f}, refresh_period);
+            if (frame_statistics.total_frames() % statistics_summary_interval == 0) {
+                frame_statistics.summarize();
+                input_latency.summarize();
+            }
+
+            // Events may add lines or resize the window, which grows the persistent buffers. Without any, the
+            // frame only reuses memory, and ImGui and the drivers allocate with malloc, not operator new.
+            frame_memory.m_last_frame_arena_used = frame_memory.m_arena.used();
+            frame_memory.m_last_frame_allocations = allocation_counter::allocations() - frame_start_allocations;
+            if (frame_events == 0 && frame_memory.m_last_frame_allocations > 0 &&
+                frame_statistics.total_frames() > benchmark_warmup_frames) {
+#ifndef NDEBUG
+                if (frame_memory.m_allocating_idle_frames == 0) {
+                    std::clog << "Warning: idle frame made " << frame_memory.m_last_frame_allocations
+                              << " heap allocations" << std::endl;
+                }
+#endif
+                frame_memory.m_allocating_idle_frames++;
+            }
+
+            // The compositor only needs what changed since the previous frame, whatever the age of the back buffer.
+            std::array<SDL_Rect, damage_t::max_rects> swap_damage;
+            const auto& frame_damage = damage_tracker.frame_damage();
+            auto swap_damage_count = 0;
+            if (!frame_damage.full()) {
+                for (const auto& rect : frame_damage.rects()) {
+                    swap_damage[swap_damage_count++] = {rect.m_min.x, static_cast<int>(window_size.y) - rect.m_max.y,
+                                                        rect.m_max.x - rect.m_min.x, rect.m_max.y - rect.m_min.y};
+                }
+                // Nothing changed. No rectangles would mean the whole window, so a single pixel is passed instead.
+                if (swap_damage_count == 0) {
+                    swap_damage[swap_damage_count++] = {0, 0, 1, 1};
+                }
+            }
+#ifdef VIDEO_WALL_SUPPORTED
+            // All windows of a video wall present the same frame together.
+            if (video_wall && !video_wall->present_barrier()) {
+                quit = true;
+            }
+#endif
+
+            // No rectangles means the whole window.
+            sdl::gl_swap_window_with_damage(window, std::span(swap_damage).first(swap_damage_count));
+            damage_tracker.end_frame();
+
+            // The fence follows the swap, so it signals once the GPU is done with everything the frame shows.
+            frame_fences.insert(frame_index);
+            input_latency.end_frame(frame_index);
+            retire_frames(gl::frame_fence_ring_t::max_frames_in_flight);
+
+            if (options.m_quit_after && frame_index >= static_cast<std::uint32_t>(*options.m_quit_after)) {
+                quit = true;
+            }
+        }
+
+        if (frame_capture) {
+            frame_capture->finish();
+            std::clog << "Captured " << frame_capture->written() << " frames, dropped " << frame_capture->dropped()
+                      << std::endl;
+        }
+
+#ifdef VIDEO_WALL_SUPPORTED
+        if (video_wall && video_wall->dropped_lines() > 0) {
+            std::clog << "The video wall dropped " << video_wall->dropped_lines() << " lines" << std::endl;
+        }
+#endif
+
+        if (options.m_frame_statistics_path) {
+            frame_statistics.summarize();
+            frame_statistics.export_to_file(*options.m_frame_statistics_path);
+        }
 
-            sdl::gl_swap_window(window);
+#ifdef TRACING_ENABLED
+        if (options.m_trace_path) {
+            trace::export_json(*options.m_trace_path);
         }
+#endif
 
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplSDL2_Shutdown();
         ImGui::DestroyContext();
+
+        if (exit_code != EXIT_SUCCESS) {
+            sdl::quit();
+            return exit_code;
+        }
     }
 
 
@@ -298,6 +1423,7 @@ extern "C" int main(int, char**) {
 }
 
 star_shader_stuff_t create_star_shader() {
+    TRACE_ZONE("create_star_shader");
     auto program = gl::create_program();
 
     auto vertex_shader = gl::vertex_shader_t::create_shader(program, resources::star_vertex_shader_vsh);
@@ -306,26 +1432,50 @@ star_shader_stuff_t create_star_shader() {
 
     gl::link_program(program);
 
+    using vertex_bindings = shader_bindings::star_vertex_shader_vsh;
+    static_assert(gl::interfaces_match<vertex_bindings, shader_bindings::star_fragment_shader_fsh>());
+
     auto vertex_array_object = gl::generate_vertex_array_object();
-    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(program, "vertex_position");
+    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(vertex_bindings::vertex_position);
     auto index_buffer_object = gl::index_buffer_object_t::create_buffer_object(vertex_indices);
 
-    auto projection_uniform = gl::get_uniform_location(program, "projection_matrix");
-    auto background_color_uniform = gl::get_uniform_location(program, "background_color");
-    auto star_density_uniform = gl::get_uniform_location(program, "star_density");
-
     return {std::move(program),
             std::move(vertex_shader),
             std::move(fragment_shader),
             std::move(vertex_array_object),
             std::move(vertex_buffer_object),
-            std::move(index_buffer_object),
-            projection_uniform,
-            background_color_uniform,
-            star_density_uniform};
+            std::move(index_buffer_object)};
+}
+
+line_cull_stuff_t create_line_cull() {
+    TRACE_ZONE("create_line_cull");
+    auto program = gl::create_program();
+
+    auto compute_shader = gl::compute_shader_t::create_shader(program, resources::line_cull_csh);
+
+    gl::link_program(program);
+
+    // The compacted instances are read through the same attributes as the instances of the line batch.
+    using vertex_bindings = shader_bindings::vertex_shader_vsh;
+    auto model_matrix_buffer_object = gl::model_matrix_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_matrix);
+    auto model_color_buffer_object = gl::model_color_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_color);
+    auto vertex_width_buffer_object = gl::vertex_width_buffer_object_t::create_buffer_object(
+            vertex_bindings::vertex_width);
+    auto lifetime_buffer_object = gl::line_lifetime_buffer_object_t::create_buffer_object(vertex_bindings::lifetime);
+
+    return {std::move(program),
+            std::move(compute_shader),
+            std::move(model_matrix_buffer_object),
+            std::move(model_color_buffer_object),
+            std::move(vertex_width_buffer_object),
+            std::move(lifetime_buffer_object),
+            gl::primitive_counter_t::create()};
 }
 
-line_shader_stuff_t create_line_shader(glm::ivec2 window_size) {
+line_shader_stuff_t create_line_shader(gl::render_target_pool_t& render_target_pool, glm::ivec2 window_size) {
+    TRACE_ZONE("create_line_shader");
     auto program = gl::create_program();
 
     // Vertex shader
@@ -336,25 +1486,30 @@ line_shader_stuff_t create_line_shader(glm::ivec2 window_size) {
 
     gl::link_program(program);
 
-    const auto projection_uniform = gl::get_uniform_location(program, "projection_matrix");
-
+    using vertex_bindings = shader_bindings::vertex_shader_vsh;
+    static_assert(gl::interfaces_match<vertex_bindings, shader_bindings::fragment_shader_fsh>());
 
     auto vertex_array_object = gl::generate_vertex_array_object();
     auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(
-            vertex_positions, program, "vertex_position");
+            vertex_positions, vertex_bindings::vertex_position);
     auto index_buffer_object = gl::index_buffer_object_t::create_buffer_object(vertex_indices);
     auto texture_coordinate_buffer_object = gl::texture_coordinate_buffer_object_t::create_buffer_object(
-            vertex_uvs, program, "vertex_uv");
-    auto model_matrix_buffer_object = gl::model_matrix_buffer_object_t::create_buffer_object(program, "model_matrix");
-    auto model_color_buffer_object = gl::model_color_buffer_object_t::create_buffer_object(program, "model_color");
-    auto vertex_width_buffer_object = gl::vertex_width_buffer_object_t::create_buffer_object(program, "vertex_width");
-
-    auto frame_buffer_object = gl::frame_buffer_object_t::create(window_size);
+            vertex_uvs, vertex_bindings::vertex_uv);
+    auto model_matrix_buffer_object = gl::model_matrix_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_matrix);
+    auto model_color_buffer_object = gl::model_color_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_color);
+    auto vertex_width_buffer_object = gl::vertex_width_buffer_object_t::create_buffer_object(
+            vertex_bindings::vertex_width);
+    auto lifetime_buffer_object = gl::line_lifetime_buffer_object_t::create_buffer_object(vertex_bindings::lifetime);
+    auto indirect_buffer_object = gl::indirect_buffer_object_t::create_buffer_object();
+
+    // Linear filtering so the bloom downsample can use bilinear taps.
+    auto frame_buffer_target = render_target_pool.acquire(window_size, GL_LINEAR);
 
     return {std::move(program),
             std::move(vertex_shader),
             std::move(fragment_shader),
-            projection_uniform,
             std::move(vertex_array_object),
             std::move(vertex_buffer_object),
             std::move(index_buffer_object),
@@ -362,10 +1517,81 @@ line_shader_stuff_t create_line_shader(glm::ivec2 window_size) {
             std::move(model_matrix_buffer_object),
             std::move(model_color_buffer_object),
             std::move(vertex_width_buffer_object),
-            std::move(frame_buffer_object)};
+            std::move(lifetime_buffer_object),
+            std::move(indirect_buffer_object),
+            frame_buffer_target,
+            gl::supports_compute_shaders() ? std::optional(create_line_cull()) : std::nullopt};
+}
+
+density_shader_stuff_t create_density_shader(gl::render_target_pool_t& render_target_pool) {
+    TRACE_ZONE("create_density_shader");
+    auto program = gl::create_program();
+
+    auto vertex_shader = gl::vertex_shader_t::create_shader(program, resources::density_vertex_shader_vsh);
+    auto fragment_shader = gl::fragment_shader_t::create_shader(program, resources::density_fragment_shader_fsh);
+
+    gl::link_program(program);
+
+    using vertex_bindings = shader_bindings::density_vertex_shader_vsh;
+    static_assert(gl::interfaces_match<vertex_bindings, shader_bindings::density_fragment_shader_fsh>());
+
+    auto vertex_array_object = gl::generate_vertex_array_object();
+    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(
+            density_vertex_positions, vertex_bindings::vertex_position);
+    auto model_matrix_buffer_object = gl::model_matrix_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_matrix);
+    auto model_color_buffer_object = gl::model_color_buffer_object_t::create_buffer_object(
+            vertex_bindings::model_color);
+    auto lifetime_buffer_object = gl::line_lifetime_buffer_object_t::create_buffer_object(vertex_bindings::lifetime);
+
+    // Sums of many lines need more than 8 bits. Grown to the size of the lines once they are aggregated.
+    auto frame_buffer_target = render_target_pool.acquire({1, 1}, GL_NEAREST, 1, GL_RGBA32F);
+
+    return {std::move(program),
+            std::move(vertex_shader),
+            std::move(fragment_shader),
+            std::move(vertex_array_object),
+            std::move(vertex_buffer_object),
+            std::move(model_matrix_buffer_object),
+            std::move(model_color_buffer_object),
+            std::move(lifetime_buffer_object),
+            frame_buffer_target};
+}
+
+tile_shader_stuff_t create_tile_shader(gl::render_target_pool_t& render_target_pool) {
+    TRACE_ZONE("create_tile_shader");
+    auto program = gl::create_program();
+
+    auto vertex_shader = gl::vertex_shader_t::create_shader(program, resources::tile_vertex_shader_vsh);
+    auto fragment_shader = gl::fragment_shader_t::create_shader(program, resources::tile_fragment_shader_fsh);
+
+    gl::link_program(program);
+
+    using vertex_bindings = shader_bindings::tile_vertex_shader_vsh;
+    static_assert(gl::interfaces_match<vertex_bindings, shader_bindings::tile_fragment_shader_fsh>());
+
+    // The corners of a tile are those of the texture coordinates of a quad.
+    auto vertex_array_object = gl::generate_vertex_array_object();
+    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(
+            vertex_uvs, vertex_bindings::vertex_position);
+    auto tile_rect_buffer_object = gl::tile_rect_buffer_object_t::create_buffer_object(vertex_bindings::tile_rect);
+    auto atlas_rect_buffer_object = gl::tile_rect_buffer_object_t::create_buffer_object(vertex_bindings::atlas_rect);
+
+    // Linear filtering for the zoom levels in between. Grown to the size of the atlas once the canvas is tiled.
+    auto atlas_target = render_target_pool.acquire({1, 1}, GL_LINEAR);
+
+    return {std::move(program),
+            std::move(vertex_shader),
+            std::move(fragment_shader),
+            std::move(vertex_array_object),
+            std::move(vertex_buffer_object),
+            std::move(tile_rect_buffer_object),
+            std::move(atlas_rect_buffer_object),
+            atlas_target};
 }
 
 combiner_shader_stuff_t create_combiner_shader() {
+    TRACE_ZONE("create_combiner_shader");
     auto program = gl::create_program();
 
     auto vertex_shader = gl::vertex_shader_t::create_shader(program, resources::star_vertex_shader_vsh);
@@ -373,14 +1599,19 @@ combiner_shader_stuff_t create_combiner_shader() {
 
     gl::link_program(program);
 
+    using vertex_bindings = shader_bindings::star_vertex_shader_vsh;
+    using fragment_bindings = shader_bindings::combiner_fragment_shader_fsh;
+    static_assert(gl::interfaces_match<vertex_bindings, fragment_bindings>());
+
     auto vertex_array_object = gl::generate_vertex_array_object();
-    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(program, "vertex_position");
+    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(vertex_bindings::vertex_position);
     auto index_buffer_object = gl::index_buffer_object_t::create_buffer_object(vertex_indices);
     auto texture_coordinate_buffer_object = gl::texture_coordinate_buffer_object_t::create_buffer_object(
-            vertex_uvs, program, "vertex_uv");
+            vertex_uvs, vertex_bindings::vertex_uv);
 
-    auto projection_uniform = gl::get_uniform_location(program, "projection_matrix");
-    auto lines_frame_buffer_uniform = gl::get_uniform_location(program, "lines_frame_buffer");
+    auto lines_uv_scale_uniform = gl::get_uniform_location(program, fragment_bindings::lines_uv_scale);
+    auto bloom_uv_scale_uniform = gl::get_uniform_location(program, fragment_bindings::bloom_uv_scale);
+    auto density_uv_scale_uniform = gl::get_uniform_location(program, fragment_bindings::density_uv_scale);
 
     return {
         std::move(program),
@@ -390,11 +1621,84 @@ combiner_shader_stuff_t create_combiner_shader() {
         std::move(vertex_buffer_object),
         std::move(index_buffer_object),
         std::move(texture_coordinate_buffer_object),
-        projection_uniform,
-        lines_frame_buffer_uniform};
+        lines_uv_scale_uniform,
+        bloom_uv_scale_uniform,
+        density_uv_scale_uniform};
+}
+
+// The bloom passes and the post anti-aliasing have the same interface.
+using fullscreen_pass_bindings = shader_bindings::bloom_downsample_fragment_shader_fsh;
+static_assert(fullscreen_pass_bindings::source_frame_buffer.m_unit ==
+              shader_bindings::bloom_upsample_fragment_shader_fsh::source_frame_buffer.m_unit);
+
+fullscreen_pass_stuff_t create_fullscreen_pass(std::string_view fragment_shader_source) {
+    TRACE_ZONE("create_fullscreen_pass");
+    auto program = gl::create_program();
+
+    auto vertex_shader = gl::vertex_shader_t::create_shader(program, resources::fullscreen_vertex_shader_vsh);
+    auto fragment_shader = gl::fragment_shader_t::create_shader(program, fragment_shader_source);
+
+    gl::link_program(program);
+
+    using vertex_bindings = shader_bindings::fullscreen_vertex_shader_vsh;
+    static_assert(gl::interfaces_match<vertex_bindings, fullscreen_pass_bindings>());
+    static_assert(gl::interfaces_match<vertex_bindings, shader_bindings::bloom_upsample_fragment_shader_fsh>());
+
+    auto vertex_array_object = gl::generate_vertex_array_object();
+    auto vertex_buffer_object = gl::vertex_buffer_object_t::create_buffer_object(
+            fullscreen_vertex_positions, vertex_bindings::vertex_position);
+    auto index_buffer_object = gl::index_buffer_object_t::create_buffer_object(vertex_indices);
+    auto texture_coordinate_buffer_object = gl::texture_coordinate_buffer_object_t::create_buffer_object(
+            vertex_uvs, vertex_bindings::vertex_uv);
+
+    auto texel_size_uniform = gl::get_uniform_location(program, fullscreen_pass_bindings::texel_size);
+    auto source_uv_scale_uniform = gl::get_uniform_location(program, fullscreen_pass_bindings::source_uv_scale);
+
+    return {std::move(program),
+            std::move(vertex_shader),
+            std::move(fragment_shader),
+            std::move(vertex_array_object),
+            std::move(vertex_buffer_object),
+            std::move(index_buffer_object),
+            std::move(texture_coordinate_buffer_object),
+            texel_size_uniform,
+            source_uv_scale_uniform};
+}
+
+post_antialiasing_stuff_t create_post_antialiasing(gl::render_target_pool_t& render_target_pool) {
+    TRACE_ZONE("create_post_antialiasing");
+    static_assert(gl::interfaces_match<shader_bindings::fullscreen_vertex_shader_vsh,
+                                       shader_bindings::post_antialiasing_fragment_shader_fsh>());
+    static_assert(fullscreen_pass_bindings::source_frame_buffer.m_unit ==
+                  shader_bindings::post_antialiasing_fragment_shader_fsh::source_frame_buffer.m_unit);
+
+    auto pass = create_fullscreen_pass(resources::post_antialiasing_fragment_shader_fsh);
+
+    // Grown to the size of the lines once the pass is used.
+    auto frame_buffer_target = render_target_pool.acquire({1, 1}, GL_LINEAR);
+
+    return {std::move(pass), frame_buffer_target};
 }
 
-shader_stuff_t init_gl(const glm::ivec2& window_size) {
+glm::ivec2 bloom_mip_size(const glm::ivec2& window_size, int level) {
+    return glm::max(glm::ivec2{window_size.x >> (level + 1), window_size.y >> (level + 1)}, glm::ivec2{1, 1});
+}
+
+bloom_shader_stuff_t create_bloom_shader(gl::render_target_pool_t& render_target_pool, glm::ivec2 window_size) {
+    TRACE_ZONE("create_bloom_shader");
+    auto downsample_pass = create_fullscreen_pass(resources::bloom_downsample_fragment_shader_fsh);
+    auto upsample_pass = create_fullscreen_pass(resources::bloom_upsample_fragment_shader_fsh);
+
+    std::array<gl::render_target_handle_t, max_bloom_levels> mip_chain;
+    for (auto level = 0; level < max_bloom_levels; level++) {
+        mip_chain[level] = render_target_pool.acquire(bloom_mip_size(window_size, level), GL_LINEAR);
+    }
+    render_target_pool[mip_chain.back()].unbind();
+
+    return {std::move(downsample_pass), std::move(upsample_pass), mip_chain};
+}
+
+shader_stuff_t init_gl(gl::render_target_pool_t& render_target_pool, const glm::ivec2& window_size) {
 #ifndef NDEBUG
     gl::enable(GL_DEBUG_OUTPUT);
     gl::debug_message_callback(debug_message_callback, nullptr);
@@ -409,11 +1713,24 @@ shader_stuff_t init_gl(const glm::ivec2& window_size) {
     gl::clear_color(1.0f, 0.0f, 1.0f, 1.0f);
 
     auto star_shader_stuff = create_star_shader();
-    auto line_shader_stuff = create_line_shader(window_size);
+    auto line_shader_stuff = create_line_shader(render_target_pool, window_size);
+    auto density_shader_stuff = create_density_shader(render_target_pool);
+    auto tile_shader_stuff = create_tile_shader(render_target_pool);
+    auto post_antialiasing_stuff = create_post_antialiasing(render_target_pool);
+    auto bloom_shader_stuff = create_bloom_shader(render_target_pool, window_size);
     auto combiner_shader_stuff = create_combiner_shader();
-
-
-    return {std::move(star_shader_stuff), std::move(line_shader_stuff), std::move(combiner_shader_stuff)};
+    auto frame_constants = gl::uniform_buffer_object_t<frame_constants_t>::create(
+            shader_bindings::blocks::frame_constants);
+
+
+    return {std::move(star_shader_stuff),
+            std::move(line_shader_stuff),
+            std::move(density_shader_stuff),
+            std::move(tile_shader_stuff),
+            std::move(post_antialiasing_stuff),
+            std::move(bloom_shader_stuff),
+            std::move(combiner_shader_stuff),
+            std::move(frame_constants)};
 }
 
 void debug_message_callback(GLenum source,
@@ -518,37 +1835,12 @@ void debug_message_callback(GLenum source,
 }
 
 
-template<typename T, typename F>
-void set_uniform_if_changed(T& old_value,
-                            const T& new_value,
-                            gl::uniform_location_t uniform_location,
-                            F uniform_setter) {
-    if (old_value == new_value) {
-        return;
-    }
-
-    uniform_setter(uniform_location, new_value);
-    old_value = new_value;
-}
-
-void render_stars(const star_shader_stuff_t& stuff,
-                  const window_state_t& window_state,
-                  const glm::mat4& projection_matrix,
-                  glm::ivec2 window_size) {
-    static glm::mat4 old_projection_matrix = glm::identity<glm::mat4>();
+void render_stars(const star_shader_stuff_t& stuff, glm::ivec2 window_size) {
+    TRACE_ZONE("render_stars");
     static glm::ivec2 old_window_size = {0.0f, 0.0f};
-    static glm::vec3 old_background_color = {0.0f, 0.0f, 0.0f};
-    static float old_star_density = 0.0f;
 
     gl::use_program(stuff.program);
 
-
-    set_uniform_if_changed(old_projection_matrix, projection_matrix, stuff.projection_uniform, gl::uniform_matrix);
-    set_uniform_if_changed(old_background_color, window_state.m_stars_background_color, stuff.background_color_uniform,
-                           gl::uniform_vec3);
-    set_uniform_if_changed(old_star_density, window_state.m_stars_density, stuff.star_density_uniform,
-                           gl::uniform_float);
-
     if (old_window_size != window_size) {
         const std::array<glm::vec2, 4> vertex_positions = {glm::vec2{0.0f, 0.0f},
                                                            {window_size.x, 0.0f},
@@ -568,81 +1860,486 @@ void render_stars(const star_shader_stuff_t& stuff,
     gl::unbind_program();
 }
 
-void render_lines(const line_shader_stuff_t& stuff,
-                  const glm::mat4& projection_matrix,
+// Scissors a damaged window rectangle on a target that is scale times the size of the window.
+void scissor_damage_rect(const damage_rect_t& rect, const glm::vec2& scale, int target_height) {
+    const auto min = glm::ivec2(glm::floor(glm::vec2(rect.m_min) * scale));
+    const auto max = glm::ivec2(glm::ceil(glm::vec2(rect.m_max) * scale));
+    glScissor(min.x, target_height - max.y, max.x - min.x, max.y - min.y);
+}
+
+// Draws once per damaged rectangle, scissored to it, or once without a scissor when everything is damaged.
+template<typename F>
+void for_each_damage_rect(const damage_t& damage, const glm::ivec2& window_size, F&& draw) {
+    if (damage.full()) {
+        draw();
+        return;
+    }
+
+    gl::enable(GL_SCISSOR_TEST);
+    for (const auto& rect : damage.rects()) {
+        scissor_damage_rect(rect, glm::vec2{1.0f, 1.0f}, window_size.y);
+        draw();
+    }
+    gl::disable(GL_SCISSOR_TEST);
+}
+
+void set_line_blend(line_blend_t blend) {
+    switch (blend) {
+        case line_blend_t::max:
+            glBlendEquation(GL_MAX);
+            break;
+
+        case line_blend_t::additive:
+            glBlendEquation(GL_FUNC_ADD);
+            break;
+    }
+}
+
+// Uploads the instances of the line batch and compacts the visible ones into the buffers of the cull stuff, which the
+// line attributes are pointed at. The commands in the indirect buffer end up counting only the visible instances.
+void cull_lines(const line_cull_stuff_t& cull_stuff,
+                const line_shader_stuff_t& stuff,
+                const line_batch_t& line_batch,
+                std::pmr::memory_resource& frame_memory) {
+    TRACE_ZONE("cull_lines");
+    using cull_bindings = shader_bindings::line_cull_csh;
+
+    const auto instance_count = line_batch.model_matrixes().size();
+    stuff.model_matrix_buffer_object.stream_data(line_batch.model_matrixes());
+    stuff.model_matrix_buffer_object.bind_storage(cull_bindings::instance_matrixes.m_binding, instance_count);
+    stuff.model_color_buffer_object.stream_data(line_batch.model_colors());
+    stuff.model_color_buffer_object.bind_storage(cull_bindings::instance_colors.m_binding, instance_count);
+    stuff.vertex_width_buffer_object.stream_data(line_batch.vertex_widths());
+    stuff.vertex_width_buffer_object.bind_storage(cull_bindings::instance_widths.m_binding, instance_count);
+    stuff.lifetime_buffer_object.stream_data(line_batch.lifetimes());
+    stuff.lifetime_buffer_object.bind_storage(cull_bindings::instance_lifetimes.m_binding, instance_count);
+
+    // The attributes only read the compacted instances once the compute pass has written them.
+    cull_stuff.model_matrix_buffer_object.allocate(instance_count);
+    cull_stuff.model_matrix_buffer_object.upload();
+    cull_stuff.model_matrix_buffer_object.bind_storage(cull_bindings::visible_matrixes.m_binding);
+    cull_stuff.model_color_buffer_object.allocate(instance_count);
+    cull_stuff.model_color_buffer_object.upload();
+    cull_stuff.model_color_buffer_object.bind_storage(cull_bindings::visible_colors.m_binding);
+    cull_stuff.vertex_width_buffer_object.allocate(instance_count);
+    cull_stuff.vertex_width_buffer_object.upload();
+    cull_stuff.vertex_width_buffer_object.bind_storage(cull_bindings::visible_widths.m_binding);
+    cull_stuff.lifetime_buffer_object.allocate(instance_count);
+    cull_stuff.lifetime_buffer_object.upload();
+    cull_stuff.lifetime_buffer_object.bind_storage(cull_bindings::visible_lifetimes.m_binding);
+
+    // Every visible instance adds itself to the instance count of its command.
+    std::pmr::vector<gl::draw_arrays_indirect_command_t> commands(line_batch.commands().begin(),
+                                                                  line_batch.commands().end(), &frame_memory);
+    for (auto& command : commands) {
+        command.m_instance_count = 0;
+    }
+    stuff.indirect_buffer_object.set_data(commands);
+    stuff.indirect_buffer_object.bind_storage(cull_bindings::commands.m_binding);
+
+    gl::use_program(cull_stuff.program);
+    // The invocations loop over the instances past the last work group.
+    const auto group_count = (instance_count + cull_bindings::local_size_x - 1) / cull_bindings::local_size_x;
+    gl::dispatch_compute(static_cast<GLuint>(std::min<std::size_t>(group_count, max_line_cull_work_groups)));
+    gl::memory_barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+// Uses the line program and points its attributes at the instances of the line batch. Culled instances are already
+// where the attributes point, in the buffers of the cull stuff.
+void bind_line_batch(const line_shader_stuff_t& stuff, const line_batch_t& line_batch, bool culled) {
+    gl::use_program(stuff.program);
+
+    stuff.vertex_buffer_object.bind();
+    stuff.vertex_buffer_object.upload();
+
+    stuff.texture_coordinate_buffer_object.bind();
+    stuff.texture_coordinate_buffer_object.upload();
+
+    if (!culled) {
+        stuff.model_matrix_buffer_object.stream_data(line_batch.model_matrixes());
+        stuff.model_matrix_buffer_object.upload();
+
+        stuff.model_color_buffer_object.stream_data(line_batch.model_colors());
+        stuff.model_color_buffer_object.upload();
+
+        stuff.vertex_width_buffer_object.stream_data(line_batch.vertex_widths());
+        stuff.vertex_width_buffer_object.upload();
+
+        stuff.lifetime_buffer_object.stream_data(line_batch.lifetimes());
+        stuff.lifetime_buffer_object.upload();
+
+        if (gl::supports_multi_draw_indirect()) {
+            stuff.indirect_buffer_object.set_data(line_batch.commands());
+        }
+    }
+
+    stuff.index_buffer_object.bind();
+}
+
+// One submission per blend mode, however many layers it has.
+void draw_line_batch(const line_batch_t& line_batch) {
+    const auto multi_draw_indirect = gl::supports_multi_draw_indirect();
+    const auto& commands = line_batch.commands();
+    for (const auto& range : line_batch.pipeline_ranges()) {
+        set_line_blend(range.m_blend);
+
+        if (multi_draw_indirect) {
+            gl::multi_draw_arrays_indirect(GL_TRIANGLE_FAN, range.m_first_command,
+                                           static_cast<GLsizei>(range.m_command_count));
+        } else {
+            // 4.2 has base instances but no multi-draw indirect, so the same commands are submitted one by one.
+            for (auto i = range.m_first_command; i < range.m_first_command + range.m_command_count; i++) {
+                gl::draw_arrays_instanced_base_instance(GL_TRIANGLE_FAN, commands[i].m_first, commands[i].m_count,
+                                                        commands[i].m_instance_count, commands[i].m_base_instance);
+            }
+        }
+    }
+}
+
+void render_lines(line_shader_stuff_t& stuff,
+                  const gl::frame_buffer_object_t& frame_buffer_object,
                   const glm::ivec2& window_size,
-                  const std::vector<line>& lines) {
-    static glm::mat4 old_projection_matrix = glm::identity<glm::mat4>();
-    static glm::ivec2 old_window_size = {0.0f, 0.0f};
+                  const line_scene_t& lines,
+                  line_batch_t& line_batch,
+                  std::pmr::memory_resource& frame_memory,
+                  job_system_t& jobs,
+                  const damage_t& damage,
+                  bool gpu_culling) {
+    TRACE_ZONE("render_lines");
+    line_batch.build(lines, vertex_indices.size(), frame_memory, jobs);
+
+    // Culling needs the commands in the indirect buffer, which is 4.3 as well.
+    auto* const cull_stuff = gpu_culling && stuff.cull_stuff && !line_batch.commands().empty()
+                                 ? &*stuff.cull_stuff
+                                 : nullptr;
+
+
+    // The projection stays in window coordinates, the smaller viewport scales the lines down with it.
+    frame_buffer_object.bind();
+
+    // The frame buffer keeps its contents between frames. Every line is submitted once, but only the pixels within
+    // the bounds of the damage are cleared, drawn and resolved.
+    if (!damage.full()) {
+        gl::enable(GL_SCISSOR_TEST);
+        scissor_damage_rect(damage.bounds(), glm::vec2(frame_buffer_object.viewport_size()) / glm::vec2(window_size),
+                            frame_buffer_object.viewport_size().y);
+    }
+
+    gl::clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+    gl::clear(GL_COLOR_BUFFER_BIT);
 
-    std::vector<glm::mat4> model_matrixes;
-    for (auto& line : lines) {
-        model_matrixes.push_back(line.transform_matrix());
+    if (cull_stuff) {
+        cull_lines(*cull_stuff, stuff, line_batch, frame_memory);
     }
 
-    std::vector<glm::vec3> model_colors;
-    for (auto& line : lines) {
-        model_colors.push_back(line.color());
+    bind_line_batch(stuff, line_batch, cull_stuff != nullptr);
+
+    if (cull_stuff) {
+        cull_stuff->primitive_counter.begin();
     }
 
-    std::vector<glm::vec3> vertex_widths;
-    for (auto& line : lines) {
-        vertex_widths.emplace_back(line.start_width(), line.end_width(), std::max(line.start_width(), line.end_width()));
+    draw_line_batch(line_batch);
+
+    if (cull_stuff) {
+        cull_stuff->primitive_counter.end();
     }
 
+    gl::unbind_program();
 
-    if (old_window_size != window_size) {
-        stuff.frame_buffer_object.set_size(window_size);
-        old_window_size = window_size;
+    frame_buffer_object.resolve();
+    frame_buffer_object.unbind();
+    glViewport(0, 0, window_size.x, window_size.y);
+
+    if (!damage.full()) {
+        gl::disable(GL_SCISSOR_TEST);
+    }
+}
+
+void render_density(const density_shader_stuff_t& stuff,
+                    const gl::frame_buffer_object_t& frame_buffer_object,
+                    const glm::ivec2& window_size,
+                    const line_scene_t& lines,
+                    line_batch_t& line_batch,
+                    std::pmr::memory_resource& frame_memory,
+                    job_system_t& jobs,
+                    const damage_t& damage) {
+    TRACE_ZONE("render_density");
+    line_batch.build(lines, vertex_indices.size(), frame_memory, jobs);
+
+    // Kept between frames like the lines frame buffer, only the damage is splatted again.
+    frame_buffer_object.bind();
+    if (!damage.full()) {
+        gl::enable(GL_SCISSOR_TEST);
+        scissor_damage_rect(damage.bounds(), glm::vec2(frame_buffer_object.viewport_size()) / glm::vec2(window_size),
+                            frame_buffer_object.viewport_size().y);
     }
-    stuff.frame_buffer_object.bind();
 
     gl::clear_color(0.0f, 0.0f, 0.0f, 0.0f);
     gl::clear(GL_COLOR_BUFFER_BIT);
 
+    // Every line adds to the pixels it covers, in any order. Blend modes and layers make no difference.
+    glBlendEquation(GL_FUNC_ADD);
     gl::use_program(stuff.program);
 
     stuff.vertex_buffer_object.bind();
     stuff.vertex_buffer_object.upload();
 
-    stuff.texture_coordinate_buffer_object.bind();
-    stuff.texture_coordinate_buffer_object.upload();
-
-    stuff.model_matrix_buffer_object.set_data(model_matrixes);
+    stuff.model_matrix_buffer_object.stream_data(line_batch.model_matrixes());
     stuff.model_matrix_buffer_object.upload();
 
-    stuff.model_color_buffer_object.set_data(model_colors);
+    stuff.model_color_buffer_object.stream_data(line_batch.model_colors());
     stuff.model_color_buffer_object.upload();
 
-    stuff.vertex_width_buffer_object.set_data(vertex_widths);
-    stuff.vertex_width_buffer_object.upload();
+    stuff.lifetime_buffer_object.stream_data(line_batch.lifetimes());
+    stuff.lifetime_buffer_object.upload();
+
+    gl::draw_arrays_instanced_base_instance(GL_LINES, 0, static_cast<GLsizei>(density_vertex_positions.size()),
+                                            static_cast<GLsizei>(line_batch.model_matrixes().size()), 0);
+
+    gl::unbind_program();
+
+    frame_buffer_object.unbind();
+    glViewport(0, 0, window_size.x, window_size.y);
+
+    if (!damage.full()) {
+        gl::disable(GL_SCISSOR_TEST);
+    }
+}
+
+// Draws the lines into the atlas slots of the tiles. Each tile takes the place of the camera, its projection fits the
+// tile to its slot. The line batch is uploaded once for all of them.
+// The atlas is single sampled, so the tiles are anti-aliased analytically whatever the mode of the untiled lines.
+void bake_tiles(const line_shader_stuff_t& stuff,
+                gl::uniform_buffer_object_t<frame_constants_t>& frame_constants_buffer,
+                frame_constants_t frame_constants,
+                const gl::frame_buffer_object_t& atlas,
+                const tile_cache_t& tile_cache,
+                std::span<const tile_bake_t> bakes,
+                const line_scene_t& lines,
+                line_batch_t& line_batch,
+                std::pmr::memory_resource& frame_memory,
+                job_system_t& jobs) {
+    TRACE_ZONE("bake_tiles");
+    line_batch.build(lines, vertex_indices.size(), frame_memory, jobs);
+
+    atlas.bind();
+    gl::enable(GL_SCISSOR_TEST);
+    gl::clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+
+    bind_line_batch(stuff, line_batch, false);
+
+    frame_constants.m_view_matrix = glm::mat4(1.0f);
+    frame_constants.m_viewport_size = glm::vec2(tile_resolution);
+    frame_constants.m_analytic_antialiasing = 1.0f;
+    for (const auto& bake : bakes) {
+        const auto origin = tile_cache.slot_origin(bake.m_slot);
+        glViewport(origin.x, origin.y, tile_resolution, tile_resolution);
+        glScissor(origin.x, origin.y, tile_resolution, tile_resolution);
+        gl::clear(GL_COLOR_BUFFER_BIT);
+
+        // y points down in the world, like in the window.
+        const auto min = bake.m_key.world_min();
+        const auto max = bake.m_key.world_max();
+        frame_constants.m_projection_matrix = glm::ortho(min.x, max.x, max.y, min.y, -1.0f, 1.0f);
+        frame_constants_buffer.update(frame_constants);
+
+        draw_line_batch(line_batch);
+    }
+
+    gl::unbind_program();
+    gl::disable(GL_SCISSOR_TEST);
+    atlas.unbind();
+}
+
+// Draws the tiles of the plan over the whole lines frame buffer. Only a quad per tile, whatever the number of lines.
+void render_tiles(const tile_shader_stuff_t& stuff,
+                  const gl::frame_buffer_object_t& atlas,
+                  const gl::frame_buffer_object_t& frame_buffer_object,
+                  const glm::ivec2& window_size,
+                  std::span<const tile_draw_t> draws,
+                  std::pmr::memory_resource& frame_memory) {
+    TRACE_ZONE("render_tiles");
+    frame_buffer_object.bind();
+    gl::clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+    gl::clear(GL_COLOR_BUFFER_BIT);
+
+    // The tiles do not overlap, added to the cleared frame buffer they are copied.
+    glBlendEquation(GL_FUNC_ADD);
+    gl::use_program(stuff.program);
+
+    using fragment_bindings = shader_bindings::tile_fragment_shader_fsh;
+    glActiveTexture(fragment_bindings::tile_atlas.texture_unit());
+    atlas.bind_texture();
+    glActiveTexture(GL_TEXTURE0);
+
+    std::pmr::vector<glm::vec4> tile_rects(&frame_memory);
+    std::pmr::vector<glm::vec4> atlas_rects(&frame_memory);
+    tile_rects.reserve(draws.size());
+    atlas_rects.reserve(draws.size());
+    for (const auto& draw : draws) {
+        tile_rects.push_back(draw.m_world_rect);
+        atlas_rects.push_back(draw.m_atlas_rect);
+    }
+
+    stuff.vertex_buffer_object.bind();
+    stuff.vertex_buffer_object.upload();
+
+    stuff.tile_rect_buffer_object.set_data(tile_rects);
+    stuff.tile_rect_buffer_object.upload();
+
+    stuff.atlas_rect_buffer_object.set_data(atlas_rects);
+    stuff.atlas_rect_buffer_object.upload();
+
+    gl::draw_arrays_instanced_base_instance(GL_TRIANGLE_FAN, 0, static_cast<GLsizei>(vertex_uvs.size()),
+                                            static_cast<GLsizei>(draws.size()), 0);
+
+    gl::unbind_program();
+
+    frame_buffer_object.resolve();
+    frame_buffer_object.unbind();
+    glViewport(0, 0, window_size.x, window_size.y);
+}
+
+// The lines through the tile cache. Missing tiles are baked before the tiles are drawn, up to the budget.
+void render_tiled_lines(shader_stuff_t& stuff,
+                        gl::render_target_pool_t& render_target_pool,
+                        tile_cache_t& tile_cache,
+                        const camera_t& camera,
+                        const frame_constants_t& frame_constants,
+                        const gl::frame_buffer_object_t& frame_buffer_object,
+                        const glm::ivec2& window_size,
+                        const line_scene_t& lines,
+                        line_batch_t& line_batch,
+                        std::pmr::memory_resource& frame_memory,
+                        job_system_t& jobs,
+                        int bake_budget) {
+    TRACE_ZONE("render_tiled_lines");
+    const auto plan = tile_cache.plan(camera.screen_to_world({0.0f, 0.0f}),
+                                      camera.screen_to_world(glm::vec2(window_size)), tile_level(camera.zoom()),
+                                      static_cast<std::size_t>(std::max(bake_budget, 0)), frame_memory);
+
+    auto& tile_stuff = stuff.tile_shader_stuff;
+    render_target_pool.resize(tile_stuff.atlas_target, {tile_atlas_size, tile_atlas_size});
+    const auto& atlas = render_target_pool[tile_stuff.atlas_target];
+
+    if (!plan.m_bakes.empty()) {
+        bake_tiles(stuff.line_shader_stuff, stuff.frame_constants, frame_constants, atlas, tile_cache, plan.m_bakes,
+                   lines, line_batch, frame_memory, jobs);
+        // Back to the camera.
+        stuff.frame_constants.update(frame_constants);
+    }
+
+    render_tiles(tile_stuff, atlas, frame_buffer_object, window_size, plan.m_draws, frame_memory);
+}
+
+void render_bloom_pass(const fullscreen_pass_stuff_t& stuff,
+                       const gl::frame_buffer_object_t& source,
+                       const gl::frame_buffer_object_t& destination) {
+    TRACE_ZONE("render_bloom_pass");
+    destination.bind();
+    glViewport(0, 0, destination.size().x, destination.size().y);
 
-    set_uniform_if_changed(old_projection_matrix, projection_matrix, stuff.projection_uniform, gl::uniform_matrix);
+    gl::use_program(stuff.program);
+
+    // The sampler units are set in the shaders.
+    glActiveTexture(fullscreen_pass_bindings::source_frame_buffer.texture_unit());
+    source.bind_texture();
+    gl::set_uniform(stuff.texel_size_uniform, 1.0f / glm::vec2(source.size()));
+    gl::set_uniform(stuff.source_uv_scale_uniform, source.uv_scale());
+
+    stuff.vertex_buffer_object.bind();
+    stuff.vertex_buffer_object.upload();
+
+    stuff.texture_coordinate_buffer_object.bind();
+    stuff.texture_coordinate_buffer_object.upload();
 
     stuff.index_buffer_object.bind();
-    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, vertex_indices.size(), lines.size());
+    gl::draw_arrays(GL_TRIANGLE_FAN, 0, 4);
+}
+
+// Runs the pass over the lines into its own frame buffer of the same size, texel for texel.
+void render_post_antialiasing(const post_antialiasing_stuff_t& stuff,
+                              const gl::frame_buffer_object_t& lines_frame_buffer_object,
+                              const gl::frame_buffer_object_t& frame_buffer_object,
+                              const glm::ivec2& window_size) {
+    TRACE_ZONE("render_post_antialiasing");
+    // The pass overwrites every texel, blending would only cost bandwidth.
+    gl::disable(GL_BLEND);
+    frame_buffer_object.bind();
+
+    gl::use_program(stuff.pass.program);
+
+    glActiveTexture(fullscreen_pass_bindings::source_frame_buffer.texture_unit());
+    lines_frame_buffer_object.bind_texture();
+    gl::set_uniform(stuff.pass.texel_size_uniform, 1.0f / glm::vec2(lines_frame_buffer_object.size()));
+    gl::set_uniform(stuff.pass.source_uv_scale_uniform, lines_frame_buffer_object.uv_scale());
+
+    stuff.pass.vertex_buffer_object.bind();
+    stuff.pass.vertex_buffer_object.upload();
+
+    stuff.pass.texture_coordinate_buffer_object.bind();
+    stuff.pass.texture_coordinate_buffer_object.upload();
+
+    stuff.pass.index_buffer_object.bind();
+    gl::draw_arrays(GL_TRIANGLE_FAN, 0, 4);
 
     gl::unbind_program();
+    frame_buffer_object.unbind();
+    glViewport(0, 0, window_size.x, window_size.y);
+    gl::enable(GL_BLEND);
+}
+
+void render_bloom(const bloom_shader_stuff_t& stuff,
+                  gl::render_target_pool_t& render_target_pool,
+                  const gl::frame_buffer_object_t& lines_frame_buffer_object,
+                  const window_state_t& window_state,
+                  const glm::ivec2& window_size) {
+    TRACE_ZONE("render_bloom");
+    // The chain follows the lines frame buffer so it shrinks with the render scale.
+    const auto lines_size = lines_frame_buffer_object.viewport_size();
+    for (auto level = 0; level < max_bloom_levels; level++) {
+        render_target_pool.resize(stuff.mip_chain[level], bloom_mip_size(lines_size, level));
+    }
+
+    const auto mip = [&](int level) -> const gl::frame_buffer_object_t& {
+        return render_target_pool[stuff.mip_chain[level]];
+    };
+
+    const auto levels = std::clamp(window_state.m_bloom_levels, 1, max_bloom_levels);
+
+    // Every pass overwrites its whole destination, blending would only cost bandwidth.
+    gl::disable(GL_BLEND);
 
-    stuff.frame_buffer_object.unbind();
+    // Progressively halve the lines frame buffer down the chain...
+    render_bloom_pass(stuff.downsample_pass, lines_frame_buffer_object, mip(0));
+    for (auto level = 1; level < levels; level++) {
+        render_bloom_pass(stuff.downsample_pass, mip(level - 1), mip(level));
+    }
+
+    // ...and back up again. The result ends up in the first level.
+    for (auto level = levels - 1; level > 0; level--) {
+        render_bloom_pass(stuff.upsample_pass, mip(level), mip(level - 1));
+    }
+
+    gl::unbind_program();
+    mip(0).unbind();
 
+    glViewport(0, 0, window_size.x, window_size.y);
+    gl::enable(GL_BLEND);
 }
 
 void render_combiner(const combiner_shader_stuff_t& stuff,
     const gl::frame_buffer_object_t& lines_frame_buffer_object,
-    const glm::mat4& projection_matrix,
+    const gl::frame_buffer_object_t& bloom_frame_buffer_object,
+    const gl::frame_buffer_object_t* density_frame_buffer_object,
     const glm::ivec2& window_size) {
-    static glm::mat4 old_projection_matrix = glm::identity<glm::mat4>();
+    TRACE_ZONE("render_combiner");
     static glm::ivec2 old_window_size = {0.0f, 0.0f};
 
 
     gl::use_program(stuff.program);
 
-    set_uniform_if_changed(old_projection_matrix, projection_matrix, stuff.projection_uniform, gl::uniform_matrix);
     if (old_window_size != window_size) {
-        lines_frame_buffer_object.set_size(window_size);
-        //gl::uniform_frame_buffer(stuff.lines_frame_buffer_uniform, lines_frame_buffer_object);
-
         const std::array<glm::vec2, 4> vertex_positions = {glm::vec2{0.0f, 0.0f},
                                                            {window_size.x, 0.0f},
                                                            {window_size.x, window_size.y},
@@ -657,9 +2354,22 @@ void render_combiner(const combiner_shader_stuff_t& stuff,
     }
 
     // HACK
-    glActiveTexture(GL_TEXTURE0);
+    using fragment_bindings = shader_bindings::combiner_fragment_shader_fsh;
+    glActiveTexture(fragment_bindings::lines_frame_buffer.texture_unit());
     lines_frame_buffer_object.bind_texture();
-    gl::uniform_frame_buffer(stuff.lines_frame_buffer_uniform, 0);
+    gl::set_uniform(stuff.lines_uv_scale_uniform, lines_frame_buffer_object.uv_scale());
+
+    glActiveTexture(fragment_bindings::bloom_frame_buffer.texture_unit());
+    bloom_frame_buffer_object.bind_texture();
+    gl::set_uniform(stuff.bloom_uv_scale_uniform, bloom_frame_buffer_object.uv_scale());
+
+    // Only sampled while the lines are aggregated.
+    if (density_frame_buffer_object) {
+        glActiveTexture(fragment_bindings::density_frame_buffer.texture_unit());
+        density_frame_buffer_object->bind_texture();
+        gl::set_uniform(stuff.density_uv_scale_uniform, density_frame_buffer_object->uv_scale());
+    }
+    glActiveTexture(GL_TEXTURE0);
 
     stuff.vertex_buffer_object.upload();
 
@@ -672,20 +2382,267 @@ void render_combiner(const combiner_shader_stuff_t& stuff,
     gl::unbind_program();
 }
 
-void render(const shader_stuff_t& stuff,
+void render(shader_stuff_t& stuff,
+            gl::render_target_pool_t& render_target_pool,
             const glm::mat4& projection_matrix,
+            const camera_t& camera,
+            const glm::vec2& canvas_offset,
             const window_state_t& window_state,
-            const std::vector<line>& lines,
-            const glm::ivec2& window_size) {
-    gl::clear_color(1.0f, 0.0f, 1.0f, 1.0f);
-    gl::clear(GL_COLOR_BUFFER_BIT);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            const quality_settings_t& quality_settings,
+            const line_scene_t& lines,
+            line_batch_t& line_batch,
+            bool aggregate_lines,
+            tile_cache_t* tile_cache,
+            gl::gpu_timer_t* lines_timer,
+            std::pmr::memory_resource& frame_memory,
+            job_system_t& jobs,
+            const damage_t& lines_damage,
+            const damage_t& back_buffer_damage,
+            const glm::ivec2& window_size,
+            const glm::ivec2& render_target_size,
+            float time,
+            std::uint32_t frame_index) {
+    TRACE_ZONE("render");
+    // Every program reads these from the same buffer.
+    frame_constants_t frame_constants;
+    frame_constants.m_projection_matrix = projection_matrix;
+    frame_constants.m_view_matrix = camera.view_matrix();
+    frame_constants.m_canvas_offset = canvas_offset;
+    frame_constants.m_viewport_size = window_size;
+    frame_constants.m_time = time;
+    frame_constants.m_frame_index = frame_index;
+    frame_constants.m_background_color = window_state.m_stars_background_color;
+    frame_constants.m_star_density = window_state.m_stars_density * quality_settings.m_star_density_scale;
+    // Aggregated lines have no bloom, the densities are not in the lines frame buffer it is made from.
+    const auto bloom_enabled = window_state.m_bloom_enabled && !aggregate_lines;
+    frame_constants.m_bloom_intensity = bloom_enabled ? window_state.m_bloom_intensity : 0.0f;
+    frame_constants.m_density_exposure = aggregate_lines ? window_state.m_density_exposure : 0.0f;
+    const auto antialiasing = window_state.m_line_antialiasing;
+    frame_constants.m_analytic_antialiasing = antialiasing == line_antialiasing_t::analytic ? 1.0f : 0.0f;
+    stuff.frame_constants.update(frame_constants);
+
+    // Only multisampled when that is what anti-aliases the lines.
+    const auto lines_size = glm::max(glm::ivec2(glm::vec2(render_target_size) * quality_settings.m_render_scale),
+                                     glm::ivec2{1, 1});
+    const auto lines_samples = antialiasing == line_antialiasing_t::multisample ? quality_settings.m_msaa_samples : 1;
+    render_target_pool.resize(stuff.line_shader_stuff.frame_buffer_target, lines_size, lines_samples);
+    const auto& lines_frame_buffer_object = render_target_pool[stuff.line_shader_stuff.frame_buffer_target];
+
+    // With the post pass, the bloom and the combiner read the lines from its frame buffer instead.
+    const gl::frame_buffer_object_t* post_antialiasing_frame_buffer_object = nullptr;
+    if (antialiasing == line_antialiasing_t::post_process && !aggregate_lines) {
+        render_target_pool.resize(stuff.post_antialiasing_stuff.frame_buffer_target, lines_size);
+        post_antialiasing_frame_buffer_object = &render_target_pool[stuff.post_antialiasing_stuff.frame_buffer_target];
+    }
+    const auto& antialiased_lines_frame_buffer_object = post_antialiasing_frame_buffer_object
+                                                            ? *post_antialiasing_frame_buffer_object
+                                                            : lines_frame_buffer_object;
+
+    // Only grown to the size of the lines once they are aggregated.
+    const gl::frame_buffer_object_t* density_frame_buffer_object = nullptr;
+    if (aggregate_lines) {
+        render_target_pool.resize(stuff.density_shader_stuff.frame_buffer_target, lines_size);
+        density_frame_buffer_object = &render_target_pool[stuff.density_shader_stuff.frame_buffer_target];
+    }
 
-    render_stars(stuff.star_shader_stuff, window_state, projection_matrix, window_size);
-    glBlendFunc(GL_ONE, GL_ONE);
-    glBlendEquation(GL_MAX);
-    render_lines(stuff.line_shader_stuff, projection_matrix, window_size, lines);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_COLOR);
-    glBlendEquation(GL_FUNC_ADD);
-    render_combiner(stuff.combiner_shader_stuff, stuff.line_shader_stuff.frame_buffer_object, projection_matrix, window_size);
+    // Nothing new to draw, the lines frame buffer and the bloom are still what they were.
+    if (!lines_damage.empty() && aggregate_lines) {
+        glBlendFunc(GL_ONE, GL_ONE);
+        render_density(stuff.density_shader_stuff, *density_frame_buffer_object, window_size, lines, line_batch,
+                       frame_memory, jobs, lines_damage);
+    } else if (!lines_damage.empty()) {
+        if (lines_timer) {
+            lines_timer->begin(static_cast<int>(window_state.m_line_antialiasing));
+        }
+        glBlendFunc(GL_ONE, GL_ONE);
+        if (tile_cache) {
+            render_tiled_lines(stuff, render_target_pool, *tile_cache, camera, frame_constants,
+                               lines_frame_buffer_object, window_size, lines, line_batch, frame_memory, jobs,
+                               window_state.m_tile_bake_budget);
+        } else {
+            render_lines(stuff.line_shader_stuff, lines_frame_buffer_object, window_size, lines, line_batch,
+                         frame_memory, jobs, lines_damage, window_state.m_gpu_culling);
+        }
+        // Over all of the lines, a single pass is cheaper than tracking which of its texels the damage reaches.
+        if (post_antialiasing_frame_buffer_object) {
+            render_post_antialiasing(stuff.post_antialiasing_stuff, lines_frame_buffer_object,
+                                     *post_antialiasing_frame_buffer_object, window_size);
+        }
+        if (lines_timer) {
+            lines_timer->end();
+        }
+
+        // The mip chain is small enough to redraw completely.
+        if (bloom_enabled) {
+            render_bloom(stuff.bloom_shader_stuff, render_target_pool, antialiased_lines_frame_buffer_object,
+                         window_state, window_size);
+        }
+    }
+
+    // Only what changed since the frame in the back buffer.
+    for_each_damage_rect(back_buffer_damage, window_size, [&] {
+        gl::clear_color(1.0f, 0.0f, 1.0f, 1.0f);
+        gl::clear(GL_COLOR_BUFFER_BIT);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendEquation(GL_FUNC_ADD);
+
+        render_stars(stuff.star_shader_stuff, window_size);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_COLOR);
+        render_combiner(stuff.combiner_shader_stuff,
+                        antialiased_lines_frame_buffer_object,
+                        render_target_pool[stuff.bloom_shader_stuff.mip_chain[0]],
+                        density_frame_buffer_object,
+                        window_size);
+    });
+}
+
+bool should_aggregate_lines(const window_state_t& window_state,
+                            const camera_t& camera,
+                            std::size_t line_count,
+                            const line_batch_t& line_batch) {
+    switch (window_state.m_line_aggregation) {
+        case line_aggregation_t::never:
+            return false;
+
+        case line_aggregation_t::always:
+            return true;
+
+        case line_aggregation_t::automatic:
+            break;
+    }
+
+    // The average length is that of the last batch, a frame behind at worst. An empty batch has not been built yet.
+    // The lengths are in world units, the camera scales them to window pixels.
+    return line_count >= static_cast<std::size_t>(window_state.m_aggregation_line_count) ||
+           (!line_batch.model_matrixes().empty() &&
+            line_batch.average_length() * camera.zoom() < window_state.m_aggregation_average_length);
+}
+
+int run_benchmark(const options_t& options,
+                  const sdl::window_t& window,
+                  shader_stuff_t& stuff,
+                  gl::render_target_pool_t& render_target_pool,
+                  gl::gpu_timer_t& gpu_timer,
+                  frame_statistics_t& frame_statistics,
+                  job_system_t& jobs,
+                  const glm::mat4& projection_matrix,
+                  const glm::ivec2& window_size) {
+    const auto& scene_name = *options.m_benchmark_scene;
+    auto scene = [&] {
+        if (scene_name == "generated"sv) {
+            const auto& preset = generator_preset(*options.m_generate_preset);
+            return benchmark_scene_t{
+                    line_scene_t(generate_lines(preset, options.m_generate_count.value_or(preset.m_default_count),
+                                                options.m_generate_seed, jobs)),
+                    0.1f};
+        }
+        return create_benchmark_scene(scene_name, window_size);
+    }();
+    const auto frames = options.m_benchmark_frames;
+
+    window_state_t window_state;
+    window_state.m_stars_density = scene.m_star_density;
+    // Fixed quality, the governor would make the runs incomparable.
+    const quality_settings_t quality_settings;
+    // The scenes are made to fit the window, generated ones are fitted to it.
+    const auto camera = scene_name == "generated"sv ? camera_t::fitting(generator_canvas_size, glm::vec2(window_size))
+                                                    : camera_t{};
+    line_batch_t line_batch;
+    frame_arena_t frame_arena(frame_arena_size);
+    // Every frame is drawn completely, partial redraws would only measure the damage.
+    damage_t full_damage;
+    full_damage.add_full();
+
+    glew::count_calls();
+
+    const auto performance_frequency = static_cast<double>(sdl::get_performance_frequency());
+    const auto milliseconds_between = [&](Uint64 start, Uint64 end) {
+        return static_cast<double>(end - start) / performance_frequency * 1000.0;
+    };
+
+    auto gpu_frame_time = 0.0f;
+    auto previous_frame_start = sdl::get_performance_counter();
+    auto benchmark_start = previous_frame_start;
+    std::uint64_t start_allocations = 0;
+    std::uint64_t start_gl_calls = 0;
+
+    for (auto frame = -benchmark_warmup_frames; frame < frames; frame++) {
+        const auto frame_start = sdl::get_performance_counter();
+        if (frame == 0) {
+            benchmark_start = frame_start;
+            start_allocations = allocation_counter::allocations();
+            start_gl_calls = glew::call_count();
+        }
+
+        frame_arena.reset();
+
+        // Nobody looks at the window, but the event queue still has to be drained.
+        while (sdl::pool_event().pending_event) {
+        }
+
+        const auto time = static_cast<float>(frame + benchmark_warmup_frames) * benchmark_time_step;
+        advance_benchmark_scene(scene, time);
+
+        gpu_timer.begin();
+        render(stuff, render_target_pool, projection_matrix, camera, glm::vec2{0.0f}, window_state, quality_settings,
+               scene.m_lines, line_batch,
+               should_aggregate_lines(window_state, camera, scene.m_lines.size(), line_batch), nullptr, nullptr,
+               frame_arena, jobs, full_damage, full_damage, window_size, window_size, time,
+               static_cast<std::uint32_t>(frame + benchmark_warmup_frames));
+        gpu_timer.end();
+
+        if (const auto gpu_time = gpu_timer.try_read()) {
+            gpu_frame_time = *gpu_time;
+        }
+        const auto cpu_frame_time = milliseconds_between(frame_start, sdl::get_performance_counter());
+
+        sdl::gl_swap_window(window);
+
+        if (frame >= 0) {
+            frame_statistics.add_frame({static_cast<float>(cpu_frame_time), gpu_frame_time,
+                                        static_cast<float>(milliseconds_between(previous_frame_start, frame_start))},
+                                       0.0f);
+        }
+        previous_frame_start = frame_start;
+    }
+
+    const auto allocations = allocation_counter::allocations() - start_allocations;
+    const auto gl_calls = glew::call_count() - start_gl_calls;
+
+    // Wait for the queued frames, so they count towards the throughput.
+    glFinish();
+    const auto elapsed = milliseconds_between(benchmark_start, sdl::get_performance_counter()) / 1000.0;
+
+    frame_statistics.summarize();
+    const auto& summary = frame_statistics.summary();
+
+    std::vector<benchmark_metric_t> metrics = {
+        {"frames_per_second", static_cast<double>(frames) / elapsed},
+        {"frame_ms_p50", summary.m_frame_time.m_p50},
+        {"frame_ms_p95", summary.m_frame_time.m_p95},
+        {"cpu_ms_p50", summary.m_cpu_time.m_p50},
+        {"gpu_ms_p50", summary.m_gpu_time.m_p50},
+        {"allocations_per_frame", static_cast<double>(allocations) / frames},
+        {"gl_calls_per_frame", static_cast<double>(gl_calls) / frames},
+        // Exact, it only grows if lines that have faded out are not retired.
+        {"lines_at_end", static_cast<double>(scene.m_lines.size())},
+    };
+
+    // The instance build is timed on its own as well, in the frame it hides behind the GPU.
+    if (!scene.m_lines.empty()) {
+        const auto iterations = std::max<std::size_t>(1, 10'000'000 / scene.m_lines.size());
+        const auto kernel_start = sdl::get_performance_counter();
+        for (std::size_t i = 0; i < iterations; i++) {
+            frame_arena.reset();
+            line_batch.build(scene.m_lines, vertex_indices.size(), frame_arena, jobs);
+        }
+        const auto kernel_time = milliseconds_between(kernel_start, sdl::get_performance_counter()) / 1000.0;
+
+        metrics.push_back({"instance_build_mlines_per_second",
+                           static_cast<double>(scene.m_lines.size() * iterations) / kernel_time / 1'000'000.0});
+    }
+
+    const auto written = write_benchmark_metrics(options.m_metrics_path.value_or(""), scene_name, frames, metrics);
+
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
 }
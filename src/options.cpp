@@ -0,0 +1,166 @@
+#include "options.hpp"
+
+#include "globals.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+using namespace std::string_view_literals;
+
+[[noreturn]] void print_usage_and_exit(const char* program) noexcept {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Options:\n"
+              << "  --frame-stats <path>  Write frame statistics to path (.csv or .json) at exit\n"
+              << "  --generate <preset>   Fill the scene with generated lines, one of\n"
+              << "                        overlapping_long, tiny, tapers, uniform\n"
+              << "  --count <count>       Number of generated lines (default depends on the preset)\n"
+              << "  --seed <seed>         Seed of the generator (default 1), equal seeds give equal scenes\n"
+              << "  --benchmark <scene>   Render a synthetic scene offscreen and report metrics, one of\n"
+              << "                        lines_1k, lines_100k, lines_1m, lines_mixed, starfield or generated\n"
+              << "  --frames <count>      Number of measured benchmark frames (default 100)\n"
+              << "  --metrics <path>      Write the benchmark metrics as JSON to path instead of stdout\n"
+              << "  --capture <path>      Record frames: <name>.png sequence, .y4m or - (Y4M to stdout), else raw RGBA\n"
+              << "  --capture-fps <rate>  Frame rate of the recording (default 60)\n"
+              << "  --offline             Render at a fixed time step as fast as possible, without dropping frames\n"
+              << "  --ingest <name>       Create a shared memory ring other processes write lines to, e.g. /fireworks_lines\n"
+              << "  --wall <name>         Render one window of a video wall through shared memory, e.g. /fireworks_wall\n"
+              << "  --wall-grid <c>x<r>   Columns and rows of windows the video wall is split into (default 1x1)\n"
+              << "  --wall-tile <c>,<r>   Column and row of this window (default 0,0, which leads the wall)\n"
+              << "  --headless            Render in a hidden window without the debug interface\n"
+              << "  --quit-after <count>  Exit after count frames\n"
+              << "  --trace <path>        Write the CPU zones as Chrome trace JSON to path at exit and on F10\n"
+              << "  --help                Show this message\n";
+    std::exit(EXIT_FAILURE);
+}
+
+options_t parse_options(int argc, char** argv) noexcept {
+    options_t options;
+
+    const auto program = argc > 0 ? argv[0] : "fireworks_cpp";
+
+    for (auto i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+
+        const auto next_value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << argument << "\n";
+                print_usage_and_exit(program);
+            }
+
+            return argv[++i];
+        };
+
+        if (argument == "--frame-stats"sv) {
+            options.m_frame_statistics_path = next_value();
+        } else if (argument == "--generate"sv) {
+            options.m_generate_preset = next_value();
+        } else if (argument == "--count"sv) {
+            const auto value = next_value();
+            char* end = nullptr;
+            options.m_generate_count = std::strtoull(value, &end, 10);
+            if (end == value || *end != '\0') {
+                std::cerr << "Invalid line count " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--seed"sv) {
+            const auto value = next_value();
+            char* end = nullptr;
+            options.m_generate_seed = std::strtoull(value, &end, 0);
+            if (end == value || *end != '\0') {
+                std::cerr << "Invalid seed " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--benchmark"sv) {
+            options.m_benchmark_scene = next_value();
+        } else if (argument == "--frames"sv) {
+            const auto value = next_value();
+            options.m_benchmark_frames = std::atoi(value);
+            if (options.m_benchmark_frames <= 0) {
+                std::cerr << "Invalid frame count " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--metrics"sv) {
+            options.m_metrics_path = next_value();
+        } else if (argument == "--capture"sv) {
+            options.m_capture_path = next_value();
+        } else if (argument == "--capture-fps"sv) {
+            const auto value = next_value();
+            options.m_capture_frame_rate = std::atoi(value);
+            if (options.m_capture_frame_rate <= 0) {
+                std::cerr << "Invalid frame rate " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--offline"sv) {
+            options.m_offline = true;
+        } else if (argument == "--ingest"sv) {
+            options.m_ingest_name = next_value();
+#ifndef LINE_RING_SUPPORTED
+            std::cerr << "--ingest needs POSIX shared memory, which this platform does not have\n";
+            print_usage_and_exit(program);
+#endif
+        } else if (argument == "--wall"sv) {
+            options.m_wall_name = next_value();
+#ifndef VIDEO_WALL_SUPPORTED
+            std::cerr << "--wall needs POSIX shared memory, which this platform does not have\n";
+            print_usage_and_exit(program);
+#endif
+        } else if (argument == "--wall-grid"sv) {
+            const auto value = next_value();
+            auto length = 0;
+            if (std::sscanf(value, "%dx%d%n", &options.m_wall_columns, &options.m_wall_rows, &length) != 2 ||
+                value[length] != '\0' || options.m_wall_columns <= 0 || options.m_wall_rows <= 0 ||
+                options.m_wall_columns * options.m_wall_rows > max_video_wall_processes) {
+                std::cerr << "Invalid video wall grid " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--wall-tile"sv) {
+            const auto value = next_value();
+            auto length = 0;
+            if (std::sscanf(value, "%d,%d%n", &options.m_wall_column, &options.m_wall_row, &length) != 2 ||
+                value[length] != '\0') {
+                std::cerr << "Invalid video wall tile " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--headless"sv) {
+            options.m_headless = true;
+        } else if (argument == "--quit-after"sv) {
+            const auto value = next_value();
+            options.m_quit_after = std::atoi(value);
+            if (*options.m_quit_after <= 0) {
+                std::cerr << "Invalid frame count " << value << "\n";
+                print_usage_and_exit(program);
+            }
+        } else if (argument == "--trace"sv) {
+            options.m_trace_path = next_value();
+#ifndef TRACING_ENABLED
+            std::cerr << "--trace needs a build configured with -DTRACING=ON\n";
+            print_usage_and_exit(program);
+#endif
+        } else {
+            if (argument != "--help"sv) {
+                std::cerr << "Unknown option " << argument << "\n";
+            }
+            print_usage_and_exit(program);
+        }
+    }
+
+    if (options.m_benchmark_scene == "generated"sv && !options.m_generate_preset) {
+        std::cerr << "--benchmark generated needs --generate\n";
+        print_usage_and_exit(program);
+    }
+
+    if (options.m_wall_column < 0 || options.m_wall_column >= options.m_wall_columns || options.m_wall_row < 0 ||
+        options.m_wall_row >= options.m_wall_rows) {
+        std::cerr << "The video wall tile is outside the grid\n";
+        print_usage_and_exit(program);
+    }
+
+    if (options.m_wall_name && options.m_ingest_name && (options.m_wall_column != 0 || options.m_wall_row != 0)) {
+        std::cerr << "Only the leader of a video wall, tile 0,0, can ingest lines\n";
+        print_usage_and_exit(program);
+    }
+
+    return options;
+}
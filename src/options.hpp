@@ -0,0 +1,55 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+struct options_t {
+    // Where to write the frame statistics at exit. CSV or JSON depending on the extension.
+    std::optional<std::string> m_frame_statistics_path;
+
+    // Fills the scene with lines from a generator preset. "--benchmark generated" measures that scene.
+    std::optional<std::string> m_generate_preset;
+    // The preset decides when not set.
+    std::optional<std::size_t> m_generate_count;
+    std::uint64_t m_generate_seed = 1;
+
+    // Renders the named synthetic scene in a hidden window for a fixed number of frames and exits.
+    std::optional<std::string> m_benchmark_scene;
+    int m_benchmark_frames = 100;
+    // Where to write the benchmark metrics as JSON. Printed to stdout if not set.
+    std::optional<std::string> m_metrics_path;
+
+    // Records the rendered frames to a PNG sequence, a Y4M stream ("-" for stdout) or raw RGBA.
+    std::optional<std::string> m_capture_path;
+    int m_capture_frame_rate = 60;
+    // Advances exactly one frame period per frame and never drops captured frames,
+    // so an export runs as fast as the machine allows instead of in real time.
+    bool m_offline = false;
+
+    // Name of the shared memory ring that other processes can write lines to, such as /fireworks_lines.
+    std::optional<std::string> m_ingest_name;
+
+    // Name of the shared memory a video wall of several processes renders through, such as /fireworks_wall. The canvas
+    // is split into a grid of equally sized windows, each process renders one. The top left one leads the others.
+    std::optional<std::string> m_wall_name;
+    int m_wall_columns = 1;
+    int m_wall_rows = 1;
+    int m_wall_column = 0;
+    int m_wall_row = 0;
+
+    // Renders in a hidden window without the debug interface, for captures and video wall tiles.
+    bool m_headless = false;
+    // Exits after this many frames.
+    std::optional<int> m_quit_after;
+
+    // Where to write the CPU zones as Chrome trace event JSON, at exit and on F10.
+    std::optional<std::string> m_trace_path;
+};
+
+// Exits with a usage message on invalid arguments.
+[[nodiscard]] options_t parse_options(int argc, char** argv) noexcept;
+
+#endif //OPTIONS_HPP
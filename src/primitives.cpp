@@ -3,19 +3,19 @@
 //
 
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp> // IWYU pragma: keep
 
 #include "primitives.hpp"
 
 #include <algorithm>
-#include <numbers>
 #include <cmath>
 
-glm::mat4 make_model_matrix(const glm::vec2& position, const float rotations_radians, const glm::vec2& scale) noexcept {
+// Translation * rotation * scale, with the rotation given by where it turns the y axis. Built directly from the
+// direction, without trigonometry, so the result is the same to the bit on every machine.
+glm::mat4 make_model_matrix(const glm::vec2& position, const glm::vec2& direction, const glm::vec2& scale) noexcept {
     auto model_matrix = glm::identity<glm::mat4>();
-    model_matrix = glm::translate(model_matrix, glm::vec3(position.x, position.y, 0.0f));
-    model_matrix = glm::rotate(model_matrix, rotations_radians, glm::vec3(0.0f, 0.0f, 1.0f));
-    model_matrix = glm::scale(model_matrix, glm::vec3(scale.x, scale.y, 1.0f));
+    model_matrix[0] = glm::vec4(direction.y * scale.x, -direction.x * scale.x, 0.0f, 0.0f);
+    model_matrix[1] = glm::vec4(direction.x * scale.y, direction.y * scale.y, 0.0f, 0.0f);
+    model_matrix[3] = glm::vec4(position.x, position.y, 0.0f, 1.0f);
 
     return model_matrix;
 }
@@ -24,21 +24,27 @@ line::line(glm::vec2 start_position,
            glm::vec2 end_position,
            glm::vec3 color,
            float start_width,
-           float end_width) noexcept
+           float end_width,
+           line_blend_t blend,
+           int layer,
+           float spawn_time,
+           float lifetime) noexcept
     : m_color(color),
       m_start_width(start_width),
-      m_end_width(end_width) {
+      m_end_width(end_width),
+      m_blend(blend),
+      m_layer(layer),
+      m_spawn_time(spawn_time),
+      m_lifetime(lifetime) {
     auto width = std::max(start_width, end_width);
 
-    auto vector = end_position - start_position;
-    auto length = glm::length(vector);
-    auto center_length = length / 2.0f;
-    vector = glm::normalize(vector) * center_length;
+    const auto vector = end_position - start_position;
+    const auto length = std::sqrt(vector.x * vector.x + vector.y * vector.y);
+    // A line without length points along -x, as it did when the rotation came from atan2(0, 0).
+    const auto direction = length > 0.0f ? vector / length : glm::vec2(-1.0f, 0.0f);
 
-    auto position = start_position + vector;
-    auto rotation = std::atan2(start_position.y - end_position.y, start_position.x - end_position.x) +
-                    std::numbers::pi_v<float> / 2.0f;
-    auto scale = glm::vec2(width, length);
+    const auto position = start_position + vector * 0.5f;
+    const auto scale = glm::vec2(width, length);
 
-    m_transform_matrix = make_model_matrix(position, rotation, scale);
+    m_transform_matrix = make_model_matrix(position, direction, scale);
 }
@@ -7,23 +7,60 @@
 
 #include <glm/glm.hpp>
 
+#include "chunked_vector.hpp"
+#include "globals.hpp"
+
+// How a line is combined with the lines drawn before it. Every mode is its own pipeline state.
+enum class line_blend_t {
+    max,
+    additive,
+};
+
+constexpr int line_blend_count = 2;
+
 class line {
     glm::mat4 m_transform_matrix;
     glm::vec3 m_color;
     float m_start_width;
     float m_end_width;
+    line_blend_t m_blend;
+    // Within a blend mode, lines in higher layers are drawn after the ones in lower layers.
+    int m_layer;
+    // Simulation time the line appeared at, and how long it takes to fade out. Lines with no lifetime never fade.
+    float m_spawn_time;
+    float m_lifetime;
 
 public:
     line(glm::vec2 start_position,
          glm::vec2 end_position,
          glm::vec3 color,
          float start_width,
-         float end_width) noexcept;
+         float end_width,
+         line_blend_t blend = line_blend_t::max,
+         int layer = 0,
+         float spawn_time = 0.0f,
+         float lifetime = 0.0f) noexcept;
 
     [[nodiscard]] constexpr const glm::mat4& transform_matrix() const noexcept { return m_transform_matrix; }
     [[nodiscard]] constexpr const glm::vec3& color() const noexcept { return m_color; }
     [[nodiscard]] constexpr float start_width() const noexcept { return m_start_width; }
     [[nodiscard]] constexpr float end_width() const noexcept { return m_end_width; }
+    [[nodiscard]] constexpr line_blend_t blend() const noexcept { return m_blend; }
+    [[nodiscard]] constexpr int layer() const noexcept { return m_layer; }
+    [[nodiscard]] constexpr float spawn_time() const noexcept { return m_spawn_time; }
+    [[nodiscard]] constexpr float lifetime() const noexcept { return m_lifetime; }
+
+    // The transform scales the unit quad by the length along its y axis.
+    [[nodiscard]] float length() const noexcept { return glm::length(glm::vec2(m_transform_matrix[1])); }
+
+    // Whether the line has faded out completely at the given simulation time.
+    [[nodiscard]] constexpr bool expired(float time) const noexcept {
+        return m_lifetime > 0.0f && time - m_spawn_time >= m_lifetime;
+    }
 };
 
+// Where the lines of a scene are kept. Adding lines never moves the ones already there, expired lines are erased
+// from the front.
+using line_storage_t = chunked_vector_t<line, line_storage_chunk_size>;
+
 #endif //PRIMITIVES_HPP
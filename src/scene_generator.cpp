@@ -0,0 +1,117 @@
+#include "scene_generator.hpp"
+
+#include "globals.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std::string_view_literals;
+
+namespace {
+constexpr std::array<generator_settings_t, 4> presets = {{
+    // Long lines crossing the middle of the window, every pixel there is covered many times.
+    {"overlapping_long"sv, 5'000'000, 800.0f, 1600.0f, 8.0f, 20.0f, 8.0f, 20.0f,
+     {0.2f, 0.2f, 0.2f}, {1.0f, 1.0f, 1.0f}, 0.2f, line_blend_t::additive},
+    // Lines of a few pixels, the cost is all per instance.
+    {"tiny"sv, 2'000'000, 0.5f, 3.0f, 1.0f, 2.0f, 1.0f, 2.0f,
+     {0.5f, 0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}, 1.0f, line_blend_t::max},
+    // Wide starts tapering to almost nothing.
+    {"tapers"sv, 100'000, 50.0f, 400.0f, 40.0f, 60.0f, 0.5f, 1.0f,
+     {1.0f, 0.3f, 0.0f}, {1.0f, 0.8f, 0.2f}, 1.0f, line_blend_t::max},
+    {"uniform"sv, 100'000, 20.0f, 100.0f, 4.0f, 10.0f, 2.0f, 6.0f,
+     {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, 1.0f, line_blend_t::max},
+}};
+
+// Lines generated from one seed. Part of the output format: changing it changes every generated scene.
+constexpr std::size_t lines_per_chunk = 65'536;
+
+// splitmix64, both to derive the seed of each chunk and as the generator within a chunk.
+class random_t {
+    std::uint64_t m_state;
+
+public:
+    explicit random_t(std::uint64_t seed) noexcept : m_state(seed) {}
+
+    std::uint64_t next() noexcept {
+        auto z = m_state += 0x9E37'79B9'7F4A'7C15;
+        z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9;
+        z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EB;
+        return z ^ (z >> 31);
+    }
+
+    // In [0, 1), from the top 24 bits so every value is exact.
+    float uniform() noexcept {
+        return static_cast<float>(next() >> 40) * 0x1.0p-24f;
+    }
+
+    float uniform(float min, float max) noexcept {
+        return min + (max - min) * uniform();
+    }
+};
+}
+
+const generator_settings_t& generator_preset(std::string_view name) noexcept {
+    for (const auto& preset : presets) {
+        if (preset.m_name == name) {
+            return preset;
+        }
+    }
+
+    std::cerr << "Unknown generator preset " << name << ", expected one of:";
+    for (const auto& preset : presets) {
+        std::cerr << " " << preset.m_name;
+    }
+    std::cerr << "\n";
+    std::exit(EXIT_FAILURE);
+}
+
+line_storage_t generate_lines(const generator_settings_t& settings,
+                              std::size_t count,
+                              std::uint64_t seed,
+                              job_system_t& jobs) noexcept {
+    // Only +, -, *, / and sqrt, which are exact to the last bit under IEEE 754, here and in the line constructor.
+    // Both files are built without floating point contraction, so fused multiply-adds cannot round differently on
+    // some machines either.
+    line_storage_t lines;
+    lines.resize(count, line({}, {}, {}, 0.0f, 0.0f));
+
+    const auto chunk_count = (count + lines_per_chunk - 1) / lines_per_chunk;
+    jobs.parallel_for(0, chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto chunk = begin; chunk < end; chunk++) {
+            random_t random(random_t(seed ^ chunk * 0xD1B5'4A32'D192'ED03).next());
+
+            const auto first = chunk * lines_per_chunk;
+            const auto last = std::min(first + lines_per_chunk, count);
+            for (auto i = first; i < last; i++) {
+                const glm::vec2 midpoint{
+                    generator_canvas_size.x * (0.5f + settings.m_spread * (random.uniform() - 0.5f)),
+                    generator_canvas_size.y * (0.5f + settings.m_spread * (random.uniform() - 0.5f))};
+
+                // A uniform direction without trigonometry, a point in the unit disk scaled to unit length.
+                glm::vec2 direction;
+                float length_squared;
+                do {
+                    direction = {random.uniform(-1.0f, 1.0f), random.uniform(-1.0f, 1.0f)};
+                    length_squared = direction.x * direction.x + direction.y * direction.y;
+                } while (length_squared > 1.0f || length_squared < 1e-4f);
+                direction = direction / std::sqrt(length_squared);
+
+                const auto half_length = random.uniform(settings.m_min_length, settings.m_max_length) * 0.5f;
+                const auto start_width = random.uniform(settings.m_min_start_width, settings.m_max_start_width);
+                const auto end_width = random.uniform(settings.m_min_end_width, settings.m_max_end_width);
+                const glm::vec3 color{random.uniform(settings.m_min_color.x, settings.m_max_color.x),
+                                      random.uniform(settings.m_min_color.y, settings.m_max_color.y),
+                                      random.uniform(settings.m_min_color.z, settings.m_max_color.z)};
+                const auto layer = static_cast<int>(random.next() % max_line_layers);
+
+                lines[i] = line(midpoint - direction * half_length, midpoint + direction * half_length, color,
+                                start_width, end_width, settings.m_blend, layer);
+            }
+        }
+    });
+
+    return lines;
+}
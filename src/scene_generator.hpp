@@ -0,0 +1,47 @@
+#ifndef SCENE_GENERATOR_HPP
+#define SCENE_GENERATOR_HPP
+
+#include <glm/glm.hpp>
+
+#include "primitives.hpp"
+#include "job_system.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Distributions the generated lines are drawn from. Every range is sampled uniformly.
+struct generator_settings_t {
+    std::string_view m_name;
+    std::size_t m_default_count;
+
+    // Lengths in pixels.
+    float m_min_length;
+    float m_max_length;
+    float m_min_start_width;
+    float m_max_start_width;
+    float m_min_end_width;
+    float m_max_end_width;
+    // Per channel.
+    glm::vec3 m_min_color;
+    glm::vec3 m_max_color;
+    // Fraction of the canvas around its center that the midpoints of the lines are spread over.
+    float m_spread;
+    line_blend_t m_blend;
+};
+
+// Size in world units of the canvas every scene is generated on, whatever the window. Part of the output format.
+constexpr glm::vec2 generator_canvas_size{1920.0f, 1080.0f};
+
+// One of overlapping_long, tiny, tapers or uniform. Exits with a message on an unknown preset.
+[[nodiscard]] const generator_settings_t& generator_preset(std::string_view name) noexcept;
+
+// Fills a scene with count lines drawn from the settings over generator_canvas_size, in parallel.
+// The lines only depend on the settings, count and seed, bit for bit, whatever the number of workers or the machine,
+// so the same scene can be measured everywhere. Show it with camera_t::fitting() to fill the window.
+[[nodiscard]] line_storage_t generate_lines(const generator_settings_t& settings,
+                                            std::size_t count,
+                                            std::uint64_t seed,
+                                            job_system_t& jobs) noexcept;
+
+#endif //SCENE_GENERATOR_HPP
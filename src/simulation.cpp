@@ -0,0 +1,32 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void update_simulation(simulation_state_t& state, double step) noexcept {
+    state.m_tick++;
+    state.m_time = static_cast<double>(state.m_tick) * step;
+}
+
+simulation_state_t interpolate_simulation(const simulation_state_t& previous,
+                                          const simulation_state_t& current,
+                                          double alpha) noexcept {
+    return {current.m_tick, previous.m_time + (current.m_time - previous.m_time) * alpha};
+}
+
+int fixed_timestep_t::advance(double frame_time) noexcept {
+    m_accumulator += std::max(frame_time, 0.0);
+
+    auto steps = 0;
+    while (m_accumulator >= m_step && steps < m_max_steps) {
+        m_accumulator -= m_step;
+        steps++;
+    }
+
+    if (steps == m_max_steps && m_accumulator >= m_step) {
+        // We are too far behind. Drop the backlog instead of trying to catch up next frame.
+        m_accumulator = std::fmod(m_accumulator, m_step);
+    }
+
+    return steps;
+}
@@ -0,0 +1,41 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cstdint>
+
+struct simulation_state_t {
+    std::uint64_t m_tick = 0;
+    // Always derived from m_tick so that replays step through the exact same values.
+    double m_time = 0.0;
+};
+
+// Advances the simulation by exactly one fixed step.
+void update_simulation(simulation_state_t& state, double step) noexcept;
+
+// Blends two consecutive simulation states for rendering. alpha is in [0, 1).
+[[nodiscard]] simulation_state_t interpolate_simulation(const simulation_state_t& previous,
+                                                        const simulation_state_t& current,
+                                                        double alpha) noexcept;
+
+// Accumulator for running the simulation at a fixed rate independent of the display refresh rate.
+class fixed_timestep_t {
+    double m_step;
+    int m_max_steps;
+    double m_accumulator;
+
+public:
+    constexpr fixed_timestep_t(double rate, int max_steps) noexcept
+        : m_step(1.0 / rate), m_max_steps(max_steps), m_accumulator(0.0) {
+    }
+
+    // Adds the elapsed frame time and returns how many fixed steps should be run.
+    // Never returns more than max_steps, the remaining time is dropped to avoid a spiral of death.
+    [[nodiscard]] int advance(double frame_time) noexcept;
+
+    [[nodiscard]] constexpr double step() const noexcept { return m_step; }
+
+    // How far we are between the previous and the current simulation state.
+    [[nodiscard]] constexpr double alpha() const noexcept { return m_accumulator / m_step; }
+};
+
+#endif //SIMULATION_HPP
@@ -0,0 +1,78 @@
+#include "stroke.hpp"
+
+#include <cmath>
+#include <numbers>
+
+void stroke_simplifier_t::begin(const glm::vec2& point) noexcept {
+    m_vertex = point;
+    m_has_previous_point = false;
+    m_has_cone = false;
+    m_input_points++;
+    m_vertices++;
+}
+
+std::optional<glm::vec2> stroke_simplifier_t::add(const glm::vec2& point) noexcept {
+    m_input_points++;
+
+    const auto offset = point - m_vertex;
+    const auto distance = glm::length(offset);
+
+    // Points this close are within tolerance of any segment through the vertex. Once a direction has been
+    // picked they are not made the end point though, that would cut the segment short of the earlier points.
+    if (distance <= m_tolerance) {
+        if (!m_has_cone) {
+            m_previous_point = point;
+            m_has_previous_point = true;
+        }
+        return std::nullopt;
+    }
+
+    if (!m_has_cone) {
+        m_direction = offset / distance;
+        m_min_angle = -std::numbers::pi_v<float>;
+        m_max_angle = std::numbers::pi_v<float>;
+        m_has_cone = true;
+    }
+
+    // Angle of the point relative to the cone direction, and the directions that pass within tolerance of it.
+    const auto angle = std::atan2(m_direction.x * offset.y - m_direction.y * offset.x, glm::dot(m_direction, offset));
+    const auto half_width = std::asin(m_tolerance / distance);
+    const auto min_angle = std::max(m_min_angle, angle - half_width);
+    const auto max_angle = std::min(m_max_angle, angle + half_width);
+
+    // The segment to this point has to be inside the cone as well, or ending the segment here would stray
+    // from the points before it.
+    if (min_angle <= max_angle && angle >= min_angle && angle <= max_angle) {
+        m_min_angle = min_angle;
+        m_max_angle = max_angle;
+        m_previous_point = point;
+        m_has_previous_point = true;
+        return std::nullopt;
+    }
+
+    // No single segment fits anymore, so the stroke bends at the previous point. Start over from there.
+    const auto vertex = m_has_previous_point ? m_previous_point : point;
+    m_vertex = vertex;
+    m_vertices++;
+    m_has_cone = false;
+    m_has_previous_point = false;
+
+    if (vertex != point) {
+        // The new point already belongs to the next segment.
+        m_input_points--;
+        static_cast<void>(add(point));
+    }
+
+    return vertex;
+}
+
+std::optional<glm::vec2> stroke_simplifier_t::end() noexcept {
+    if (!m_has_previous_point || m_previous_point == m_vertex) {
+        m_has_previous_point = false;
+        return std::nullopt;
+    }
+
+    m_has_previous_point = false;
+    m_vertices++;
+    return m_previous_point;
+}
@@ -0,0 +1,48 @@
+#ifndef STROKE_HPP
+#define STROKE_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <optional>
+
+// Simplifies a freehand stroke while it is being drawn, one input point at a time.
+// Uses sleeve fitting: the points since the last vertex are kept within tolerance of a single segment by narrowing
+// a cone of allowed directions from that vertex. When a point falls outside the cone, the previous point becomes a
+// vertex. Every input point is O(1) and nothing is buffered, so the input rate does not matter.
+class stroke_simplifier_t {
+    float m_tolerance;
+
+    glm::vec2 m_vertex{0.0f};
+    glm::vec2 m_previous_point{0.0f};
+    bool m_has_previous_point = false;
+
+    // The cone, as angles relative to m_direction.
+    glm::vec2 m_direction{1.0f, 0.0f};
+    float m_min_angle = 0.0f;
+    float m_max_angle = 0.0f;
+    bool m_has_cone = false;
+
+    std::uint64_t m_input_points = 0;
+    std::uint64_t m_vertices = 0;
+
+public:
+    // tolerance is the largest distance in pixels a dropped point may have from the simplified polyline.
+    explicit stroke_simplifier_t(float tolerance) noexcept : m_tolerance(tolerance) {}
+
+    void set_tolerance(float tolerance) noexcept { m_tolerance = tolerance; }
+
+    // Starts a stroke, the point is its first vertex.
+    void begin(const glm::vec2& point) noexcept;
+
+    // Returns the next vertex of the simplified polyline, if the point completed one.
+    [[nodiscard]] std::optional<glm::vec2> add(const glm::vec2& point) noexcept;
+
+    // Returns the last vertex of the stroke, if the stroke went anywhere after the previous one.
+    [[nodiscard]] std::optional<glm::vec2> end() noexcept;
+
+    [[nodiscard]] constexpr std::uint64_t input_points() const noexcept { return m_input_points; }
+    [[nodiscard]] constexpr std::uint64_t vertices() const noexcept { return m_vertices; }
+};
+
+#endif //STROKE_HPP
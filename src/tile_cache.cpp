@@ -0,0 +1,160 @@
+#include "tile_cache.hpp"
+
+#include "globals.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static_assert(tile_atlas_size % tile_resolution == 0, "The atlas is divided into whole slots");
+
+namespace {
+constexpr int slots_per_row = tile_atlas_size / tile_resolution;
+}
+
+float tile_key_t::world_size() const noexcept {
+    return std::ldexp(static_cast<float>(tile_resolution), -m_level);
+}
+
+glm::vec2 tile_key_t::world_min() const noexcept {
+    return glm::vec2(m_position) * world_size();
+}
+
+glm::vec2 tile_key_t::world_max() const noexcept {
+    return glm::vec2(m_position + 1) * world_size();
+}
+
+int tile_level(float zoom) noexcept {
+    return static_cast<int>(std::round(std::log2(zoom)));
+}
+
+tile_cache_t::tile_cache_t() : m_slots(slots_per_row * slots_per_row) {
+}
+
+std::optional<int> tile_cache_t::find(const tile_key_t& key) noexcept {
+    for (std::size_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].m_used && m_slots[i].m_key == key) {
+            m_slots[i].m_last_used = m_frame;
+            return static_cast<int>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<int> tile_cache_t::allocate(const tile_key_t& key) noexcept {
+    // Free slots have never been used, so they are the least recently used ones.
+    const auto oldest = std::ranges::min_element(m_slots, {}, [](const slot_t& slot) {
+        return slot.m_used ? slot.m_last_used : 0;
+    });
+    if (oldest->m_used && oldest->m_last_used == m_frame) {
+        return std::nullopt;
+    }
+
+    *oldest = {key, m_frame, true, false};
+    return static_cast<int>(oldest - m_slots.begin());
+}
+
+tile_draw_t tile_cache_t::draw(const tile_key_t& key, const tile_key_t& source, int slot) const noexcept {
+    const auto origin = glm::vec2(slot_origin(slot));
+    const auto source_min = source.world_min();
+    const auto scale = static_cast<float>(tile_resolution) / source.world_size();
+
+    // The top of the tile is the last row of its slot. Linear filtering must not reach into the neighbouring slots.
+    const auto texel = [&](const glm::vec2& point) {
+        const auto offset = (point - source_min) * scale;
+        return glm::clamp(origin + glm::vec2(offset.x, static_cast<float>(tile_resolution) - offset.y),
+                          origin + 0.5f, origin + static_cast<float>(tile_resolution) - 0.5f);
+    };
+
+    const auto world_min = key.world_min();
+    const auto world_max = key.world_max();
+    return {{world_min, world_max}, {texel(world_min), texel(world_max)}};
+}
+
+tile_plan_t tile_cache_t::plan(const glm::vec2& world_min,
+                               const glm::vec2& world_max,
+                               int level,
+                               std::size_t bake_budget,
+                               std::pmr::memory_resource& memory) {
+    m_frame++;
+    m_lookups = 0;
+    m_hits = 0;
+    m_missing = 0;
+
+    tile_plan_t plan{std::pmr::vector<tile_draw_t>(&memory), std::pmr::vector<tile_bake_t>(&memory)};
+
+    const auto size = tile_key_t{level, {0, 0}}.world_size();
+    const auto first = glm::ivec2(glm::floor(world_min / size));
+    const auto last = glm::ivec2(glm::floor(world_max / size));
+    const auto tiles = glm::max(last - first + 1, glm::ivec2{0, 0});
+    plan.m_draws.reserve(static_cast<std::size_t>(tiles.x) * static_cast<std::size_t>(tiles.y));
+
+    for (auto y = first.y; y <= last.y; y++) {
+        for (auto x = first.x; x <= last.x; x++) {
+            const tile_key_t key{level, {x, y}};
+            const auto slot = find(key);
+            m_lookups++;
+
+            if (slot && !m_slots[*slot].m_stale) {
+                m_hits++;
+                plan.m_draws.push_back(draw(key, key, *slot));
+                continue;
+            }
+
+            // Stale tiles are baked again where they are.
+            if (plan.m_bakes.size() < bake_budget) {
+                if (const auto bake_slot = slot ? slot : allocate(key)) {
+                    m_slots[*bake_slot].m_stale = false;
+                    plan.m_bakes.push_back({key, *bake_slot});
+                    plan.m_draws.push_back(draw(key, key, *bake_slot));
+                    continue;
+                }
+            }
+
+            m_missing++;
+            if (slot) {
+                plan.m_draws.push_back(draw(key, key, *slot));
+                continue;
+            }
+
+            // Left empty when none of the coarser levels has it either.
+            auto fallback = key.parent();
+            for (auto i = 0; i < max_tile_fallback_levels; i++, fallback = fallback.parent()) {
+                if (const auto fallback_slot = find(fallback)) {
+                    plan.m_draws.push_back(draw(key, fallback, *fallback_slot));
+                    break;
+                }
+            }
+        }
+    }
+
+    return plan;
+}
+
+void tile_cache_t::invalidate(const glm::vec2& min, const glm::vec2& max) noexcept {
+    for (auto& slot : m_slots) {
+        const auto tile_min = slot.m_key.world_min();
+        const auto tile_max = slot.m_key.world_max();
+        if (slot.m_used && tile_min.x < max.x && tile_min.y < max.y && min.x < tile_max.x && min.y < tile_max.y) {
+            slot.m_stale = true;
+        }
+    }
+}
+
+void tile_cache_t::invalidate_all() noexcept {
+    for (auto& slot : m_slots) {
+        slot.m_stale = slot.m_used;
+    }
+}
+
+glm::ivec2 tile_cache_t::slot_origin(int slot) const noexcept {
+    return glm::ivec2{slot % slots_per_row, slot / slots_per_row} * tile_resolution;
+}
+
+float tile_cache_t::hit_rate() const noexcept {
+    return m_lookups > 0 ? static_cast<float>(m_hits) / static_cast<float>(m_lookups) : 1.0f;
+}
+
+float tile_cache_t::occupancy() const noexcept {
+    const auto used = std::ranges::count_if(m_slots, [](const slot_t& slot) { return slot.m_used; });
+    return static_cast<float>(used) / static_cast<float>(m_slots.size());
+}
@@ -0,0 +1,109 @@
+#ifndef TILE_CACHE_HPP
+#define TILE_CACHE_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// A square of the canvas baked at a power of two zoom level. A tile of level L is tile_resolution texels of 2^-L world
+// units each, so every level up halves the world size of the tiles and doubles their detail.
+struct tile_key_t {
+    int m_level;
+    glm::ivec2 m_position;
+
+    [[nodiscard]] float world_size() const noexcept;
+    [[nodiscard]] glm::vec2 world_min() const noexcept;
+    [[nodiscard]] glm::vec2 world_max() const noexcept;
+
+    // The tile of the next coarser level that covers this one.
+    [[nodiscard]] constexpr tile_key_t parent() const noexcept {
+        return {m_level - 1, {m_position.x >> 1, m_position.y >> 1}};
+    }
+
+    constexpr bool operator==(const tile_key_t&) const = default;
+};
+
+// The level whose texels are closest to a window pixel at the zoom of the camera.
+[[nodiscard]] int tile_level(float zoom) noexcept;
+
+// A tile drawn this frame, its rectangle in the world and the atlas texels it is read from, both with the minimum in
+// xy and the maximum in zw. The atlas rectangle is flipped, texture rows go up where the world goes down.
+struct tile_draw_t {
+    glm::vec4 m_world_rect;
+    glm::vec4 m_atlas_rect;
+};
+
+// A tile to bake into a slot of the atlas this frame.
+struct tile_bake_t {
+    tile_key_t m_key;
+    int m_slot;
+};
+
+struct tile_plan_t {
+    std::pmr::vector<tile_draw_t> m_draws;
+    std::pmr::vector<tile_bake_t> m_bakes;
+};
+
+// Keeps track of which tiles are baked into which slots of the atlas. Only bookkeeping, the baking itself is done by
+// whoever follows the plan. When the atlas is full, the tile that was used the longest ago is evicted.
+class tile_cache_t {
+    struct slot_t {
+        tile_key_t m_key{0, {0, 0}};
+        // Frame the tile was last drawn or looked for in.
+        std::uint64_t m_last_used = 0;
+        bool m_used = false;
+        // Lines were added over it since it was baked. Still shown until it is baked again.
+        bool m_stale = false;
+    };
+
+    std::vector<slot_t> m_slots;
+    std::uint64_t m_frame = 0;
+
+    // Of the last plan.
+    std::size_t m_lookups = 0;
+    std::size_t m_hits = 0;
+    std::size_t m_missing = 0;
+
+    [[nodiscard]] std::optional<int> find(const tile_key_t& key) noexcept;
+
+    // A free slot, or that of the least recently used tile that is not needed this frame.
+    [[nodiscard]] std::optional<int> allocate(const tile_key_t& key) noexcept;
+
+    [[nodiscard]] tile_draw_t draw(const tile_key_t& key, const tile_key_t& source, int slot) const noexcept;
+
+public:
+    tile_cache_t();
+
+    // The tiles of the level that cover the world rectangle. Missing and stale tiles are baked up to the budget, the
+    // rest show a coarser tile, or their stale contents, until a later frame gets to them.
+    [[nodiscard]] tile_plan_t plan(const glm::vec2& world_min,
+                                   const glm::vec2& world_max,
+                                   int level,
+                                   std::size_t bake_budget,
+                                   std::pmr::memory_resource& memory);
+
+    // Marks every baked tile that overlaps the world rectangle as stale, on every level.
+    void invalidate(const glm::vec2& min, const glm::vec2& max) noexcept;
+
+    void invalidate_all() noexcept;
+
+    // Lower left texel of the slot in the atlas.
+    [[nodiscard]] glm::ivec2 slot_origin(int slot) const noexcept;
+
+    // Fraction of the tiles of the last plan that were baked and up to date.
+    [[nodiscard]] float hit_rate() const noexcept;
+
+    // Fraction of the atlas slots that hold a tile.
+    [[nodiscard]] float occupancy() const noexcept;
+
+    [[nodiscard]] std::size_t slot_count() const noexcept { return m_slots.size(); }
+
+    // Whether the last plan showed every tile up to date, or more frames are needed to bake the rest.
+    [[nodiscard]] bool complete() const noexcept { return m_missing == 0; }
+};
+
+#endif //TILE_CACHE_HPP
@@ -0,0 +1,146 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+const auto epoch = std::chrono::steady_clock::now();
+
+// Atomic, so the exporter can read while the thread writes. Relaxed loads and stores are plain moves.
+struct zone_record_t {
+    std::atomic<const char*> m_name;
+    std::atomic<std::uint64_t> m_start;
+    std::atomic<std::uint64_t> m_end;
+};
+
+// Only written by its own thread, so recording takes no lock. m_written counts every zone ever recorded, the
+// exporter uses it to drop the ones that were overwritten while it read them.
+struct thread_ring_t {
+    std::array<zone_record_t, trace::zones_per_thread> m_zones{};
+    std::atomic<std::uint64_t> m_written = 0;
+    std::atomic<const char*> m_name = nullptr;
+    std::size_t m_thread_id = 0;
+};
+
+struct zone_copy_t {
+    const char* m_name;
+    std::uint64_t m_start;
+    std::uint64_t m_end;
+};
+
+// The rings are never freed, a thread that has exited still shows up in the trace.
+struct registry_t {
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<thread_ring_t>> m_rings;
+};
+
+registry_t& registry() noexcept {
+    static registry_t registry;
+    return registry;
+}
+
+thread_ring_t& thread_ring() noexcept {
+    thread_local thread_ring_t* ring = nullptr;
+    // Only the first zone of a thread takes the lock.
+    if (ring == nullptr) {
+        auto& threads = registry();
+        const std::scoped_lock lock(threads.m_mutex);
+        ring = threads.m_rings.emplace_back(std::make_unique<thread_ring_t>()).get();
+        ring->m_thread_id = threads.m_rings.size();
+    }
+    return *ring;
+}
+
+// The zones of the ring that were not overwritten while reading them, oldest first.
+void read_zones(const thread_ring_t& ring, std::vector<zone_copy_t>& zones) {
+    constexpr auto capacity = static_cast<std::uint64_t>(trace::zones_per_thread);
+
+    zones.clear();
+    const auto written = ring.m_written.load(std::memory_order_acquire);
+    const auto first = written > capacity ? written - capacity : 0;
+    for (auto i = first; i < written; i++) {
+        const auto& zone = ring.m_zones[i % capacity];
+        zones.push_back({zone.m_name.load(std::memory_order_relaxed), zone.m_start.load(std::memory_order_relaxed),
+                         zone.m_end.load(std::memory_order_relaxed)});
+    }
+
+    // The thread may be writing the zone after the last one it counted, in the slot of the oldest one still valid.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto written_after = ring.m_written.load(std::memory_order_relaxed);
+    const auto valid = written_after >= capacity ? written_after - capacity + 1 : 0;
+    if (valid > first) {
+        zones.erase(zones.begin(), zones.begin() + static_cast<std::ptrdiff_t>(std::min(valid, written) - first));
+    }
+}
+}
+
+std::uint64_t trace::now() noexcept {
+    return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void trace::record(const char* name, std::uint64_t start, std::uint64_t end) noexcept {
+    auto& ring = thread_ring();
+    const auto index = ring.m_written.load(std::memory_order_relaxed);
+    auto& zone = ring.m_zones[index % zones_per_thread];
+    // Orders the count of the previous zone before overwriting the slot, an exporter that reads the new values also
+    // sees that the old zone is gone.
+    std::atomic_thread_fence(std::memory_order_release);
+    zone.m_name.store(name, std::memory_order_relaxed);
+    zone.m_start.store(start, std::memory_order_relaxed);
+    zone.m_end.store(end, std::memory_order_relaxed);
+    ring.m_written.store(index + 1, std::memory_order_release);
+}
+
+void trace::set_thread_name(const char* name) noexcept {
+    thread_ring().m_name.store(name, std::memory_order_relaxed);
+}
+
+bool trace::export_json(std::string_view path) noexcept {
+    std::ofstream file{std::string(path)};
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    auto& threads = registry();
+    const std::scoped_lock lock(threads.m_mutex);
+
+    // Timestamps are in microseconds.
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    auto first_event = true;
+    const auto separator = [&]() -> std::ofstream& {
+        file << (first_event ? "  " : ",\n  ");
+        first_event = false;
+        return file;
+    };
+
+    std::vector<zone_copy_t> zones;
+    zones.reserve(zones_per_thread);
+    for (const auto& ring : threads.m_rings) {
+        if (const auto name = ring->m_name.load(std::memory_order_relaxed)) {
+            separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring->m_thread_id
+                        << ", \"args\": {\"name\": \"" << name << "\"}}";
+        }
+
+        read_zones(*ring, zones);
+        for (const auto& zone : zones) {
+            separator() << "{\"name\": \"" << zone.m_name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                        << ring->m_thread_id << ", \"ts\": " << static_cast<double>(zone.m_start) / 1000.0
+                        << ", \"dur\": " << static_cast<double>(zone.m_end - zone.m_start) / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    return file.good();
+}
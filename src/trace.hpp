@@ -0,0 +1,58 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// Scoped CPU zones, recorded per thread and exported as Chrome trace event JSON, which chrome://tracing and
+// ui.perfetto.dev open. Configure with -DTRACING=ON, otherwise the macros compile to nothing.
+#ifdef TRACING_ENABLED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace trace {
+// Zones each thread keeps, the oldest ones are overwritten.
+constexpr std::size_t zones_per_thread = 1 << 15;
+
+// Nanoseconds on the steady clock since the program started.
+[[nodiscard]] std::uint64_t now() noexcept;
+
+// Adds a zone to the ring of the calling thread. The name must live as long as the program, e.g. a string literal.
+void record(const char* name, std::uint64_t start, std::uint64_t end) noexcept;
+
+// Names the calling thread in the trace. The name must live as long as the program.
+void set_thread_name(const char* name) noexcept;
+
+// Writes the zones of every thread. Threads may keep recording meanwhile. Returns false if the file could not be
+// written.
+bool export_json(std::string_view path) noexcept;
+
+// Records the time from its construction to its destruction.
+class [[nodiscard]] zone_t {
+    const char* m_name;
+    std::uint64_t m_start;
+
+public:
+    explicit zone_t(const char* name) noexcept : m_name(name), m_start(now()) {
+    }
+
+    zone_t(const zone_t&) = delete;
+
+    ~zone_t() noexcept { record(m_name, m_start, now()); }
+};
+}
+
+#define TRACE_CONCATENATE_INNER(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_INNER(a, b)
+
+// Records the rest of the enclosing scope as a zone.
+#define TRACE_ZONE(name) const trace::zone_t TRACE_CONCATENATE(trace_zone_, __LINE__){name}
+#define TRACE_THREAD_NAME(name) trace::set_thread_name(name)
+
+#else
+
+#define TRACE_ZONE(name) static_cast<void>(0)
+#define TRACE_THREAD_NAME(name) static_cast<void>(0)
+
+#endif
+
+#endif //TRACE_HPP
@@ -0,0 +1,232 @@
+#include "video_wall.hpp"
+
+#include "globals.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+// The lines start on their own cache line after the header.
+constexpr std::size_t lines_offset = (sizeof(video_wall_header_t) + 63) / 64 * 64;
+
+// Waits spent spinning before yielding, and yielding before sleeping.
+constexpr int spin_waits = 64;
+constexpr int yield_waits = 1024;
+
+[[noreturn]] void fail(std::string_view what, std::string_view name) noexcept {
+    std::cerr << what << " " << name << ": " << std::strerror(errno) << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+void* map(int descriptor, std::size_t size, std::string_view name) noexcept {
+    const auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (memory == MAP_FAILED) {
+        close(descriptor);
+        fail("Failed to map shared memory", name);
+    }
+    close(descriptor);
+    return memory;
+}
+
+// Waits until done() is true, giving up when stop() is or after the video wall timeout.
+template<typename TDone, typename TStop>
+bool wait_until(TDone&& done, TStop&& stop) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(video_wall_timeout);
+    for (auto waits = 0;; waits++) {
+        if (done()) {
+            return true;
+        }
+        if (stop()) {
+            return false;
+        }
+
+        if (waits < spin_waits) {
+            continue;
+        }
+        if (waits < yield_waits) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+}
+
+video_wall_t::video_wall_t(std::string_view name,
+                           video_wall_header_t* header,
+                           std::size_t mapping_size,
+                           bool leader) noexcept
+    : m_name(name),
+      m_header(header),
+      m_lines(reinterpret_cast<line*>(reinterpret_cast<std::byte*>(header) + lines_offset)),
+      m_mapping_size(mapping_size),
+      m_leader(leader) {
+}
+
+video_wall_t::video_wall_t(video_wall_t&& other) noexcept
+    : m_name(std::move(other.m_name)),
+      m_header(other.m_header),
+      m_lines(other.m_lines),
+      m_mapping_size(other.m_mapping_size),
+      m_leader(other.m_leader),
+      m_frames(other.m_frames),
+      m_line_count(other.m_line_count),
+      m_frame_line_count(other.m_frame_line_count),
+      m_dropped_lines(other.m_dropped_lines) {
+    other.m_moved = true;
+}
+
+video_wall_t::~video_wall_t() {
+    if (!m_moved) {
+        std::cerr << "Deleted video wall" << std::endl;
+        close();
+        munmap(m_header, m_mapping_size);
+        // The followers keep their mappings, only the name goes away.
+        if (m_leader) {
+            shm_unlink(m_name.c_str());
+        }
+    }
+}
+
+void video_wall_t::add_line(const line& value) noexcept {
+    if (m_line_count - m_frame_line_count >= m_header->m_line_capacity) {
+        m_dropped_lines++;
+        return;
+    }
+
+    new(&m_lines[m_line_count % m_header->m_line_capacity]) line(value);
+    m_line_count++;
+}
+
+void video_wall_t::publish_frame() noexcept {
+    m_header->m_line_count = m_line_count;
+    m_frame_line_count = m_line_count;
+    m_header->m_published_frames.store(++m_frames, std::memory_order_release);
+}
+
+bool video_wall_t::wait_for_frame() noexcept {
+    const auto frames = m_frames + 1;
+    const auto published = wait_until(
+        [&] { return m_header->m_published_frames.load(std::memory_order_acquire) >= frames; },
+        [&] { return m_header->m_closed.load(std::memory_order_relaxed); });
+    if (!published && !m_header->m_closed.load(std::memory_order_relaxed)) {
+        std::cerr << "Video wall " << m_name << " lost its leader" << std::endl;
+    }
+    return published;
+}
+
+bool video_wall_t::present_barrier() noexcept {
+    const auto generation = m_header->m_generation.load(std::memory_order_acquire);
+    if (m_header->m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_header->m_process_count) {
+        m_header->m_arrived.store(0, std::memory_order_relaxed);
+        m_header->m_generation.store(generation + 1, std::memory_order_release);
+        return true;
+    }
+
+    // A process that stops after everyone arrived still lets the others through.
+    const auto passed = wait_until(
+        [&] { return m_header->m_generation.load(std::memory_order_acquire) != generation; },
+        [&] { return m_header->m_closed.load(std::memory_order_relaxed); });
+    if (!passed && !m_header->m_closed.load(std::memory_order_relaxed)) {
+        std::cerr << "Video wall " << m_name << " lost a process" << std::endl;
+    }
+    return passed;
+}
+
+void video_wall_t::close() noexcept {
+    m_header->m_closed.store(true, std::memory_order_relaxed);
+}
+
+video_wall_t video_wall_t::create(std::string_view name,
+                                  std::uint32_t process_count,
+                                  std::uint32_t line_capacity) noexcept {
+    const std::string shm_name(name);
+    // Followers of an earlier wall keep the old memory, new ones only find this one.
+    shm_unlink(shm_name.c_str());
+    const auto descriptor = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor == -1) {
+        fail("Failed to create shared memory", name);
+    }
+
+    const auto size = lines_offset + line_capacity * sizeof(line);
+    if (ftruncate(descriptor, static_cast<off_t>(size)) == -1) {
+        ::close(descriptor);
+        fail("Failed to size shared memory", name);
+    }
+
+    const auto header = new(map(descriptor, size, name)) video_wall_header_t{
+        video_wall_header_t::magic, video_wall_header_t::version, process_count, line_capacity, false, false, 0, 0, {},
+        0, 0};
+    header->m_ready.store(true, std::memory_order_release);
+
+    return {name, header, size, true};
+}
+
+video_wall_t video_wall_t::open(std::string_view name, std::uint32_t process_count) noexcept {
+    const std::string shm_name(name);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(video_wall_timeout);
+
+    // The leader may not have started yet, or not be done setting up, or the memory may be left from an earlier wall.
+    while (true) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Timed out waiting for the leader of video wall " << name << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        const auto descriptor = shm_open(shm_name.c_str(), O_RDWR, 0);
+        if (descriptor == -1) {
+            if (errno != ENOENT) {
+                fail("Failed to open shared memory", name);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        struct stat status{};
+        if (fstat(descriptor, &status) == -1) {
+            ::close(descriptor);
+            fail("Failed to read the size of shared memory", name);
+        }
+
+        const auto size = static_cast<std::size_t>(status.st_size);
+        if (size < lines_offset) {
+            ::close(descriptor);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        const auto header = static_cast<video_wall_header_t*>(map(descriptor, size, name));
+        if (!header->m_ready.load(std::memory_order_acquire) || header->m_closed.load(std::memory_order_relaxed)) {
+            munmap(header, size);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        if (header->m_magic != video_wall_header_t::magic || header->m_version != video_wall_header_t::version ||
+            lines_offset + header->m_line_capacity * sizeof(line) > size) {
+            std::cerr << "Shared memory " << name << " is not a version " << video_wall_header_t::version
+                      << " video wall" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        if (header->m_process_count != process_count) {
+            std::cerr << "Video wall " << name << " has " << header->m_process_count << " processes, not "
+                      << process_count << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        return {name, header, size, false};
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef VIDEO_WALL_HPP
+#define VIDEO_WALL_HPP
+
+#include "primitives.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Start of the shared memory of a video wall, followed by the ring of lines.
+struct video_wall_header_t {
+    static constexpr std::uint32_t magic = 0x5757'4646; // "FFWW"
+    static constexpr std::uint32_t version = 1;
+    // Bytes of scene state the leader publishes with every frame.
+    static constexpr std::size_t state_size = 1024;
+
+    std::uint32_t m_magic;
+    std::uint32_t m_version;
+    std::uint32_t m_process_count;
+    std::uint32_t m_line_capacity;
+    // Set by the leader once the rest is initialized.
+    std::atomic<bool> m_ready;
+    // Set by the first process that stops, the others follow it.
+    std::atomic<bool> m_closed;
+
+    // Written by the leader. The number of frames published, the state of the last one and the number of lines added
+    // up to it.
+    alignas(64) std::atomic<std::uint64_t> m_published_frames;
+    std::uint64_t m_line_count;
+    alignas(64) std::byte m_state[state_size];
+
+    // The frame barrier. The last process to arrive resets the count and starts the next generation.
+    alignas(64) std::atomic<std::uint32_t> m_arrived;
+    std::atomic<std::uint64_t> m_generation;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The counters are shared between processes");
+static_assert(std::is_trivially_copyable_v<line>, "Lines are copied through shared memory");
+
+// Several processes on one machine that each render a part of the same canvas, such as the outputs of a video wall.
+// The leader runs the scene and publishes its state and new lines through POSIX shared memory every frame. The
+// followers take both over, and everyone waits at a barrier before presenting, so all show the same frame.
+class [[nodiscard]] video_wall_t {
+    std::string m_name;
+    video_wall_header_t* m_header;
+    line* m_lines;
+    std::size_t m_mapping_size;
+    bool m_leader;
+    bool m_moved = false;
+
+    // Frames published or received so far, and lines added or taken over.
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_line_count = 0;
+    // Leader only, lines at the start of the frame being built, and lines that did not fit in the ring.
+    std::uint64_t m_frame_line_count = 0;
+    std::uint64_t m_dropped_lines = 0;
+
+    [[nodiscard]] video_wall_t(std::string_view name,
+                               video_wall_header_t* header,
+                               std::size_t mapping_size,
+                               bool leader) noexcept;
+
+    void publish_frame() noexcept;
+
+    // Waits for the leader to publish the next frame. False when the wall closes or the leader is gone.
+    [[nodiscard]] bool wait_for_frame() noexcept;
+
+public:
+    video_wall_t() = delete;
+
+    video_wall_t(const video_wall_t&) = delete;
+
+    [[nodiscard]] video_wall_t(video_wall_t&& other) noexcept;
+
+    ~video_wall_t();
+
+    [[nodiscard]] bool leader() const noexcept { return m_leader; }
+    [[nodiscard]] std::uint32_t process_count() const noexcept { return m_header->m_process_count; }
+    [[nodiscard]] std::uint64_t dropped_lines() const noexcept { return m_dropped_lines; }
+
+    // Leader: adds a line to the frame being built. Dropped when the frame already adds more than the ring holds.
+    void add_line(const line& value) noexcept;
+
+    // Leader: publishes the state of the frame being built, along with the lines added to it.
+    template<typename TState>
+    void publish(const TState& state) noexcept {
+        static_assert(std::is_trivially_copyable_v<TState> && sizeof(TState) <= video_wall_header_t::state_size);
+        std::memcpy(m_header->m_state, &state, sizeof(TState));
+        publish_frame();
+    }
+
+    // Follower: waits for the next frame of the leader, calls function(const line&) on the lines added in it and
+    // copies its state. False when the wall closes or the leader is gone.
+    template<typename TState, typename TFunction>
+    [[nodiscard]] bool receive(TState& state, TFunction&& function) noexcept {
+        static_assert(std::is_trivially_copyable_v<TState> && sizeof(TState) <= video_wall_header_t::state_size);
+        if (!wait_for_frame()) {
+            return false;
+        }
+
+        // The leader only writes again once everyone has passed the barrier of this frame.
+        for (const auto line_count = m_header->m_line_count; m_line_count < line_count; m_line_count++) {
+            function(m_lines[m_line_count % m_header->m_line_capacity]);
+        }
+        std::memcpy(&state, m_header->m_state, sizeof(TState));
+        m_frames++;
+        return true;
+    }
+
+    // Waits until every process has rendered the frame, right before presenting it. False when the wall closes or a
+    // process is gone.
+    [[nodiscard]] bool present_barrier() noexcept;
+
+    // Tells the other processes to stop as well.
+    void close() noexcept;
+
+    // Creates the shared memory for process_count processes, replacing a stale one. The name is removed again when the
+    // wall is destroyed. Exits with a message on failure.
+    static video_wall_t create(std::string_view name,
+                               std::uint32_t process_count,
+                               std::uint32_t line_capacity) noexcept;
+
+    // Opens the shared memory of a leader, waiting for it to create it. Exits with a message on failure.
+    static video_wall_t open(std::string_view name, std::uint32_t process_count) noexcept;
+};
+
+#endif //VIDEO_WALL_HPP
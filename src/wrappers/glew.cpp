@@ -6,6 +6,7 @@
 
 #include <GL/glew.h>
 
+#include <atomic>
 #include <sstream>
 #include <iostream>
 #include <string>
@@ -15,6 +16,34 @@
 #define __PRETTY_FUNCTION__ __FUNCSIG__
 #endif
 
+namespace {
+std::atomic<std::uint64_t> gl_call_count{0};
+
+// Every GLEW entry point is a function pointer, so counting is done by swapping in a trampoline.
+// The tag makes each wrapped function get its own copy of the original pointer.
+template<typename Tag, typename Function>
+struct counting_trampoline_t;
+
+template<typename Tag, typename Result, typename... Arguments>
+struct counting_trampoline_t<Tag, Result (GLAPIENTRY*)(Arguments...)> {
+    static inline Result (GLAPIENTRY* original)(Arguments...) = nullptr;
+
+    static Result GLAPIENTRY call(Arguments... arguments) {
+        gl_call_count.fetch_add(1, std::memory_order_relaxed);
+        return original(arguments...);
+    }
+};
+}
+
+#define GLEW_COUNT_CALLS(name) \
+    do { \
+        using trampoline_t = counting_trampoline_t<struct name##_tag_t, decltype(__glew##name)>; \
+        if (__glew##name != nullptr && __glew##name != &trampoline_t::call) { \
+            trampoline_t::original = __glew##name; \
+            __glew##name = &trampoline_t::call; \
+        } \
+    } while (false)
+
 #define GLEW_QUIT_WITH_ERROR(result) \
     do { \
         auto error = glewGetErrorString(result); \
@@ -38,3 +67,46 @@ void glew::init() noexcept {
     auto result = glewInit();
     GLEW_QUIT_IF_ERROR(result);
 }
+
+void glew::count_calls() noexcept {
+    // Polling for query results and fences is left out, how often it happens depends on how far the GPU is behind.
+    GLEW_COUNT_CALLS(ActiveTexture);
+    GLEW_COUNT_CALLS(BeginQuery);
+    GLEW_COUNT_CALLS(BindBuffer);
+    GLEW_COUNT_CALLS(BindBufferBase);
+    GLEW_COUNT_CALLS(BindBufferRange);
+    GLEW_COUNT_CALLS(BindFramebuffer);
+    GLEW_COUNT_CALLS(BindRenderbuffer);
+    GLEW_COUNT_CALLS(BindVertexArray);
+    GLEW_COUNT_CALLS(BlendEquation);
+    GLEW_COUNT_CALLS(BlitFramebuffer);
+    GLEW_COUNT_CALLS(BufferData);
+    GLEW_COUNT_CALLS(BufferSubData);
+    GLEW_COUNT_CALLS(DeleteSync);
+    GLEW_COUNT_CALLS(DisableVertexAttribArray);
+    GLEW_COUNT_CALLS(DispatchCompute);
+    GLEW_COUNT_CALLS(DrawArraysInstanced);
+    GLEW_COUNT_CALLS(DrawArraysInstancedBaseInstance);
+    GLEW_COUNT_CALLS(EnableVertexAttribArray);
+    GLEW_COUNT_CALLS(EndQuery);
+    GLEW_COUNT_CALLS(FenceSync);
+    GLEW_COUNT_CALLS(FramebufferTexture2D);
+    GLEW_COUNT_CALLS(MapBufferRange);
+    GLEW_COUNT_CALLS(MemoryBarrier);
+    GLEW_COUNT_CALLS(MultiDrawArraysIndirect);
+    GLEW_COUNT_CALLS(QueryCounter);
+    GLEW_COUNT_CALLS(RenderbufferStorageMultisample);
+    GLEW_COUNT_CALLS(Uniform1f);
+    GLEW_COUNT_CALLS(Uniform1i);
+    GLEW_COUNT_CALLS(Uniform2fv);
+    GLEW_COUNT_CALLS(Uniform3fv);
+    GLEW_COUNT_CALLS(UniformMatrix4fv);
+    GLEW_COUNT_CALLS(UnmapBuffer);
+    GLEW_COUNT_CALLS(UseProgram);
+    GLEW_COUNT_CALLS(VertexAttribDivisor);
+    GLEW_COUNT_CALLS(VertexAttribPointer);
+}
+
+std::uint64_t glew::call_count() noexcept {
+    return gl_call_count.load(std::memory_order_relaxed);
+}
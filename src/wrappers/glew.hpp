@@ -5,8 +5,16 @@
 #ifndef GLEW_HPP
 #define GLEW_HPP
 
+#include <cstdint>
+
 namespace glew {
 void init() noexcept;
+
+// Routes the GLEW entry points the renderer uses through a counter. Call after init.
+// Core GL 1.1 functions are linked directly and are not counted.
+void count_calls() noexcept;
+
+[[nodiscard]] std::uint64_t call_count() noexcept;
 }
 
 #endif //GLEW_HPP
@@ -3,6 +3,8 @@
 //
 
 #include "opengl.hpp"
+#include "opengl/attribute_buffer_object.hpp"
+#include "../trace.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -45,6 +47,7 @@ void gl::print_program_info_log(const program_t& program) noexcept {
 }
 
 void gl::link_program(const program_t& program) noexcept {
+    TRACE_ZONE("gl::link_program");
     glLinkProgram(program.value());
 
     GLint status;
@@ -75,6 +78,28 @@ gl::uniform_location_t gl::get_uniform_location(const program_t& program, const
     return uniform_location_t(uniform);
 }
 
+void gl::check_uniform_type(const program_t& program, const char* name, GLenum type) noexcept {
+    GLuint index = GL_INVALID_INDEX;
+    glGetUniformIndices(program.value(), 1, &name, &index);
+    GLint actual_type = GL_NONE;
+    if (index != GL_INVALID_INDEX) {
+        glGetActiveUniformsiv(program.value(), 1, &index, GL_UNIFORM_TYPE, &actual_type);
+    }
+
+    if (static_cast<GLenum>(actual_type) != type) {
+        std::cerr << "Uniform " << name << " has type 0x" << std::hex << actual_type << ", expected 0x" << type
+                  << std::dec << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+GLint gl::get_integer(GLenum name) noexcept {
+    GLint value = 0;
+    glGetIntegerv(name, &value);
+
+    return value;
+}
+
 void gl::clear_color(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) noexcept {
     glClearColor(red, green, blue, alpha);
 }
@@ -95,6 +120,10 @@ void gl::uniform_matrix(const uniform_location_t& uniform, const glm::mat4& matr
     glUniformMatrix4fv(uniform.uniform_location(), 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
+void gl::uniform_vec2(const uniform_location_t& uniform, const glm::vec2& vector) noexcept {
+    glUniform2fv(uniform.uniform_location(), 1, glm::value_ptr(vector));
+}
+
 void gl::uniform_vec3(const uniform_location_t& uniform, const glm::vec3& vector) noexcept {
     glUniform3fv(uniform.uniform_location(), 1, glm::value_ptr(vector));
 }
@@ -103,10 +132,6 @@ void gl::uniform_float(const uniform_location_t& uniform, float value) noexcept
     glUniform1f(uniform.uniform_location(), value);
 }
 
-void gl::uniform_frame_buffer(const uniform_location_t& uniform, GLint texture_index) noexcept {
-    glUniform1i(uniform.uniform_location(), texture_index);
-}
-
 void gl::draw_arrays(GLenum mode, GLint first, GLsizei count) noexcept {
     glDrawArrays(mode, first, count);
 }
@@ -114,3 +139,34 @@ void gl::draw_arrays(GLenum mode, GLint first, GLsizei count) noexcept {
 void gl::draw_elements(GLenum mode, GLsizei count, GLenum type) noexcept {
     glDrawElements(mode, count, type, nullptr);
 }
+
+void gl::draw_arrays_instanced_base_instance(GLenum mode,
+                                             GLint first,
+                                             GLsizei count,
+                                             GLsizei instance_count,
+                                             GLuint base_instance) noexcept {
+    glDrawArraysInstancedBaseInstance(mode, first, count, instance_count, base_instance);
+}
+
+void gl::multi_draw_arrays_indirect(GLenum mode, std::size_t first_command, GLsizei draw_count) noexcept {
+    const auto offset = first_command * sizeof(draw_arrays_indirect_command_t);
+    glMultiDrawArraysIndirect(mode, reinterpret_cast<const void*>(offset), draw_count, 0);
+}
+
+bool gl::supports_multi_draw_indirect() noexcept {
+    static const bool supported = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+    return supported;
+}
+
+bool gl::supports_compute_shaders() noexcept {
+    static const bool supported = GLEW_VERSION_4_3;
+    return supported;
+}
+
+void gl::dispatch_compute(GLuint group_count) noexcept {
+    glDispatchCompute(group_count, 1, 1);
+}
+
+void gl::memory_barrier(GLbitfield barriers) noexcept {
+    glMemoryBarrier(barriers);
+}
@@ -9,8 +9,12 @@
 #include <glm/glm.hpp>
 
 #include "opengl/shader.hpp"
+#include "opengl/shader_binding.hpp"
 #include "../utilities.hpp"
 
+#include <cstddef>
+#include <type_traits>
+
 namespace gl {
 
 class uniform_location_t {
@@ -24,6 +28,15 @@ public:
     [[nodiscard]] constexpr GLint uniform_location() const noexcept { return m_uniform_location; }
 };
 
+// A uniform location that can only be set with the type the shader declares the uniform with.
+template<typename TValue>
+class typed_uniform_location_t : public uniform_location_t {
+public:
+    constexpr explicit typed_uniform_location_t(uniform_location_t location) noexcept
+        : uniform_location_t(location) {
+    }
+};
+
 
 using vertex_array_object_t = utilities::raii_wrapper<GLuint, void(*)(GLuint)>;
 
@@ -46,6 +59,20 @@ void unbind_program() noexcept;
 
 [[nodiscard]] uniform_location_t get_uniform_location(const program_t& program, const char* name) noexcept;
 
+// Exits with a message if the linked program declares the uniform with another type.
+void check_uniform_type(const program_t& program, const char* name, GLenum type) noexcept;
+
+// Looked up once, when the shader is created.
+template<typename TValue>
+[[nodiscard]] typed_uniform_location_t<TValue> get_uniform_location(const program_t& program,
+                                                                    const uniform_binding_t<TValue>& uniform) noexcept {
+    const auto location = get_uniform_location(program, uniform.m_name);
+    check_uniform_type(program, uniform.m_name, uniform_type<TValue>);
+    return typed_uniform_location_t<TValue>(location);
+}
+
+[[nodiscard]] GLint get_integer(GLenum name) noexcept;
+
 void clear_color(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) noexcept;
 
 void clear(GLbitfield mask) noexcept;
@@ -55,15 +82,49 @@ void clear(GLbitfield mask) noexcept;
 
 void uniform_matrix(const uniform_location_t& uniform, const glm::mat4& matrix) noexcept;
 
+void uniform_vec2(const uniform_location_t& uniform, const glm::vec2& vector) noexcept;
+
 void uniform_vec3(const uniform_location_t& uniform, const glm::vec3& vector) noexcept;
 
 void uniform_float(const uniform_location_t& uniform, float value) noexcept;
 
-void uniform_frame_buffer(const uniform_location_t& uniform, GLint texture_index) noexcept;
+template<typename TValue>
+void set_uniform(const typed_uniform_location_t<TValue>& uniform, const std::type_identity_t<TValue>& value) noexcept {
+    if constexpr (std::is_same_v<TValue, glm::mat4>) {
+        uniform_matrix(uniform, value);
+    } else if constexpr (std::is_same_v<TValue, glm::vec2>) {
+        uniform_vec2(uniform, value);
+    } else if constexpr (std::is_same_v<TValue, glm::vec3>) {
+        uniform_vec3(uniform, value);
+    } else {
+        static_assert(std::is_same_v<TValue, GLfloat>, "no setter for this uniform type");
+        uniform_float(uniform, value);
+    }
+}
 
 void draw_arrays(GLenum mode, GLint first, GLsizei count) noexcept;
 
 void draw_elements(GLenum mode, GLsizei count, GLenum type) noexcept;
+
+// Draws instances starting at base_instance, the instanced attributes are fetched from there on.
+void draw_arrays_instanced_base_instance(GLenum mode,
+                                         GLint first,
+                                         GLsizei count,
+                                         GLsizei instance_count,
+                                         GLuint base_instance) noexcept;
+
+// Submits draw_count commands from the bound GL_DRAW_INDIRECT_BUFFER, starting at first_command.
+void multi_draw_arrays_indirect(GLenum mode, std::size_t first_command, GLsizei draw_count) noexcept;
+
+// glMultiDrawArraysIndirect is core in 4.3, the context only asks for 4.2.
+[[nodiscard]] bool supports_multi_draw_indirect() noexcept;
+
+// Compute shaders and shader storage blocks are core in 4.3 as well.
+[[nodiscard]] bool supports_compute_shaders() noexcept;
+
+void dispatch_compute(GLuint group_count) noexcept;
+
+void memory_barrier(GLbitfield barriers) noexcept;
 }
 
 #endif //OPENGL_HPP
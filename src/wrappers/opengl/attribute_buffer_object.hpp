@@ -5,6 +5,9 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <iostream>
 #include <type_traits>
 
@@ -22,12 +25,15 @@ public:
     [[nodiscard]] constexpr GLint attribute_location() const noexcept { return m_attribute_location; }
 };
 
-[[nodiscard]] attribute_location_t get_attribute_location(const program_t& program, const char* name) noexcept;
+template<typename TValue, GLint Size, GLenum Type, bool Instanced>
+struct attribute_binding_t;
 
 template<typename TValue, GLenum Target, GLint Size, GLenum Type, bool Instanced = false, GLenum Usage = GL_STATIC_DRAW>
 class [[nodiscard]] attribute_buffer_object_t {
     attribute_location_t m_attribute_location;
     GLuint m_buffer_object;
+    // Values the storage has room for, for the buffers that are streamed or allocated every frame.
+    mutable std::size_t m_capacity = 0;
     bool m_moved;
 
     [[nodiscard]] explicit constexpr attribute_buffer_object_t(attribute_location_t attribute_location, GLuint buffer_object) noexcept
@@ -43,7 +49,10 @@ public:
 
 
     [[nodiscard]] constexpr attribute_buffer_object_t(attribute_buffer_object_t&& other) noexcept
-        : m_attribute_location(other.m_attribute_location), m_buffer_object(other.m_buffer_object), m_moved(false) {
+        : m_attribute_location(other.m_attribute_location),
+          m_buffer_object(other.m_buffer_object),
+          m_capacity(other.m_capacity),
+          m_moved(false) {
         other.m_moved = true;
     }
 
@@ -66,7 +75,40 @@ public:
         glBufferData(Target, data.size() * sizeof(TValue), data.data(), Usage);
     }
 
-    template<GLenum ETarget = Target, typename = std::enable_if_t<ETarget != GL_ELEMENT_ARRAY_BUFFER>, int Iterations =
+    // For data that is uploaded again every frame. The storage is orphaned, so the driver hands out a fresh block
+    // instead of waiting for the GPU to finish reading the old one, and its size only changes when the data outgrows
+    // it, doubling, so the blocks of the same size can be recycled.
+    template<typename TContainer>
+    void stream_data(const TContainer& data) const noexcept {
+        static_assert(std::is_same_v<typename TContainer::value_type, TValue>);
+
+        allocate(data.size());
+        glBufferSubData(Target, 0, data.size() * sizeof(TValue), data.data());
+    }
+
+    // Makes room for at least count values without uploading any, for buffers written on the GPU. Orphans the
+    // storage like stream_data().
+    void allocate(std::size_t count) const noexcept {
+        bind();
+        if (count > m_capacity || m_capacity == 0) {
+            m_capacity = std::bit_ceil(std::max<std::size_t>(count, 1));
+        }
+        glBufferData(Target, m_capacity * sizeof(TValue), nullptr, Usage);
+    }
+
+    // Binds the buffer to the shader storage block at the given binding point, see storage_block_binding_t.
+    void bind_storage(GLuint binding) const noexcept {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_buffer_object);
+    }
+
+    // Binds only the first count values, so the length of the block's array is count rather than the capacity.
+    // An empty range cannot be bound, with no values one is bound that nothing should read.
+    void bind_storage(GLuint binding, std::size_t count) const noexcept {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_buffer_object, 0,
+                          static_cast<GLsizeiptr>(std::max<std::size_t>(count, 1) * sizeof(TValue)));
+    }
+
+    template<GLenum ETarget = Target, typename = std::enable_if_t<ETarget == GL_ARRAY_BUFFER>, int Iterations =
             std::is_same_v<TValue, glm::mat4> ? 4 : 1>
     void upload() const noexcept {
         // Set location data
@@ -83,7 +125,7 @@ public:
         }
     }
 
-    template<GLenum ETarget, typename = std::enable_if_t<ETarget == GL_ELEMENT_ARRAY_BUFFER> >
+    template<GLenum ETarget = Target, typename = std::enable_if_t<ETarget != GL_ARRAY_BUFFER> >
     [[nodiscard]] static attribute_buffer_object_t create_buffer_object() {
         GLuint buffer_object;
         glGenBuffers(1, &buffer_object);
@@ -93,7 +135,7 @@ public:
     }
 
     template<typename TContainer, GLenum ETarget = Target, typename = std::enable_if_t<
-        ETarget == GL_ELEMENT_ARRAY_BUFFER> >
+        ETarget != GL_ARRAY_BUFFER> >
     [[nodiscard]] static attribute_buffer_object_t create_buffer_object(const TContainer& data) {
         static_assert(std::is_same_v<typename TContainer::value_type, TValue>);
 
@@ -105,26 +147,25 @@ public:
         return attribute_buffer_object_t(buffer_object);
     }
 
-    template<GLenum ETarget = Target, typename = std::enable_if_t<ETarget != GL_ELEMENT_ARRAY_BUFFER> >
-    [[nodiscard]] static attribute_buffer_object_t create_buffer_object(const program_t& program,
-                                                          const char* attribute_name) noexcept {
-        auto attribute_location = get_attribute_location(program, attribute_name);
-
+    // Only a buffer of the type the shader declares the attribute with can be created for it.
+    template<GLenum ETarget = Target, typename = std::enable_if_t<ETarget == GL_ARRAY_BUFFER> >
+    [[nodiscard]] static attribute_buffer_object_t create_buffer_object(
+            const attribute_binding_t<TValue, Size, Type, Instanced>& attribute) noexcept {
         GLuint buffer_object;
         glGenBuffers(1, &buffer_object);
         glBindBuffer(Target, buffer_object);
 
-        return attribute_buffer_object_t(attribute_location, buffer_object);
+        return attribute_buffer_object_t(attribute.location(), buffer_object);
     }
 
     template<typename TContainer, GLenum ETarget = Target, typename = std::enable_if_t<
-        ETarget != GL_ELEMENT_ARRAY_BUFFER> >
-    [[nodiscard]] static attribute_buffer_object_t create_buffer_object(const TContainer& data,
-                                                          const program_t& program,
-                                                          const char* attribute_name) noexcept {
+        ETarget == GL_ARRAY_BUFFER> >
+    [[nodiscard]] static attribute_buffer_object_t create_buffer_object(
+            const TContainer& data,
+            const attribute_binding_t<TValue, Size, Type, Instanced>& attribute) noexcept {
         static_assert(std::is_same_v<typename TContainer::value_type, TValue>);
 
-        auto attribute_location = get_attribute_location(program, attribute_name);
+        const auto attribute_location = attribute.location();
 
         GLuint buffer_object;
         glGenBuffers(1, &buffer_object);
@@ -144,6 +185,23 @@ using model_color_buffer_object_t = attribute_buffer_object_t<glm::vec3, GL_ARRA
     GL_DYNAMIC_DRAW>;
 using vertex_width_buffer_object_t = attribute_buffer_object_t<glm::vec3, GL_ARRAY_BUFFER, 3, GL_FLOAT, true,
     GL_DYNAMIC_DRAW>;
+using line_lifetime_buffer_object_t = attribute_buffer_object_t<glm::vec2, GL_ARRAY_BUFFER, 2, GL_FLOAT, true,
+    GL_DYNAMIC_DRAW>;
+using tile_rect_buffer_object_t = attribute_buffer_object_t<glm::vec4, GL_ARRAY_BUFFER, 4, GL_FLOAT, true,
+    GL_DYNAMIC_DRAW>;
+
+// Layout of a command in a GL_DRAW_INDIRECT_BUFFER, as read by glMultiDrawArraysIndirect.
+struct draw_arrays_indirect_command_t {
+    GLuint m_count;
+    GLuint m_instance_count;
+    GLuint m_first;
+    GLuint m_base_instance;
+};
+
+static_assert(sizeof(draw_arrays_indirect_command_t) == 4 * sizeof(GLuint));
+
+using indirect_buffer_object_t = attribute_buffer_object_t<draw_arrays_indirect_command_t, GL_DRAW_INDIRECT_BUFFER, -1,
+    GL_UNSIGNED_INT, false, GL_DYNAMIC_DRAW>;
 
 
 
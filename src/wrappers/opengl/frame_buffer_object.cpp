@@ -4,21 +4,69 @@
 
 #include "frame_buffer_object.hpp"
 
-void set_texture_size(GLuint texture_object, const glm::ivec2& size) {
+#include <algorithm>
+#include <bit>
+
+std::size_t bytes_per_pixel(GLenum format) {
+    switch (format) {
+        case GL_RGBA16F:
+            return 8;
+
+        case GL_RGBA32F:
+            return 16;
+
+        default:
+            return 4;
+    }
+}
+
+void set_texture_size(GLuint texture_object, const glm::ivec2& size, GLenum format) {
     glBindTexture(GL_TEXTURE_2D, texture_object);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    // Sized format so that multisample resolves have a matching destination format.
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format), size.x, size.y, 0, GL_RGBA,
+                 format == GL_RGBA8 ? GL_UNSIGNED_BYTE : GL_FLOAT, nullptr);
+}
+
+void set_render_buffer_size(GLuint render_buffer_object, const glm::ivec2& size, int samples, GLenum format) {
+    glBindRenderbuffer(GL_RENDERBUFFER, render_buffer_object);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
 void gl::frame_buffer_object_t::bind() const noexcept {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_frame_buffer_object);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_samples > 1 ? m_multisample_frame_buffer_object : m_frame_buffer_object);
+    glViewport(0, 0, m_viewport_size.x, m_viewport_size.y);
 }
 
 void gl::frame_buffer_object_t::unbind() const noexcept {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void gl::frame_buffer_object_t::set_size(const glm::ivec2& size) const noexcept {
-    set_texture_size(m_texture_object, size);
+void gl::frame_buffer_object_t::set_size(const glm::ivec2& size, int samples) noexcept {
+    set_texture_size(m_texture_object, size, m_format);
+    if (samples > 1) {
+        set_render_buffer_size(m_multisample_render_buffer_object, size, samples, m_format);
+    }
+
+    m_size = size;
+    m_viewport_size = size;
+    m_samples = samples;
+}
+
+void gl::frame_buffer_object_t::set_viewport_size(const glm::ivec2& viewport_size) noexcept {
+    m_viewport_size = viewport_size;
+}
+
+void gl::frame_buffer_object_t::resolve() const noexcept {
+    if (m_samples <= 1) {
+        return;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_multisample_frame_buffer_object);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_frame_buffer_object);
+    glBlitFramebuffer(0, 0, m_viewport_size.x, m_viewport_size.y, 0, 0, m_viewport_size.x, m_viewport_size.y,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void gl::frame_buffer_object_t::bind_texture() const noexcept {
@@ -26,18 +74,125 @@ void gl::frame_buffer_object_t::bind_texture() const noexcept {
 }
 
 
-gl::frame_buffer_object_t gl::frame_buffer_object_t::create(const glm::ivec2& texture_size) noexcept {
+gl::frame_buffer_object_t gl::frame_buffer_object_t::create(const glm::ivec2& texture_size,
+                                                            GLint filter,
+                                                            int samples,
+                                                            GLenum format) noexcept {
+    GLuint multisample_frame_buffer_object;
+    glGenFramebuffers(1, &multisample_frame_buffer_object);
+    glBindFramebuffer(GL_FRAMEBUFFER, multisample_frame_buffer_object);
+
+    GLuint multisample_render_buffer_object;
+    glGenRenderbuffers(1, &multisample_render_buffer_object);
+    // Only a bound name is a renderbuffer that can be attached. It is attached even without samples, set_size() adds
+    // them later by changing its storage.
+    glBindRenderbuffer(GL_RENDERBUFFER, multisample_render_buffer_object);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if (samples > 1) {
+        set_render_buffer_size(multisample_render_buffer_object, texture_size, samples, format);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, multisample_render_buffer_object);
+
     GLuint frame_buffer_object;
     glGenFramebuffers(1, &frame_buffer_object);
     glBindFramebuffer(GL_FRAMEBUFFER, frame_buffer_object);
 
     GLuint texture_object;
     glGenTextures(1, &texture_object);
-    set_texture_size(texture_object, texture_size);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    set_texture_size(texture_object, texture_size, format);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_object, 0);
 
-    return frame_buffer_object_t{frame_buffer_object, texture_object};
+    return frame_buffer_object_t{frame_buffer_object,
+                                 texture_object,
+                                 multisample_frame_buffer_object,
+                                 multisample_render_buffer_object,
+                                 texture_size,
+                                 samples,
+                                 format};
+}
+
+glm::ivec2 gl::render_target_pool_t::bucket_size(const glm::ivec2& size) noexcept {
+    const auto round_up = [](int value) {
+        value = std::max(value, 1);
+        const auto granularity = std::clamp(static_cast<int>(std::bit_floor(static_cast<unsigned int>(value))) / 8, 1,
+                                            bucket_granularity);
+        return (value + granularity - 1) / granularity * granularity;
+    };
+
+    return {round_up(size.x), round_up(size.y)};
+}
+
+gl::render_target_handle_t gl::render_target_pool_t::acquire(const glm::ivec2& size,
+                                                             GLint filter,
+                                                             int samples,
+                                                             GLenum format) noexcept {
+    const auto bucket = bucket_size(size);
+
+    // Pick the smallest free target that fits
+    auto best = m_slots.size();
+    for (std::size_t i = 0; i < m_slots.size(); i++) {
+        const auto& slot = m_slots[i];
+        if (slot.m_in_use || slot.m_filter != filter || slot.m_target.samples() != samples ||
+            slot.m_target.format() != format) {
+            continue;
+        }
+
+        const auto& target_size = slot.m_target.size();
+        if (target_size.x < bucket.x || target_size.y < bucket.y) {
+            continue;
+        }
+
+        if (best == m_slots.size() ||
+            target_size.x * target_size.y < m_slots[best].m_target.size().x * m_slots[best].m_target.size().y) {
+            best = i;
+        }
+    }
+
+    if (best == m_slots.size()) {
+        m_slots.push_back({frame_buffer_object_t::create(bucket, filter, samples, format), filter, false});
+        m_allocation_count++;
+    }
+
+    auto& slot = m_slots[best];
+    slot.m_in_use = true;
+    slot.m_target.set_viewport_size(size);
+
+    return best;
+}
+
+void gl::render_target_pool_t::release(render_target_handle_t handle) noexcept {
+    m_slots[handle].m_in_use = false;
+}
+
+void gl::render_target_pool_t::resize(render_target_handle_t handle, const glm::ivec2& size, int samples) noexcept {
+    auto& target = m_slots[handle].m_target;
+    const auto& target_size = target.size();
+
+    if (target.samples() == samples && target_size.x >= size.x && target_size.y >= size.y) {
+        target.set_viewport_size(size);
+        return;
+    }
+
+    // Grow only, never give back space on an axis we already have.
+    target.set_size(glm::max(bucket_size(size), target_size), samples);
+    target.set_viewport_size(size);
+    m_allocation_count++;
+}
+
+std::size_t gl::render_target_pool_t::allocated_bytes() const noexcept {
+    std::size_t bytes = 0;
+    for (const auto& slot : m_slots) {
+        const auto& size = slot.m_target.size();
+        const auto pixels = static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y);
+        // The texture plus the multisampled render buffer if any
+        bytes += pixels * bytes_per_pixel(slot.m_target.format()) *
+                 (slot.m_target.samples() > 1 ? 1 + slot.m_target.samples() : 1);
+    }
+
+    return bytes;
 }
@@ -5,16 +5,42 @@
 
 #include <GL/glew.h>
 
+#include <cstddef>
+#include <vector>
 
 
 namespace gl {
 class [[nodiscard]] frame_buffer_object_t {
     GLuint m_frame_buffer_object;
     GLuint m_texture_object;
+    // Only used when rendering with more than one sample. Resolved into m_texture_object.
+    GLuint m_multisample_frame_buffer_object;
+    GLuint m_multisample_render_buffer_object;
+    // Allocated size of the texture.
+    glm::ivec2 m_size;
+    // The part of the texture that is rendered to, starting at the origin.
+    glm::ivec2 m_viewport_size;
+    int m_samples;
+    // Sized internal format of the texture, GL_RGBA8 or a floating point one.
+    GLenum m_format;
     bool m_moved;
 
-    [[nodiscard]] constexpr explicit frame_buffer_object_t(GLuint frame_buffer_object, GLuint texture_object) noexcept
-        : m_frame_buffer_object(frame_buffer_object), m_texture_object(texture_object), m_moved(false) {
+    [[nodiscard]] constexpr explicit frame_buffer_object_t(GLuint frame_buffer_object,
+                                                           GLuint texture_object,
+                                                           GLuint multisample_frame_buffer_object,
+                                                           GLuint multisample_render_buffer_object,
+                                                           const glm::ivec2& size,
+                                                           int samples,
+                                                           GLenum format) noexcept
+        : m_frame_buffer_object(frame_buffer_object),
+          m_texture_object(texture_object),
+          m_multisample_frame_buffer_object(multisample_frame_buffer_object),
+          m_multisample_render_buffer_object(multisample_render_buffer_object),
+          m_size(size),
+          m_viewport_size(size),
+          m_samples(samples),
+          m_format(format),
+          m_moved(false) {
     }
 
 public:
@@ -23,7 +49,14 @@ public:
     frame_buffer_object_t(const frame_buffer_object_t&) = delete;
 
     [[nodiscard]] constexpr frame_buffer_object_t(frame_buffer_object_t&& other) noexcept
-        : m_frame_buffer_object(other.m_frame_buffer_object), m_texture_object(other.m_frame_buffer_object), m_moved(false) {
+        : m_frame_buffer_object(other.m_frame_buffer_object), m_texture_object(other.m_texture_object),
+          m_multisample_frame_buffer_object(other.m_multisample_frame_buffer_object),
+          m_multisample_render_buffer_object(other.m_multisample_render_buffer_object),
+          m_size(other.m_size),
+          m_viewport_size(other.m_viewport_size),
+          m_samples(other.m_samples),
+          m_format(other.m_format),
+          m_moved(other.m_moved) {
         other.m_moved = true;
     }
 
@@ -31,6 +64,8 @@ public:
         if (!m_moved) {
             glDeleteFramebuffers(1, &m_frame_buffer_object);
             glDeleteTextures(1, &m_texture_object);
+            glDeleteFramebuffers(1, &m_multisample_frame_buffer_object);
+            glDeleteRenderbuffers(1, &m_multisample_render_buffer_object);
         }
     }
 
@@ -38,15 +73,102 @@ public:
         return m_texture_object;
     }
 
+    [[nodiscard]] constexpr const glm::ivec2& size() const noexcept {
+        return m_size;
+    }
+
+    [[nodiscard]] constexpr const glm::ivec2& viewport_size() const noexcept {
+        return m_viewport_size;
+    }
+
+    // Scale from [0, 1] texture coordinates to the viewport.
+    [[nodiscard]] constexpr glm::vec2 uv_scale() const noexcept {
+        return glm::vec2(m_viewport_size) / glm::vec2(m_size);
+    }
+
+    [[nodiscard]] constexpr int samples() const noexcept {
+        return m_samples;
+    }
+
+    [[nodiscard]] constexpr GLenum format() const noexcept {
+        return m_format;
+    }
+
+    // Binds the frame buffer for rendering and sets the viewport.
+    // This is the multisampled frame buffer when samples > 1.
     void bind() const noexcept;
 
     void unbind() const noexcept;
 
-    void set_size(const glm::ivec2& size) const noexcept;
+    // Reallocates the texture. The viewport is reset to cover all of it.
+    void set_size(const glm::ivec2& size, int samples = 1) noexcept;
+
+    // Must fit within size().
+    void set_viewport_size(const glm::ivec2& viewport_size) noexcept;
+
+    // Resolves the multisampled frame buffer into the texture. Does nothing for single sampled frame buffers.
+    void resolve() const noexcept;
 
     void bind_texture() const noexcept;
 
-    [[nodiscard]] static frame_buffer_object_t create(const glm::ivec2& texture_size) noexcept;
+    [[nodiscard]] static frame_buffer_object_t create(const glm::ivec2& texture_size,
+                                                      GLint filter = GL_NEAREST,
+                                                      int samples = 1,
+                                                      GLenum format = GL_RGBA8) noexcept;
+};
+
+using render_target_handle_t = std::size_t;
+
+// Owns all render targets and hands them out by format and size bucket.
+// Targets only ever grow. Asking for a smaller size just shrinks the viewport within the existing texture,
+// so resizing the window does not reallocate textures unless it grows past the bucket.
+class [[nodiscard]] render_target_pool_t {
+    // Sizes are rounded up to a multiple of a power of two of at most an eighth of the size, and at most this. Small
+    // targets such as the last bloom mips stay close to their real size.
+    static constexpr int bucket_granularity = 256;
+
+    struct slot_t {
+        frame_buffer_object_t m_target;
+        GLint m_filter;
+        bool m_in_use;
+    };
+
+    std::vector<slot_t> m_slots;
+    std::size_t m_allocation_count = 0;
+
+public:
+    render_target_pool_t() = default;
+
+    render_target_pool_t(const render_target_pool_t&) = delete;
+
+    render_target_pool_t(render_target_pool_t&&) noexcept = default;
+
+    [[nodiscard]] static glm::ivec2 bucket_size(const glm::ivec2& size) noexcept;
+
+    // Reuses a released target with the same format that is large enough, or allocates a new one.
+    [[nodiscard]] render_target_handle_t acquire(const glm::ivec2& size,
+                                                 GLint filter,
+                                                 int samples = 1,
+                                                 GLenum format = GL_RGBA8) noexcept;
+
+    void release(render_target_handle_t handle) noexcept;
+
+    // Sets the viewport of the target to size. Only reallocates if the target is too small
+    // or the sample count changes.
+    void resize(render_target_handle_t handle, const glm::ivec2& size, int samples = 1) noexcept;
+
+    [[nodiscard]] frame_buffer_object_t& operator[](render_target_handle_t handle) noexcept {
+        return m_slots[handle].m_target;
+    }
+
+    [[nodiscard]] const frame_buffer_object_t& operator[](render_target_handle_t handle) const noexcept {
+        return m_slots[handle].m_target;
+    }
+
+    // Number of texture allocations made through the pool since it was created.
+    [[nodiscard]] constexpr std::size_t allocation_count() const noexcept { return m_allocation_count; }
+
+    [[nodiscard]] std::size_t allocated_bytes() const noexcept;
 };
 }
 
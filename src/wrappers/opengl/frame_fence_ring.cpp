@@ -0,0 +1,64 @@
+#include "frame_fence_ring.hpp"
+
+#include <iostream>
+
+gl::frame_fence_ring_t::~frame_fence_ring_t() noexcept {
+    if (!m_moved) {
+        for (auto fence : m_fences) {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+            }
+        }
+    }
+}
+
+void gl::frame_fence_ring_t::insert(std::uint64_t frame) noexcept {
+    if (m_pending == max_frames_in_flight) {
+        retire(max_frames_in_flight - 1);
+    }
+
+    const auto index = (m_oldest + m_pending) % max_frames_in_flight;
+    m_fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_frames[index] = frame;
+    m_pending++;
+}
+
+std::optional<std::uint64_t> gl::frame_fence_ring_t::retire(int max_pending) noexcept {
+    // A frame that takes longer than this is reported as a stall and no longer waited for, its fence is dropped so the
+    // ring keeps moving. It is not retired, since the GPU has not finished it.
+    constexpr GLuint64 wait_timeout = 1'000'000'000;
+    constexpr int wait_attempts = 10;
+
+    std::optional<std::uint64_t> retired;
+    while (m_pending > 0) {
+        const auto wait = m_pending > max_pending;
+        const auto fence = m_fences[m_oldest];
+        // The flush makes sure the fence reaches the GPU, waiting on it would never return otherwise.
+        auto result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? wait_timeout : 0);
+        for (auto attempt = 1; wait && result == GL_TIMEOUT_EXPIRED && attempt < wait_attempts; attempt++) {
+            result = glClientWaitSync(fence, 0, wait_timeout);
+        }
+        const auto finished = result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+        if (!finished && !wait) {
+            break;
+        }
+        if (!finished) {
+            std::cerr << "The GPU has not finished frame " << m_frames[m_oldest] << " after " << wait_attempts
+                      << " s, no longer waiting for it" << std::endl;
+        }
+
+        glDeleteSync(fence);
+        m_fences[m_oldest] = nullptr;
+        if (finished) {
+            retired = m_frames[m_oldest];
+        }
+        m_oldest = (m_oldest + 1) % max_frames_in_flight;
+        m_pending--;
+    }
+
+    return retired;
+}
+
+gl::frame_fence_ring_t gl::frame_fence_ring_t::create() noexcept {
+    return frame_fence_ring_t{};
+}
@@ -0,0 +1,57 @@
+#ifndef FRAME_FENCE_RING_HPP
+#define FRAME_FENCE_RING_HPP
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace gl {
+// A fence after every swap, so the CPU knows which frames the GPU has finished and can keep the driver from queueing
+// more than a few of them.
+class [[nodiscard]] frame_fence_ring_t {
+public:
+    static constexpr int max_frames_in_flight = 8;
+
+private:
+    std::array<GLsync, max_frames_in_flight> m_fences;
+    std::array<std::uint64_t, max_frames_in_flight> m_frames;
+    // Oldest frame still in flight, and the number of them.
+    int m_oldest;
+    int m_pending;
+    bool m_moved;
+
+    [[nodiscard]] frame_fence_ring_t() noexcept
+        : m_fences{}, m_frames{}, m_oldest(0), m_pending(0), m_moved(false) {
+    }
+
+public:
+    frame_fence_ring_t(const frame_fence_ring_t&) = delete;
+
+    [[nodiscard]] frame_fence_ring_t(frame_fence_ring_t&& other) noexcept
+        : m_fences(other.m_fences),
+          m_frames(other.m_frames),
+          m_oldest(other.m_oldest),
+          m_pending(other.m_pending),
+          m_moved(false) {
+        other.m_moved = true;
+    }
+
+    ~frame_fence_ring_t() noexcept;
+
+    [[nodiscard]] constexpr int pending() const noexcept { return m_pending; }
+
+    // Fences everything queued so far, right after the swap of frame. Waits for the oldest frame when all
+    // max_frames_in_flight are still pending.
+    void insert(std::uint64_t frame) noexcept;
+
+    // Retires the frames the GPU has finished, first waiting until no more than max_pending are left in flight.
+    // Returns the newest frame that was retired, if any. A frame the GPU stalls on is reported and dropped.
+    std::optional<std::uint64_t> retire(int max_pending) noexcept;
+
+    [[nodiscard]] static frame_fence_ring_t create() noexcept;
+};
+}
+
+#endif //FRAME_FENCE_RING_HPP
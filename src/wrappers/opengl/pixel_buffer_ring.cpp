@@ -0,0 +1,92 @@
+#include "pixel_buffer_ring.hpp"
+
+#include <cstddef>
+#include <iostream>
+
+gl::pixel_buffer_ring_t::~pixel_buffer_ring_t() noexcept {
+    if (!m_moved) {
+        for (auto fence : m_fences) {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+            }
+        }
+        glDeleteBuffers(buffers_in_flight, m_buffer_objects.data());
+    }
+}
+
+void gl::pixel_buffer_ring_t::read_back_buffer() noexcept {
+    const auto index = (m_oldest + m_pending) % buffers_in_flight;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // With a pack buffer bound the read is queued instead of being waited for.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer_objects[index]);
+    glReadPixels(0, 0, m_size.x, m_size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_pending++;
+}
+
+std::optional<std::span<const std::uint8_t>> gl::pixel_buffer_ring_t::try_map_next(bool wait) noexcept {
+    if (m_mapped == m_pending) {
+        return std::nullopt;
+    }
+    const auto index = (m_oldest + m_mapped) % buffers_in_flight;
+
+    // A read that takes longer than this is reported as a stall. The buffer stays pending and can be mapped later.
+    constexpr GLuint64 wait_timeout = 1'000'000'000;
+    constexpr int wait_attempts = 10;
+
+    const auto fence = m_fences[index];
+    auto result = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? wait_timeout : 0);
+    for (auto attempt = 1; wait && result == GL_TIMEOUT_EXPIRED && attempt < wait_attempts; attempt++) {
+        result = glClientWaitSync(fence, 0, wait_timeout);
+    }
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        if (wait) {
+            std::cerr << "A read back has not finished after " << wait_attempts << " s" << std::endl;
+        }
+        return std::nullopt;
+    }
+
+    const auto byte_count = static_cast<std::size_t>(m_size.x) * static_cast<std::size_t>(m_size.y) * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer_objects[index]);
+    const auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(byte_count), GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+
+    m_mapped++;
+    return std::span<const std::uint8_t>(static_cast<const std::uint8_t*>(data), byte_count);
+}
+
+void gl::pixel_buffer_ring_t::unmap_oldest() noexcept {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer_objects[m_oldest]);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glDeleteSync(m_fences[m_oldest]);
+    m_fences[m_oldest] = nullptr;
+    m_oldest = (m_oldest + 1) % buffers_in_flight;
+    m_pending--;
+    m_mapped--;
+}
+
+gl::pixel_buffer_ring_t gl::pixel_buffer_ring_t::create(const glm::ivec2& size) noexcept {
+    std::array<GLuint, buffers_in_flight> buffer_objects;
+    glGenBuffers(buffers_in_flight, buffer_objects.data());
+
+    const auto byte_count = static_cast<GLsizeiptr>(size.x) * size.y * 4;
+    for (auto buffer_object : buffer_objects) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_object);
+        glBufferData(GL_PIXEL_PACK_BUFFER, byte_count, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return pixel_buffer_ring_t{buffer_objects, size};
+}
@@ -0,0 +1,73 @@
+#ifndef PIXEL_BUFFER_RING_HPP
+#define PIXEL_BUFFER_RING_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace gl {
+// Reads the frame buffer into a ring of pixel pack buffers. The read is queued on the GPU,
+// and a buffer is only mapped a few frames later once its fence has signaled, so the CPU never waits for it.
+// Mapped buffers stay mapped until they are released, so another thread can read them while the ring keeps going.
+class [[nodiscard]] pixel_buffer_ring_t {
+public:
+    static constexpr int buffers_in_flight = 3;
+
+private:
+    std::array<GLuint, buffers_in_flight> m_buffer_objects;
+    std::array<GLsync, buffers_in_flight> m_fences;
+    glm::ivec2 m_size;
+    // Oldest buffer with a read in flight, the number of them, and how many of those, from the oldest on, are mapped.
+    int m_oldest;
+    int m_pending;
+    int m_mapped;
+    bool m_moved;
+
+    [[nodiscard]] pixel_buffer_ring_t(const std::array<GLuint, buffers_in_flight>& buffer_objects,
+                                      const glm::ivec2& size) noexcept
+        : m_buffer_objects(buffer_objects), m_fences{}, m_size(size), m_oldest(0), m_pending(0), m_mapped(0), m_moved(false) {
+    }
+
+public:
+    pixel_buffer_ring_t() = delete;
+
+    pixel_buffer_ring_t(const pixel_buffer_ring_t&) = delete;
+
+    [[nodiscard]] pixel_buffer_ring_t(pixel_buffer_ring_t&& other) noexcept
+        : m_buffer_objects(other.m_buffer_objects),
+          m_fences(other.m_fences),
+          m_size(other.m_size),
+          m_oldest(other.m_oldest),
+          m_pending(other.m_pending),
+          m_mapped(other.m_mapped),
+          m_moved(false) {
+        other.m_moved = true;
+    }
+
+    ~pixel_buffer_ring_t() noexcept;
+
+    [[nodiscard]] constexpr bool full() const noexcept { return m_pending == buffers_in_flight; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return m_pending == 0; }
+    [[nodiscard]] constexpr int pending() const noexcept { return m_pending; }
+    [[nodiscard]] constexpr int mapped() const noexcept { return m_mapped; }
+    [[nodiscard]] constexpr const glm::ivec2& size() const noexcept { return m_size; }
+
+    // Queues a read of the lower left size() pixels of the default back buffer as RGBA8. The ring must not be full.
+    void read_back_buffer() noexcept;
+
+    // Maps the oldest buffer that is not mapped yet if its read has finished, or after waiting for it if wait is set.
+    // Rows are bottom to top. The pixels stay valid until unmap_oldest() releases the buffer.
+    [[nodiscard]] std::optional<std::span<const std::uint8_t>> try_map_next(bool wait) noexcept;
+
+    // Releases the oldest mapped buffer for another read.
+    void unmap_oldest() noexcept;
+
+    [[nodiscard]] static pixel_buffer_ring_t create(const glm::ivec2& size) noexcept;
+};
+}
+
+#endif //PIXEL_BUFFER_RING_HPP
@@ -0,0 +1,51 @@
+#include "primitive_query.hpp"
+
+gl::primitive_counter_t::~primitive_counter_t() noexcept {
+    if (!m_moved) {
+        glDeleteQueries(queries_in_flight, m_queries.data());
+    }
+}
+
+void gl::primitive_counter_t::begin() noexcept {
+    glBeginQuery(GL_PRIMITIVES_GENERATED, m_queries[m_index]);
+}
+
+void gl::primitive_counter_t::end() noexcept {
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    m_pending[m_index] = true;
+    m_index = (m_index + 1) % queries_in_flight;
+}
+
+std::optional<std::uint64_t> gl::primitive_counter_t::try_read() noexcept {
+    std::optional<std::uint64_t> result;
+
+    // Walk from the oldest to the newest count so the newest available one wins.
+    for (auto i = 0; i < queries_in_flight; i++) {
+        const auto index = (m_index + i) % queries_in_flight;
+        if (!m_pending[index]) {
+            continue;
+        }
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available != GL_TRUE) {
+            // Queries finish in order, so nothing newer is available either.
+            break;
+        }
+
+        GLuint64 primitives;
+        glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &primitives);
+        m_pending[index] = false;
+
+        result = primitives;
+    }
+
+    return result;
+}
+
+gl::primitive_counter_t gl::primitive_counter_t::create() noexcept {
+    std::array<GLuint, queries_in_flight> queries;
+    glGenQueries(queries_in_flight, queries.data());
+
+    return primitive_counter_t{queries};
+}
@@ -0,0 +1,48 @@
+#ifndef PRIMITIVE_QUERY_HPP
+#define PRIMITIVE_QUERY_HPP
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace gl {
+// Counts the primitives generated between begin() and end() with GL_PRIMITIVES_GENERATED queries.
+// Like gpu_timer_t, several counts are kept in flight so reading a result never stalls the pipeline.
+class [[nodiscard]] primitive_counter_t {
+    static constexpr int queries_in_flight = 4;
+
+    std::array<GLuint, queries_in_flight> m_queries;
+    std::array<bool, queries_in_flight> m_pending;
+    int m_index;
+    bool m_moved;
+
+    [[nodiscard]] explicit primitive_counter_t(const std::array<GLuint, queries_in_flight>& queries) noexcept
+        : m_queries(queries), m_pending{}, m_index(0), m_moved(false) {
+    }
+
+public:
+    primitive_counter_t() = delete;
+
+    primitive_counter_t(const primitive_counter_t&) = delete;
+
+    [[nodiscard]] primitive_counter_t(primitive_counter_t&& other) noexcept
+        : m_queries(other.m_queries), m_pending(other.m_pending), m_index(other.m_index), m_moved(false) {
+        other.m_moved = true;
+    }
+
+    ~primitive_counter_t() noexcept;
+
+    void begin() noexcept;
+
+    void end() noexcept;
+
+    // Returns the most recent finished count, if one has become available.
+    [[nodiscard]] std::optional<std::uint64_t> try_read() noexcept;
+
+    [[nodiscard]] static primitive_counter_t create() noexcept;
+};
+}
+
+#endif //PRIMITIVE_QUERY_HPP
@@ -3,6 +3,7 @@
 //
 
 #include "shader.hpp"
+#include "../../trace.hpp"
 
 #include <vector>
 #include <cstdio>
@@ -26,6 +27,7 @@ void gl::shader_source(GLuint shader, std::string_view source) noexcept {
 }
 
 void gl::compile_shader(GLuint shader) noexcept {
+    TRACE_ZONE("gl::compile_shader");
     glCompileShader(shader);
 
     GLint status = GL_FALSE;
@@ -59,6 +59,7 @@ public:
 
 using vertex_shader_t = shader_t<GL_VERTEX_SHADER>;
 using fragment_shader_t = shader_t<GL_FRAGMENT_SHADER>;
+using compute_shader_t = shader_t<GL_COMPUTE_SHADER>;
 }
 
 
@@ -0,0 +1,88 @@
+// IWYU pragma: private, include "shader_bindings.hpp"
+
+#ifndef SHADER_BINDING_HPP
+#define SHADER_BINDING_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "attribute_buffer_object.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+// The types the resource embedder describes the interface of every shader with, see shader_bindings.hpp.
+namespace gl {
+// A vertex attribute at the location the resource embedder gave it.
+template<typename TValue, GLint Size, GLenum Type, bool Instanced>
+struct attribute_binding_t {
+    GLint m_location;
+
+    // Per-instance data is rebuilt every frame.
+    using buffer_object_t = attribute_buffer_object_t<TValue, GL_ARRAY_BUFFER, Size, Type, Instanced,
+                                                      Instanced ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW>;
+
+    [[nodiscard]] constexpr attribute_location_t location() const noexcept { return attribute_location_t(m_location); }
+};
+
+// A sampler bound to a texture unit by the shader itself.
+struct sampler_binding_t {
+    GLint m_unit;
+
+    [[nodiscard]] constexpr GLenum texture_unit() const noexcept { return GL_TEXTURE0 + m_unit; }
+};
+
+// A uniform block at a binding point shared by every shader that declares it.
+struct uniform_block_binding_t {
+    GLuint m_binding;
+};
+
+// A shader storage block at a binding point of the shader that declares it.
+struct storage_block_binding_t {
+    GLuint m_binding;
+};
+
+// The type the GL reports for a uniform that is set with TValue.
+template<typename TValue>
+constexpr GLenum uniform_type = GL_NONE;
+template<>
+constexpr GLenum uniform_type<GLfloat> = GL_FLOAT;
+template<>
+constexpr GLenum uniform_type<glm::vec2> = GL_FLOAT_VEC2;
+template<>
+constexpr GLenum uniform_type<glm::vec3> = GL_FLOAT_VEC3;
+template<>
+constexpr GLenum uniform_type<glm::vec4> = GL_FLOAT_VEC4;
+template<>
+constexpr GLenum uniform_type<glm::mat4> = GL_FLOAT_MAT4;
+template<>
+constexpr GLenum uniform_type<GLint> = GL_INT;
+template<>
+constexpr GLenum uniform_type<GLuint> = GL_UNSIGNED_INT;
+
+// A uniform and the type it is set with.
+template<typename TValue>
+struct uniform_binding_t {
+    static_assert(uniform_type<TValue> != GL_NONE, "unsupported uniform type");
+
+    const char* m_name;
+};
+
+// An in or out passed between shader stages.
+struct varying_t {
+    std::string_view m_name;
+    std::string_view m_type;
+
+    constexpr bool operator==(const varying_t&) const = default;
+};
+
+// Whether every input of the fragment shader is written by the vertex shader with the same type.
+template<typename TVertexShader, typename TFragmentShader>
+[[nodiscard]] consteval bool interfaces_match() {
+    return std::ranges::all_of(TFragmentShader::inputs, [](const varying_t& input) {
+        return std::ranges::find(TVertexShader::outputs, input) != TVertexShader::outputs.end();
+    });
+}
+}
+
+#endif //SHADER_BINDING_HPP
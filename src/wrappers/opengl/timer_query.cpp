@@ -0,0 +1,65 @@
+#include "timer_query.hpp"
+
+gl::gpu_timer_t::~gpu_timer_t() noexcept {
+    if (!m_moved) {
+        glDeleteQueries(queries_in_flight, m_begin_queries.data());
+        glDeleteQueries(queries_in_flight, m_end_queries.data());
+    }
+}
+
+void gl::gpu_timer_t::begin(int tag) noexcept {
+    glQueryCounter(m_begin_queries[m_index], GL_TIMESTAMP);
+    m_tags[m_index] = tag;
+}
+
+void gl::gpu_timer_t::end() noexcept {
+    glQueryCounter(m_end_queries[m_index], GL_TIMESTAMP);
+    m_pending[m_index] = true;
+    m_index = (m_index + 1) % queries_in_flight;
+}
+
+std::optional<float> gl::gpu_timer_t::try_read() noexcept {
+    if (const auto time = try_read_tagged()) {
+        return time->m_milliseconds;
+    }
+    return std::nullopt;
+}
+
+std::optional<gl::gpu_time_t> gl::gpu_timer_t::try_read_tagged() noexcept {
+    std::optional<gpu_time_t> result;
+
+    // Walk from the oldest to the newest measurement so the newest available one wins.
+    for (auto i = 0; i < queries_in_flight; i++) {
+        const auto index = (m_index + i) % queries_in_flight;
+        if (!m_pending[index]) {
+            continue;
+        }
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(m_end_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available != GL_TRUE) {
+            // Queries finish in order, so nothing newer is available either.
+            break;
+        }
+
+        GLuint64 begin_time;
+        GLuint64 end_time;
+        glGetQueryObjectui64v(m_begin_queries[index], GL_QUERY_RESULT, &begin_time);
+        glGetQueryObjectui64v(m_end_queries[index], GL_QUERY_RESULT, &end_time);
+        m_pending[index] = false;
+
+        result = gpu_time_t{static_cast<float>(static_cast<double>(end_time - begin_time) / 1'000'000.0),
+                            m_tags[index]};
+    }
+
+    return result;
+}
+
+gl::gpu_timer_t gl::gpu_timer_t::create() noexcept {
+    std::array<GLuint, queries_in_flight> begin_queries;
+    std::array<GLuint, queries_in_flight> end_queries;
+    glGenQueries(queries_in_flight, begin_queries.data());
+    glGenQueries(queries_in_flight, end_queries.data());
+
+    return gpu_timer_t{begin_queries, end_queries};
+}
@@ -0,0 +1,64 @@
+#ifndef TIMER_QUERY_HPP
+#define TIMER_QUERY_HPP
+
+#include <GL/glew.h>
+
+#include <array>
+#include <optional>
+
+namespace gl {
+// Measures GPU time between begin() and end() with timestamp queries.
+// Several measurements are kept in flight so reading a result never stalls the pipeline.
+// Each measurement carries the tag it was begun with, so a late result can be told apart from the current setting.
+struct gpu_time_t {
+    float m_milliseconds;
+    int m_tag;
+};
+
+class [[nodiscard]] gpu_timer_t {
+    static constexpr int queries_in_flight = 4;
+
+    std::array<GLuint, queries_in_flight> m_begin_queries;
+    std::array<GLuint, queries_in_flight> m_end_queries;
+    std::array<bool, queries_in_flight> m_pending;
+    std::array<int, queries_in_flight> m_tags;
+    int m_index;
+    bool m_moved;
+
+    [[nodiscard]] gpu_timer_t(const std::array<GLuint, queries_in_flight>& begin_queries,
+                              const std::array<GLuint, queries_in_flight>& end_queries) noexcept
+        : m_begin_queries(begin_queries), m_end_queries(end_queries), m_pending{}, m_tags{}, m_index(0), m_moved(false) {
+    }
+
+public:
+    gpu_timer_t() = delete;
+
+    gpu_timer_t(const gpu_timer_t&) = delete;
+
+    [[nodiscard]] gpu_timer_t(gpu_timer_t&& other) noexcept
+        : m_begin_queries(other.m_begin_queries),
+          m_end_queries(other.m_end_queries),
+          m_pending(other.m_pending),
+          m_tags(other.m_tags),
+          m_index(other.m_index),
+          m_moved(false) {
+        other.m_moved = true;
+    }
+
+    ~gpu_timer_t() noexcept;
+
+    void begin(int tag = 0) noexcept;
+
+    void end() noexcept;
+
+    // Returns the most recent finished measurement in milliseconds, if one has become available.
+    [[nodiscard]] std::optional<float> try_read() noexcept;
+
+    // Like try_read(), along with the tag the measurement was begun with.
+    [[nodiscard]] std::optional<gpu_time_t> try_read_tagged() noexcept;
+
+    [[nodiscard]] static gpu_timer_t create() noexcept;
+};
+}
+
+#endif //TIMER_QUERY_HPP
@@ -0,0 +1,70 @@
+#ifndef UNIFORM_BUFFER_OBJECT_HPP
+#define UNIFORM_BUFFER_OBJECT_HPP
+
+#include <GL/glew.h>
+
+#include "shader_binding.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+namespace gl {
+// A uniform block's worth of TValue, bound to its binding point for as long as it lives.
+// TValue has to be laid out the way std140 lays out the block.
+template<typename TValue>
+class [[nodiscard]] uniform_buffer_object_t {
+    static_assert(std::is_trivially_copyable_v<TValue>);
+    static_assert(sizeof(TValue) % 16 == 0, "std140 rounds blocks up to a multiple of 16 bytes");
+
+    GLuint m_buffer_object;
+    // What the buffer holds, so unchanged values are not uploaded again.
+    TValue m_value;
+    bool m_moved;
+
+    [[nodiscard]] explicit uniform_buffer_object_t(GLuint buffer_object, const TValue& value) noexcept
+        : m_buffer_object(buffer_object), m_value(value), m_moved(false) {
+    }
+
+public:
+    uniform_buffer_object_t() = delete;
+
+    uniform_buffer_object_t(const uniform_buffer_object_t&) = delete;
+
+    [[nodiscard]] uniform_buffer_object_t(uniform_buffer_object_t&& other) noexcept
+        : m_buffer_object(other.m_buffer_object), m_value(other.m_value), m_moved(false) {
+        other.m_moved = true;
+    }
+
+    ~uniform_buffer_object_t() noexcept {
+        if (!m_moved) {
+            std::cerr << "Deleted uniform buffer object" << std::endl;
+            glDeleteBuffers(1, &m_buffer_object);
+        }
+    }
+
+    // Uploads the value if it differs from what the buffer holds.
+    void update(const TValue& value) noexcept {
+        if (std::memcmp(&value, &m_value, sizeof(TValue)) == 0) {
+            return;
+        }
+
+        m_value = value;
+        glBindBuffer(GL_UNIFORM_BUFFER, m_buffer_object);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(TValue), &m_value);
+    }
+
+    [[nodiscard]] static uniform_buffer_object_t create(uniform_block_binding_t block,
+                                                        const TValue& value = {}) noexcept {
+        GLuint buffer_object;
+        glGenBuffers(1, &buffer_object);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer_object);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(TValue), &value, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, block.m_binding, buffer_object);
+
+        return uniform_buffer_object_t(buffer_object, value);
+    }
+};
+}
+
+#endif //UNIFORM_BUFFER_OBJECT_HPP
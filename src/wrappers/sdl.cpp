@@ -3,11 +3,14 @@
 //
 
 #include "sdl.hpp"
+#include "../trace.hpp"
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <cstdint>
 
 #if !defined(__PRETTY_FUNCTION__) && !defined(__GNUC__)
 #define __PRETTY_FUNCTION__ __FUNCSIG__
@@ -33,11 +36,13 @@
 
 
 void sdl::init_sub_system(Uint32 flags) noexcept {
+    TRACE_ZONE("sdl::init_sub_system");
     auto result = SDL_InitSubSystem(flags);
     SDL_QUIT_IF_ERROR(result);
 }
 
 sdl::window_t sdl::create_window(const char* title, int x, int y, int w, int h, Uint32 flags) noexcept {
+    TRACE_ZONE("sdl::create_window");
     auto window = SDL_CreateWindow(title, x, y, w, h, flags);
 
     if (window == nullptr) {
@@ -48,6 +53,7 @@ sdl::window_t sdl::create_window(const char* title, int x, int y, int w, int h,
 }
 
 sdl::window_surface_t sdl::get_window_surface(const window_t& window) noexcept {
+    TRACE_ZONE("sdl::get_window_surface");
     auto window_surface = SDL_GetWindowSurface(window.get());
 
     if (window_surface == nullptr) {
@@ -58,28 +64,49 @@ sdl::window_surface_t sdl::get_window_surface(const window_t& window) noexcept {
 }
 
 void sdl::update_window_surface(const window_t& window) noexcept {
+    TRACE_ZONE("sdl::update_window_surface");
     auto result = SDL_UpdateWindowSurface(window.get());
     SDL_QUIT_IF_ERROR(result);
 }
 
 sdl::pool_event_result sdl::pool_event() noexcept {
+    TRACE_ZONE("sdl::pool_event");
     SDL_Event event;
     auto result = SDL_PollEvent(&event);
 
     return pool_event_result{!!result, event};
 }
 
+void sdl::pump_events() noexcept {
+    TRACE_ZONE("sdl::pump_events");
+    SDL_PumpEvents();
+}
+
+std::size_t sdl::peep_events(std::span<SDL_Event> events) noexcept {
+    TRACE_ZONE("sdl::peep_events");
+    auto result = SDL_PeepEvents(events.data(), static_cast<int>(events.size()), SDL_GETEVENT, SDL_FIRSTEVENT,
+                                 SDL_LASTEVENT);
+    if (result < 0) {
+        SDL_QUIT_WITH_ERROR();
+    }
+
+    return static_cast<std::size_t>(result);
+}
+
 void sdl::fill_rect(window_surface_t surface, const SDL_Rect& rect, Uint32 color) noexcept {
+    TRACE_ZONE("sdl::fill_rect");
     auto result = SDL_FillRect(surface, &rect, color);
     SDL_QUIT_IF_ERROR(result);
 }
 
 void sdl::gl_set_attribute(SDL_GLattr attribute, int value) noexcept {
+    TRACE_ZONE("sdl::gl_set_attribute");
     auto result = SDL_GL_SetAttribute(attribute, value);
     SDL_QUIT_IF_ERROR(result);
 }
 
 sdl::opengl_context_t sdl::gl_create_context(const window_t& window) noexcept {
+    TRACE_ZONE("sdl::gl_create_context");
     auto gl_context = SDL_GL_CreateContext(window.get());
 
     if (gl_context == nullptr) {
@@ -90,6 +117,7 @@ sdl::opengl_context_t sdl::gl_create_context(const window_t& window) noexcept {
 }
 
 void sdl::gl_try_use_vsync() noexcept {
+    TRACE_ZONE("sdl::gl_try_use_vsync");
     auto result = SDL_GL_SetSwapInterval(-1);
     if (result == 0) {
         return;
@@ -103,10 +131,189 @@ void sdl::gl_try_use_vsync() noexcept {
     std::cerr << "Could not set vsync\n";
 }
 
+void sdl::gl_disable_vsync() noexcept {
+    TRACE_ZONE("sdl::gl_disable_vsync");
+    if (SDL_GL_SetSwapInterval(0) != 0) {
+        std::cerr << "Could not disable vsync\n";
+    }
+}
+
 void sdl::gl_swap_window(const window_t& window) noexcept {
+    TRACE_ZONE("sdl::gl_swap_window");
     SDL_GL_SwapWindow(window.get());
 }
 
+namespace {
+// The EGL and GLX entry points are looked up at run time, so neither has to be linked or even present.
+// Only the few types and enums that are needed are declared here.
+using egl_display_t = void*;
+using egl_surface_t = void*;
+using egl_int_t = std::int32_t;
+using egl_boolean_t = unsigned int;
+
+constexpr egl_int_t egl_draw = 0x3059;
+constexpr egl_int_t egl_extensions = 0x3055;
+constexpr egl_int_t egl_buffer_age_ext = 0x313D;
+
+using glx_display_t = void*;
+using glx_drawable_t = unsigned long;
+
+constexpr int glx_back_buffer_age_ext = 0x20F4;
+
+struct swap_extensions_t {
+    egl_display_t m_egl_display = nullptr;
+    egl_surface_t (*m_egl_get_current_surface)(egl_int_t) = nullptr;
+    egl_boolean_t (*m_egl_query_surface)(egl_display_t, egl_surface_t, egl_int_t, egl_int_t*) = nullptr;
+    egl_boolean_t (*m_egl_swap_buffers_with_damage)(egl_display_t, egl_surface_t, const egl_int_t*, egl_int_t) = nullptr;
+
+    glx_display_t m_glx_display = nullptr;
+    glx_drawable_t (*m_glx_get_current_drawable)() = nullptr;
+    void (*m_glx_query_drawable)(glx_display_t, glx_drawable_t, int, unsigned int*) = nullptr;
+};
+
+bool has_extension(const char* extensions, std::string_view name) {
+    if (extensions == nullptr) {
+        return false;
+    }
+
+    std::string_view remaining = extensions;
+    while (!remaining.empty()) {
+        const auto end = remaining.find(' ');
+        if (remaining.substr(0, end) == name) {
+            return true;
+        }
+        remaining = end == std::string_view::npos ? std::string_view() : remaining.substr(end + 1);
+    }
+    return false;
+}
+
+template<typename TFunction>
+TFunction get_proc_address(const char* name) {
+    return reinterpret_cast<TFunction>(SDL_GL_GetProcAddress(name));
+}
+
+// Looked up once, for the context that is current on the first call.
+const swap_extensions_t& swap_extensions() noexcept {
+    static const auto extensions = [] {
+        swap_extensions_t result;
+#ifndef _WIN32
+        // EGL first. Under GLX, SDL asks glXGetProcAddress, which knows no egl functions.
+        const auto egl_get_current_display = get_proc_address<egl_display_t (*)()>("eglGetCurrentDisplay");
+        const auto egl_query_string = get_proc_address<const char* (*)(egl_display_t, egl_int_t)>("eglQueryString");
+        const auto egl_display = egl_get_current_display != nullptr ? egl_get_current_display() : nullptr;
+        const auto video_driver = SDL_GetCurrentVideoDriver();
+        const auto x11 = video_driver != nullptr && video_driver == std::string_view("x11");
+
+        if (egl_display != nullptr && egl_query_string != nullptr) {
+            const auto egl_extensions_string = egl_query_string(egl_display, egl_extensions);
+            result.m_egl_display = egl_display;
+            result.m_egl_get_current_surface = get_proc_address<decltype(result.m_egl_get_current_surface)>(
+                    "eglGetCurrentSurface");
+
+            if (has_extension(egl_extensions_string, "EGL_EXT_buffer_age")) {
+                result.m_egl_query_surface = get_proc_address<decltype(result.m_egl_query_surface)>(
+                        "eglQuerySurface");
+            }
+
+            // The other video drivers pace or flip the frames themselves in SDL_GL_SwapWindow, which must not be
+            // bypassed there.
+            if (x11 && has_extension(egl_extensions_string, "EGL_KHR_swap_buffers_with_damage")) {
+                result.m_egl_swap_buffers_with_damage =
+                        get_proc_address<decltype(result.m_egl_swap_buffers_with_damage)>(
+                                "eglSwapBuffersWithDamageKHR");
+            }
+            return result;
+        }
+
+        if (!x11) {
+            return result;
+        }
+
+        const auto glx_get_current_display = get_proc_address<glx_display_t (*)()>("glXGetCurrentDisplay");
+        const auto glx_query_extensions_string = get_proc_address<const char* (*)(glx_display_t, int)>(
+                "glXQueryExtensionsString");
+        if (glx_get_current_display != nullptr && glx_query_extensions_string != nullptr) {
+            const auto display = glx_get_current_display();
+            if (display && has_extension(glx_query_extensions_string(display, 0), "GLX_EXT_buffer_age")) {
+                result.m_glx_display = display;
+                result.m_glx_get_current_drawable = get_proc_address<decltype(result.m_glx_get_current_drawable)>(
+                        "glXGetCurrentDrawable");
+                result.m_glx_query_drawable = get_proc_address<decltype(result.m_glx_query_drawable)>(
+                        "glXQueryDrawable");
+            }
+        }
+#endif
+        return result;
+    }();
+
+    return extensions;
+}
+}
+
+int sdl::gl_back_buffer_age() noexcept {
+    TRACE_ZONE("sdl::gl_back_buffer_age");
+    const auto& extensions = swap_extensions();
+
+    if (extensions.m_egl_query_surface != nullptr && extensions.m_egl_get_current_surface != nullptr) {
+        egl_int_t age = 0;
+        if (extensions.m_egl_query_surface(extensions.m_egl_display, extensions.m_egl_get_current_surface(egl_draw),
+                                           egl_buffer_age_ext, &age)) {
+            return age;
+        }
+        return 0;
+    }
+
+    if (extensions.m_glx_query_drawable != nullptr && extensions.m_glx_get_current_drawable != nullptr) {
+        unsigned int age = 0;
+        extensions.m_glx_query_drawable(extensions.m_glx_display, extensions.m_glx_get_current_drawable(),
+                                        glx_back_buffer_age_ext, &age);
+        return static_cast<int>(age);
+    }
+
+    return 0;
+}
+
+bool sdl::gl_supports_swap_with_damage() noexcept {
+    TRACE_ZONE("sdl::gl_supports_swap_with_damage");
+    return swap_extensions().m_egl_swap_buffers_with_damage != nullptr;
+}
+
+void sdl::gl_swap_window_with_damage(const window_t& window, std::span<const SDL_Rect> damage) noexcept {
+    TRACE_ZONE("sdl::gl_swap_window_with_damage");
+    const auto& extensions = swap_extensions();
+    if (extensions.m_egl_swap_buffers_with_damage == nullptr || damage.empty()) {
+        SDL_GL_SwapWindow(window.get());
+        return;
+    }
+
+    // SDL_Rect has the same x, y, width, height layout as the EGLint quadruples.
+    static_assert(sizeof(SDL_Rect) == 4 * sizeof(egl_int_t));
+    extensions.m_egl_swap_buffers_with_damage(extensions.m_egl_display,
+                                              extensions.m_egl_get_current_surface(egl_draw),
+                                              reinterpret_cast<const egl_int_t*>(damage.data()),
+                                              static_cast<egl_int_t>(damage.size()));
+}
+
+int sdl::get_window_refresh_rate(const window_t& window) noexcept {
+    TRACE_ZONE("sdl::get_window_refresh_rate");
+    SDL_DisplayMode display_mode;
+    if (SDL_GetWindowDisplayMode(window.get(), &display_mode) != 0) {
+        return 0;
+    }
+
+    return display_mode.refresh_rate;
+}
+
+SDL_Point sdl::get_mouse_position() noexcept {
+    SDL_Point position;
+    SDL_GetMouseState(&position.x, &position.y);
+    return position;
+}
+
+Uint32 sdl::get_ticks() noexcept {
+    return SDL_GetTicks();
+}
+
 Uint64 sdl::get_performance_frequency() noexcept {
     return SDL_GetPerformanceFrequency();
 }
@@ -116,5 +323,6 @@ Uint64 sdl::get_performance_counter() noexcept {
 }
 
 void sdl::quit() noexcept {
+    TRACE_ZONE("sdl::quit");
     SDL_Quit();
 }
@@ -2,7 +2,9 @@
 #define SDL_HPP
 
 #include <SDL2/SDL.h>
+#include <cstddef>
 #include <memory>
+#include <span>
 
 #include "../utilities.hpp"
 
@@ -27,6 +29,12 @@ void update_window_surface(const window_t& window) noexcept;
 
 [[nodiscard]] pool_event_result pool_event() noexcept;
 
+void pump_events() noexcept;
+
+// Moves up to events.size() queued events into events, oldest first, and returns how many there were.
+// Does not pump, call pump_events() first.
+[[nodiscard]] std::size_t peep_events(std::span<SDL_Event> events) noexcept;
+
 void fill_rect(window_surface_t surface, const SDL_Rect& rect, Uint32 color) noexcept;
 
 void gl_set_attribute(SDL_GLattr attribute, int value) noexcept;
@@ -35,8 +43,30 @@ void gl_set_attribute(SDL_GLattr attribute, int value) noexcept;
 
 void gl_try_use_vsync() noexcept;
 
+void gl_disable_vsync() noexcept;
+
 void gl_swap_window(const window_t& window) noexcept;
 
+// How many frames ago the current back buffer was drawn, read through EGL_EXT_buffer_age or GLX_EXT_buffer_age.
+// 0 if its contents are undefined or the platform cannot tell.
+[[nodiscard]] int gl_back_buffer_age() noexcept;
+
+[[nodiscard]] bool gl_supports_swap_with_damage() noexcept;
+
+// Swaps with EGL_KHR_swap_buffers_with_damage, so the compositor only has to update the damaged rectangles.
+// The rectangles are in GL window coordinates, with the origin in the bottom left corner.
+// A plain swap when not supported.
+void gl_swap_window_with_damage(const window_t& window, std::span<const SDL_Rect> damage) noexcept;
+
+// Returns 0 if the refresh rate is unknown.
+[[nodiscard]] int get_window_refresh_rate(const window_t& window) noexcept;
+
+// Window coordinates of the mouse.
+[[nodiscard]] SDL_Point get_mouse_position() noexcept;
+
+// Milliseconds since SDL was initialized, the clock of the event timestamps.
+Uint32 get_ticks() noexcept;
+
 Uint64 get_performance_frequency() noexcept;
 
 Uint64 get_performance_counter() noexcept;
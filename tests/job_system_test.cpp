@@ -0,0 +1,126 @@
+// Stress test of the work stealing deque and of the job system, including shutting it down while its workers sleep.
+
+#include "test.hpp"
+
+#include "job_system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+// One owner pushing and popping while thieves steal. Every job has to be taken exactly once.
+void test_deque_push_pop_steal() {
+    constexpr std::size_t job_count = 1'000'000;
+    constexpr int thief_count = 3;
+
+    std::vector<job_t> jobs(job_count);
+    std::vector<std::atomic<int>> taken(job_count);
+    job_deque_t deque;
+    std::atomic<bool> pushing = true;
+
+    const auto take = [&](const job_t* job) {
+        taken[static_cast<std::size_t>(job - jobs.data())].fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::jthread> thieves;
+    for (auto i = 0; i < thief_count; i++) {
+        thieves.emplace_back([&] {
+            while (pushing.load(std::memory_order_acquire)) {
+                if (const auto job = deque.steal()) {
+                    take(job);
+                }
+            }
+            while (const auto job = deque.steal()) {
+                take(job);
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < job_count; i++) {
+        while (!deque.push(&jobs[i])) {
+            if (const auto job = deque.pop()) {
+                take(job);
+            }
+        }
+        // The owner takes some back, racing the thieves for the last job.
+        if (i % 3 == 0) {
+            if (const auto job = deque.pop()) {
+                take(job);
+            }
+        }
+    }
+    pushing.store(false, std::memory_order_release);
+    while (const auto job = deque.pop()) {
+        take(job);
+    }
+    thieves.clear();
+
+    for (const auto& count : taken) {
+        TEST_CHECK(count.load(std::memory_order_relaxed) == 1);
+    }
+}
+
+// Jobs that submit jobs of their own, spread over the workers by stealing.
+void test_nested_parallel_for() {
+    job_system_t jobs(4);
+
+    for (auto iteration = 0; iteration < 100; iteration++) {
+        std::vector<std::atomic<int>> visits(10'000);
+        jobs.parallel_for(0, 100, 1, [&](std::size_t begin, std::size_t end) {
+            for (auto outer = begin; outer < end; outer++) {
+                jobs.parallel_for(0, 100, 7, [&](std::size_t inner_begin, std::size_t inner_end) {
+                    for (auto inner = inner_begin; inner < inner_end; inner++) {
+                        visits[outer * 100 + inner].fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+        });
+
+        for (const auto& count : visits) {
+            TEST_CHECK(count.load(std::memory_order_relaxed) == 1);
+        }
+    }
+}
+
+// More jobs than fit in a deque, the ones that do not fit are run right away.
+void test_overflowing_deque() {
+    job_system_t jobs(2);
+    std::atomic<std::uint64_t> sum = 0;
+    const std::size_t count = 4 * job_deque_t::capacity;
+    jobs.parallel_for(0, count, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+            sum.fetch_add(i, std::memory_order_relaxed);
+        }
+    });
+    TEST_CHECK(sum.load() == count * (count - 1) / 2);
+}
+
+// A worker that is about to sleep when the pool is destroyed must still be woken, or the destructor never returns.
+// ctest's timeout catches a hang.
+void test_shutdown() {
+    for (auto iteration = 0; iteration < 2'000; iteration++) {
+        job_system_t jobs(4);
+        if (iteration % 2 == 0) {
+            std::atomic<int> ran = 0;
+            jobs.parallel_for(0, 16, 1, [&](std::size_t, std::size_t) { ran.fetch_add(1, std::memory_order_relaxed); });
+            TEST_CHECK(ran.load() == 16);
+        }
+        if (iteration % 100 == 0) {
+            // Long enough for the workers to run out of spins and wait on the epoch.
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+}
+
+int main() {
+    test_deque_push_pop_steal();
+    test_nested_parallel_for();
+    test_overflowing_deque();
+    test_shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+// Generated scenes are part of the output format: the lines of a fixed preset, count and seed have to hash to the
+// value recorded here, whatever the number of workers.
+
+#include "test.hpp"
+
+#include "job_system.hpp"
+#include "scene_generator.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+// Spans two chunks of the generator, the second one partly.
+constexpr std::size_t line_count = 100'000;
+constexpr std::uint64_t seed = 1;
+
+// Of the uniform preset with the count and seed above. Only changes when the output format does.
+constexpr std::uint64_t expected_hash = 0x6897'3C50'4EFF'A4F3;
+
+// FNV-1a over the bits of every field, so any rounding difference changes the hash.
+class hash_t {
+    std::uint64_t m_value = 0xCBF2'9CE4'8422'2325;
+
+public:
+    void add(std::uint32_t word) noexcept {
+        for (auto byte = 0; byte < 4; byte++) {
+            m_value ^= (word >> (byte * 8)) & 0xFF;
+            m_value *= 0x0000'0100'0000'01B3;
+        }
+    }
+
+    void add(float value) noexcept { add(std::bit_cast<std::uint32_t>(value)); }
+
+    [[nodiscard]] std::uint64_t value() const noexcept { return m_value; }
+};
+
+std::uint64_t hash_lines(const line_storage_t& lines) {
+    hash_t hash;
+    for (const auto& line : lines) {
+        for (auto column = 0; column < 4; column++) {
+            for (auto row = 0; row < 4; row++) {
+                hash.add(line.transform_matrix()[column][row]);
+            }
+        }
+        hash.add(line.color().x);
+        hash.add(line.color().y);
+        hash.add(line.color().z);
+        hash.add(line.start_width());
+        hash.add(line.end_width());
+        hash.add(static_cast<std::uint32_t>(line.blend()));
+        hash.add(static_cast<std::uint32_t>(line.layer()));
+        hash.add(line.spawn_time());
+        hash.add(line.lifetime());
+    }
+    return hash.value();
+}
+
+void test_generated_lines(std::size_t worker_count) {
+    job_system_t jobs(worker_count);
+    const auto lines = generate_lines(generator_preset("uniform"), line_count, seed, jobs);
+    TEST_CHECK(lines.size() == line_count);
+
+    const auto hash = hash_lines(lines);
+    if (hash != expected_hash) {
+        std::cerr << "Lines hash to 0x" << std::hex << std::setfill('0') << std::setw(16) << hash << " with "
+                  << std::dec << worker_count << " workers\n";
+    }
+    TEST_CHECK(hash == expected_hash);
+}
+}
+
+int main() {
+    test_generated_lines(1);
+    test_generated_lines(4);
+    return EXIT_SUCCESS;
+}
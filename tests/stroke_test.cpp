@@ -0,0 +1,151 @@
+// The stroke simplifier on known polylines: every input point stays within tolerance of the simplified polyline, and
+// the stroke starts and ends where the input did.
+
+#include "test.hpp"
+
+#include "stroke.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+namespace {
+// Slack for the float rounding of the cone angles.
+constexpr float distance_epsilon = 1e-3f;
+
+std::vector<glm::vec2> simplify(stroke_simplifier_t& simplifier, const std::vector<glm::vec2>& points) {
+    std::vector<glm::vec2> vertices{points.front()};
+    simplifier.begin(points.front());
+    for (std::size_t i = 1; i < points.size(); i++) {
+        if (const auto vertex = simplifier.add(points[i])) {
+            vertices.push_back(*vertex);
+        }
+    }
+    if (const auto vertex = simplifier.end()) {
+        vertices.push_back(*vertex);
+    }
+    return vertices;
+}
+
+float distance_to_segment(const glm::vec2& point, const glm::vec2& start, const glm::vec2& end) {
+    const auto segment = end - start;
+    const auto length_squared = glm::dot(segment, segment);
+    if (length_squared == 0.0f) {
+        return glm::length(point - start);
+    }
+    const auto t = std::clamp(glm::dot(point - start, segment) / length_squared, 0.0f, 1.0f);
+    return glm::length(point - (start + segment * t));
+}
+
+float distance_to_polyline(const glm::vec2& point, const std::vector<glm::vec2>& vertices) {
+    if (vertices.size() == 1) {
+        return glm::length(point - vertices.front());
+    }
+    auto distance = std::numeric_limits<float>::max();
+    for (std::size_t i = 1; i < vertices.size(); i++) {
+        distance = std::min(distance, distance_to_segment(point, vertices[i - 1], vertices[i]));
+    }
+    return distance;
+}
+
+// Samples the polyline through the corners every spacing pixels, including every corner.
+std::vector<glm::vec2> sample(const std::vector<glm::vec2>& corners, float spacing) {
+    std::vector<glm::vec2> points{corners.front()};
+    for (std::size_t i = 1; i < corners.size(); i++) {
+        const auto segment = corners[i] - corners[i - 1];
+        const auto steps = std::max(1, static_cast<int>(std::ceil(glm::length(segment) / spacing)));
+        for (auto step = 1; step <= steps; step++) {
+            points.push_back(corners[i - 1] + segment * (static_cast<float>(step) / static_cast<float>(steps)));
+        }
+    }
+    return points;
+}
+
+void check_stroke(const std::vector<glm::vec2>& points, float tolerance) {
+    stroke_simplifier_t simplifier(tolerance);
+    const auto vertices = simplify(simplifier, points);
+
+    TEST_CHECK(vertices.front() == points.front());
+    TEST_CHECK(vertices.back() == points.back());
+    TEST_CHECK(simplifier.input_points() == points.size());
+    TEST_CHECK(simplifier.vertices() == vertices.size());
+    for (const auto& point : points) {
+        TEST_CHECK(distance_to_polyline(point, vertices) <= tolerance + distance_epsilon);
+    }
+}
+
+void test_straight_line() {
+    const auto points = sample({{0.0f, 0.0f}, {300.0f, 100.0f}}, 1.0f);
+    stroke_simplifier_t simplifier(0.5f);
+    const auto vertices = simplify(simplifier, points);
+
+    TEST_CHECK(vertices.size() == 2);
+    TEST_CHECK(vertices.front() == points.front());
+    TEST_CHECK(vertices.back() == points.back());
+}
+
+// A right angle keeps its corner, the legs stay single segments.
+void test_corner() {
+    const auto points = sample({{0.0f, 0.0f}, {100.0f, 0.0f}, {100.0f, 100.0f}}, 1.0f);
+    stroke_simplifier_t simplifier(0.5f);
+    const auto vertices = simplify(simplifier, points);
+
+    TEST_CHECK(vertices.size() == 3);
+    TEST_CHECK(glm::length(vertices[1] - glm::vec2(100.0f, 0.0f)) <= 0.5f);
+    check_stroke(points, 0.5f);
+}
+
+void test_zigzag() {
+    std::vector<glm::vec2> corners;
+    for (auto i = 0; i <= 10; i++) {
+        corners.emplace_back(static_cast<float>(i) * 20.0f, i % 2 == 0 ? 0.0f : 15.0f);
+    }
+    for (const auto tolerance : {0.25f, 1.0f, 4.0f}) {
+        check_stroke(sample(corners, 0.75f), tolerance);
+    }
+}
+
+// A circle of radius r sampled every pixel, a larger tolerance needs fewer vertices.
+void test_circle() {
+    constexpr auto radius = 100.0f;
+    std::vector<glm::vec2> points;
+    const auto count = static_cast<int>(2.0f * std::numbers::pi_v<float> * radius);
+    for (auto i = 0; i <= count; i++) {
+        const auto angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(count);
+        points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+
+    std::uint64_t previous_vertices = std::numeric_limits<std::uint64_t>::max();
+    for (const auto tolerance : {0.25f, 1.0f, 4.0f}) {
+        check_stroke(points, tolerance);
+
+        stroke_simplifier_t simplifier(tolerance);
+        static_cast<void>(simplify(simplifier, points));
+        TEST_CHECK(simplifier.vertices() < previous_vertices);
+        TEST_CHECK(simplifier.vertices() < points.size());
+        previous_vertices = simplifier.vertices();
+    }
+}
+
+// A stroke that never leaves its first point is a single vertex.
+void test_single_point() {
+    stroke_simplifier_t simplifier(0.5f);
+    const auto vertices = simplify(simplifier, {{10.0f, 10.0f}, {10.0f, 10.0f}});
+    TEST_CHECK(vertices.size() == 1);
+}
+}
+
+int main() {
+    test_straight_line();
+    test_corner();
+    test_zigzag();
+    test_circle();
+    test_single_point();
+    return EXIT_SUCCESS;
+}
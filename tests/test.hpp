@@ -0,0 +1,16 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <cstdlib>
+#include <iostream>
+
+// The unit tests are plain executables, a failed check reports where it failed and exits with a failure for ctest.
+#define TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+#endif //TEST_HPP
@@ -0,0 +1,183 @@
+// The bookkeeping of the tile cache: baking within the budget, hits, stale tiles, coarser fallbacks and eviction.
+
+#include "test.hpp"
+
+#include "globals.hpp"
+#include "tile_cache.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+
+namespace {
+// The world rectangle of the tiles of a level from first to last, inclusive, shrunk so it does not touch the next ones.
+struct region_t {
+    glm::vec2 m_min;
+    glm::vec2 m_max;
+};
+
+region_t tiles(int level, const glm::ivec2& first, const glm::ivec2& last) {
+    const auto size = tile_key_t{level, {0, 0}}.world_size();
+    return {glm::vec2(first) * size + 1.0f, glm::vec2(last + 1) * size - 1.0f};
+}
+
+tile_plan_t plan(tile_cache_t& cache, const region_t& region, int level, std::size_t bake_budget) {
+    return cache.plan(region.m_min, region.m_max, level, bake_budget, *std::pmr::new_delete_resource());
+}
+
+bool baked(const tile_plan_t& plan, const tile_key_t& key) {
+    return std::ranges::any_of(plan.m_bakes, [&](const tile_bake_t& bake) { return bake.m_key == key; });
+}
+
+int slot_of(const tile_plan_t& plan, const tile_key_t& key) {
+    for (const auto& bake : plan.m_bakes) {
+        if (bake.m_key == key) {
+            return bake.m_slot;
+        }
+    }
+    return -1;
+}
+
+// Whether the atlas rectangle lies within the slot, less the half texel kept from its edges.
+bool within_slot(const tile_cache_t& cache, const tile_draw_t& draw, int slot) {
+    const auto origin = glm::vec2(cache.slot_origin(slot));
+    const auto end = origin + static_cast<float>(tile_resolution);
+    return std::min(draw.m_atlas_rect.x, draw.m_atlas_rect.z) >= origin.x + 0.5f &&
+           std::max(draw.m_atlas_rect.x, draw.m_atlas_rect.z) <= end.x - 0.5f &&
+           std::min(draw.m_atlas_rect.y, draw.m_atlas_rect.w) >= origin.y + 0.5f &&
+           std::max(draw.m_atlas_rect.y, draw.m_atlas_rect.w) <= end.y - 0.5f;
+}
+
+void test_bake_then_hit() {
+    tile_cache_t cache;
+    const auto region = tiles(0, {0, 0}, {2, 1});
+
+    const auto first = plan(cache, region, 0, 64);
+    TEST_CHECK(first.m_bakes.size() == 6);
+    TEST_CHECK(first.m_draws.size() == 6);
+    TEST_CHECK(cache.hit_rate() == 0.0f);
+    TEST_CHECK(cache.complete());
+
+    const auto second = plan(cache, region, 0, 64);
+    TEST_CHECK(second.m_bakes.empty());
+    TEST_CHECK(second.m_draws.size() == 6);
+    TEST_CHECK(cache.hit_rate() == 1.0f);
+    TEST_CHECK(cache.complete());
+    TEST_CHECK(cache.occupancy() * static_cast<float>(cache.slot_count()) == 6.0f);
+}
+
+void test_bake_budget() {
+    tile_cache_t cache;
+    const auto region = tiles(0, {0, 0}, {1, 1});
+
+    const auto first = plan(cache, region, 0, 1);
+    TEST_CHECK(first.m_bakes.size() == 1);
+    // Nothing coarser is baked, the other tiles are left empty.
+    TEST_CHECK(first.m_draws.size() == 1);
+    TEST_CHECK(!cache.complete());
+
+    plan(cache, region, 0, 2);
+    TEST_CHECK(!cache.complete());
+    const auto last = plan(cache, region, 0, 2);
+    TEST_CHECK(last.m_bakes.size() == 1);
+    TEST_CHECK(cache.complete());
+    TEST_CHECK(plan(cache, region, 0, 0).m_draws.size() == 4);
+}
+
+void test_stale_tiles() {
+    tile_cache_t cache;
+    const auto region = tiles(0, {0, 0}, {1, 0});
+    const auto baked_plan = plan(cache, region, 0, 64);
+    const tile_key_t left{0, {0, 0}};
+    const tile_key_t right{0, {1, 0}};
+
+    // Within the left tile only.
+    const auto size = left.world_size();
+    cache.invalidate({size * 0.25f, size * 0.25f}, {size * 0.5f, size * 0.5f});
+
+    // Without a budget the stale tile is still shown, but the cache is not complete.
+    const auto unbaked = plan(cache, region, 0, 0);
+    TEST_CHECK(unbaked.m_bakes.empty());
+    TEST_CHECK(unbaked.m_draws.size() == 2);
+    TEST_CHECK(!cache.complete());
+
+    // It is baked again where it was.
+    const auto rebaked = plan(cache, region, 0, 64);
+    TEST_CHECK(rebaked.m_bakes.size() == 1);
+    TEST_CHECK(baked(rebaked, left));
+    TEST_CHECK(!baked(rebaked, right));
+    TEST_CHECK(slot_of(rebaked, left) == slot_of(baked_plan, left));
+    TEST_CHECK(cache.complete());
+
+    cache.invalidate_all();
+    TEST_CHECK(plan(cache, region, 0, 64).m_bakes.size() == 2);
+}
+
+void test_coarser_fallback() {
+    tile_cache_t cache;
+    const tile_key_t parent{0, {0, 0}};
+    const auto parent_plan = plan(cache, tiles(0, {0, 0}, {0, 0}), 0, 64);
+    const auto parent_slot = slot_of(parent_plan, parent);
+    TEST_CHECK(parent_slot >= 0);
+
+    // The four tiles of the next level inside the parent show its texels until they are baked.
+    const auto fallback = plan(cache, tiles(1, {0, 0}, {1, 1}), 1, 0);
+    TEST_CHECK(fallback.m_bakes.empty());
+    TEST_CHECK(fallback.m_draws.size() == 4);
+    TEST_CHECK(!cache.complete());
+    for (const auto& draw : fallback.m_draws) {
+        TEST_CHECK(within_slot(cache, draw, parent_slot));
+    }
+
+    // Outside of the parent there is nothing to fall back to.
+    TEST_CHECK(plan(cache, tiles(1, {2, 0}, {2, 0}), 1, 0).m_draws.empty());
+}
+
+void test_least_recently_used_eviction() {
+    tile_cache_t cache;
+    const auto slot_count = static_cast<int>(cache.slot_count());
+
+    // Fill the atlas one tile per frame, so the first tile is the least recently used.
+    const tile_key_t first{0, {0, 0}};
+    const auto first_slot = slot_of(plan(cache, tiles(0, {0, 0}, {0, 0}), 0, 1), first);
+    for (auto i = 1; i < slot_count; i++) {
+        plan(cache, tiles(0, {i, 0}, {i, 0}), 0, 1);
+    }
+    TEST_CHECK(cache.occupancy() == 1.0f);
+
+    // Using the first tile again makes the second one the oldest.
+    TEST_CHECK(plan(cache, tiles(0, {0, 0}, {0, 0}), 0, 1).m_bakes.empty());
+
+    const tile_key_t newcomer{0, {0, 1}};
+    const auto newcomer_plan = plan(cache, tiles(0, {0, 1}, {0, 1}), 0, 1);
+    TEST_CHECK(baked(newcomer_plan, newcomer));
+    TEST_CHECK(slot_of(newcomer_plan, newcomer) != first_slot);
+
+    // The evicted tile has to be baked again, the first one is still there.
+    TEST_CHECK(plan(cache, tiles(0, {0, 0}, {0, 0}), 0, 1).m_bakes.empty());
+    TEST_CHECK(plan(cache, tiles(0, {1, 0}, {1, 0}), 0, 1).m_bakes.size() == 1);
+}
+
+// Tiles needed in the same frame are never evicted for each other, the ones that do not fit wait.
+void test_full_atlas() {
+    tile_cache_t cache;
+    const auto slot_count = static_cast<int>(cache.slot_count());
+
+    const auto overfull = plan(cache, tiles(0, {0, 0}, {slot_count, 0}), 0, cache.slot_count() + 1);
+    TEST_CHECK(static_cast<int>(overfull.m_bakes.size()) == slot_count);
+    TEST_CHECK(!cache.complete());
+    TEST_CHECK(cache.occupancy() == 1.0f);
+}
+}
+
+int main() {
+    test_bake_then_hit();
+    test_bake_budget();
+    test_stale_tiles();
+    test_coarser_fallback();
+    test_least_recently_used_eviction();
+    test_full_atlas();
+    return EXIT_SUCCESS;
+}
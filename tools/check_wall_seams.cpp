@@ -0,0 +1,166 @@
+// Checks that the windows of a stitched video wall capture line up, by comparing the luma across every seam between
+// two windows with the luma across the neighbouring columns or rows inside them. A window that shows the wrong part of
+// the canvas, or another frame than its neighbours, shows up as a jump at the seam.
+//
+// Usage: check_wall_seams <columns>x<rows> <stitched.y4m>
+//
+// The capture is the output of stitch_y4m. Exits with 0 if every seam is no sharper than the edges next to it.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using file_t = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+// Pairs of columns or rows on each side of a seam that it is compared with.
+constexpr int comparison_band = 4;
+
+// How much sharper than the edges next to it a seam may be, relative and in luma levels. Bloom is blurred within a
+// window, so it fades a little differently on either side.
+constexpr double max_seam_ratio = 2.0;
+constexpr double max_seam_excess = 2.0;
+
+// The stream header or a frame header, without the newline. False at the end of the stream.
+bool read_line(std::FILE* file, std::string& line) {
+    line.clear();
+    for (auto character = std::fgetc(file); character != '\n'; character = std::fgetc(file)) {
+        if (character == EOF) {
+            return false;
+        }
+        line.push_back(static_cast<char>(character));
+    }
+    return true;
+}
+
+bool parse_size(const std::string& line, int& width, int& height) {
+    std::istringstream tokens(line);
+    std::string token;
+    if (!(tokens >> token) || token != "YUV4MPEG2") {
+        return false;
+    }
+
+    auto chroma_444 = false;
+    while (tokens >> token) {
+        if (token[0] == 'W') {
+            width = std::atoi(token.c_str() + 1);
+        } else if (token[0] == 'H') {
+            height = std::atoi(token.c_str() + 1);
+        } else {
+            chroma_444 |= token == "C444";
+        }
+    }
+    return chroma_444 && width > 0 && height > 0;
+}
+
+// Sum of the luma differences between neighbours across a seam, and across the pairs next to it.
+struct seam_t {
+    bool m_vertical;
+    int m_position;
+    double m_seam = 0.0;
+    double m_neighbours = 0.0;
+};
+}
+
+int main(int argc, char** argv) {
+    auto columns = 0;
+    auto rows = 0;
+    auto length = 0;
+    if (argc != 3 || std::sscanf(argv[1], "%dx%d%n", &columns, &rows, &length) != 2 || argv[1][length] != '\0' ||
+        columns <= 0 || rows <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <columns>x<rows> <stitched.y4m>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    file_t input(std::fopen(argv[2], "rb"), &std::fclose);
+    if (!input) {
+        std::perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    std::string line;
+    auto width = 0;
+    auto height = 0;
+    if (!read_line(input.get(), line) || !parse_size(line, width, height)) {
+        std::cerr << argv[2] << " is not a 4:4:4 Y4M stream" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto tile_width = width / columns;
+    const auto tile_height = height / rows;
+    if (tile_width * columns != width || tile_height * rows != height || tile_width <= 2 * comparison_band ||
+        tile_height <= 2 * comparison_band) {
+        std::cerr << "A " << width << "x" << height << " capture cannot be split into " << columns << "x" << rows
+                  << " windows" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<seam_t> seams;
+    for (auto column = 1; column < columns; column++) {
+        seams.push_back({true, column * tile_width});
+    }
+    for (auto row = 1; row < rows; row++) {
+        seams.push_back({false, row * tile_height});
+    }
+    if (seams.empty()) {
+        std::cerr << "A 1x1 wall has no seams" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Only the luma plane is compared, the chroma planes follow it.
+    const auto plane_size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    std::vector<std::uint8_t> frame(3 * plane_size);
+    const auto luma = [&](int x, int y) { return static_cast<int>(frame[static_cast<std::size_t>(y) * width + x]); };
+    // Difference between the pixel before and at position, along every pixel of the seam.
+    const auto difference = [&](const seam_t& seam, int position) {
+        double sum = 0.0;
+        for (auto i = 0; i < (seam.m_vertical ? height : width); i++) {
+            sum += seam.m_vertical ? std::abs(luma(position, i) - luma(position - 1, i))
+                                   : std::abs(luma(i, position) - luma(i, position - 1));
+        }
+        return sum;
+    };
+
+    auto frames = 0;
+    while (read_line(input.get(), line)) {
+        if (std::fread(frame.data(), 1, frame.size(), input.get()) != frame.size()) {
+            std::cerr << argv[2] << " ends in the middle of frame " << frames << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (auto& seam : seams) {
+            seam.m_seam += difference(seam, seam.m_position);
+            for (auto offset = 1; offset <= comparison_band; offset++) {
+                seam.m_neighbours += difference(seam, seam.m_position - offset) +
+                                     difference(seam, seam.m_position + offset);
+            }
+        }
+        frames++;
+    }
+
+    if (frames == 0) {
+        std::cerr << argv[2] << " has no frames" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto failed = false;
+    for (const auto& seam : seams) {
+        const auto pixels = static_cast<double>(frames) * (seam.m_vertical ? height : width);
+        const auto seam_difference = seam.m_seam / pixels;
+        const auto neighbour_difference = seam.m_neighbours / (pixels * 2 * comparison_band);
+        const auto matches = seam_difference <= neighbour_difference * max_seam_ratio + max_seam_excess;
+        failed |= !matches;
+
+        std::cout << (seam.m_vertical ? "Column " : "Row ") << seam.m_position << ": " << seam_difference
+                  << " across the seam, " << neighbour_difference << " next to it" << (matches ? "" : ", MISMATCH")
+                  << "\n";
+    }
+    std::cout << "Compared " << frames << " frames" << std::endl;
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+// Writes bursts of lines into the shared memory ring of a running fireworks_cpp --ingest <name>.
+//
+// Usage: line_producer <name> [lines per second] [seconds]
+//
+// Lines per second defaults to 1000 and seconds to 10, 0 seconds runs until interrupted.
+
+#include "../src/line_ring.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numbers>
+#include <thread>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <name> [lines per second] [seconds]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto lines_per_second = argc > 2 ? std::atof(argv[2]) : 1000.0;
+    const auto seconds = argc > 3 ? std::atof(argv[3]) : 10.0;
+    if (lines_per_second <= 0.0 || seconds < 0.0) {
+        std::cerr << "Invalid rate or duration" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto ring = line_ring_t::open(argv[1]);
+
+    // Every burst is a ring of rays around a point that moves over a 1280x720 window.
+    constexpr int rays_per_burst = 24;
+    constexpr double golden_angle = 2.0 * std::numbers::pi / (std::numbers::phi * std::numbers::phi);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t produced = 0;
+    std::uint64_t dropped = 0;
+
+    while (true) {
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0.0 && elapsed >= seconds) {
+            break;
+        }
+
+        // Catch up to the rate, then sleep for a millisecond.
+        const auto due = static_cast<std::uint64_t>(elapsed * lines_per_second);
+        while (produced + dropped < due) {
+            const auto index = produced + dropped;
+            const auto burst = static_cast<double>(index / rays_per_burst);
+            const auto ray = static_cast<double>(index % rays_per_burst);
+
+            const auto center_x = 640.0 + 480.0 * std::sin(burst * golden_angle);
+            const auto center_y = 360.0 + 260.0 * std::cos(burst * golden_angle * 0.7);
+            const auto angle = ray / rays_per_burst * 2.0 * std::numbers::pi;
+            const auto length = 60.0 + 40.0 * std::sin(burst);
+
+            line_record_t record{};
+            record.m_start_position[0] = static_cast<float>(center_x + 10.0 * std::cos(angle));
+            record.m_start_position[1] = static_cast<float>(center_y + 10.0 * std::sin(angle));
+            record.m_end_position[0] = static_cast<float>(center_x + length * std::cos(angle));
+            record.m_end_position[1] = static_cast<float>(center_y + length * std::sin(angle));
+            record.m_color[0] = static_cast<float>(0.5 + 0.5 * std::sin(burst));
+            record.m_color[1] = static_cast<float>(0.5 + 0.5 * std::sin(burst + 2.0));
+            record.m_color[2] = static_cast<float>(0.5 + 0.5 * std::sin(burst + 4.0));
+            record.m_start_width = 6.0f;
+            record.m_end_width = 2.0f;
+            record.m_blend = 1; // Additive
+            record.m_layer = static_cast<std::int32_t>(static_cast<std::uint64_t>(burst) % 8);
+
+            if (ring.try_push(record)) {
+                produced++;
+            } else {
+                dropped++;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << "Produced " << produced << " lines, " << dropped << " dropped because the ring was full" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+// Compares the metrics written by fireworks_cpp --benchmark against the checked-in baseline.
+//
+// Usage: perf_compare <baseline.json> <scene> <metrics.json> [--update]
+//
+// The baseline holds an entry per scene and metric:
+//   "lines_1k": {"frames_per_second": {"value": 250, "tolerance": 0.25, "better": "higher"}, ...}
+// A metric regresses when it is worse than value by more than tolerance (a fraction of value). Exact counts such as
+// the GL calls have a tolerance of 0, timings need some room for noise.
+// A value of null has not been recorded yet and fails the comparison. --update writes the measured values into the
+// baseline, keeping the tolerances, so the values always come from a run on the reference machine.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace std::string_view_literals;
+
+// Just enough JSON for the metrics and the baseline: objects, strings, numbers and null.
+struct json_value_t;
+using json_object_t = std::vector<std::pair<std::string, json_value_t>>;
+
+struct json_value_t {
+    std::variant<std::monostate, double, std::string, std::unique_ptr<json_object_t>> m_value;
+
+    [[nodiscard]] bool null() const { return std::holds_alternative<std::monostate>(m_value); }
+    [[nodiscard]] const double* number() const { return std::get_if<double>(&m_value); }
+    [[nodiscard]] const std::string* string() const { return std::get_if<std::string>(&m_value); }
+
+    [[nodiscard]] json_object_t* object() const {
+        const auto object = std::get_if<std::unique_ptr<json_object_t>>(&m_value);
+        return object ? object->get() : nullptr;
+    }
+
+    [[nodiscard]] const json_value_t* find(std::string_view key) const {
+        if (const auto members = object()) {
+            for (const auto& [name, value] : *members) {
+                if (name == key) {
+                    return &value;
+                }
+            }
+        }
+        return nullptr;
+    }
+};
+
+class json_parser_t {
+    std::string_view m_text;
+    std::size_t m_position = 0;
+    std::string_view m_path;
+
+    [[noreturn]] void fail(std::string_view message) const {
+        std::cerr << m_path << ": " << message << " at offset " << m_position << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    void skip_whitespace() {
+        while (m_position < m_text.size() && std::string_view(" \t\r\n").contains(m_text[m_position])) {
+            m_position++;
+        }
+    }
+
+    void expect(char c) {
+        skip_whitespace();
+        if (m_position >= m_text.size() || m_text[m_position] != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        m_position++;
+    }
+
+    std::string parse_string() {
+        expect('"');
+        std::string result;
+        while (m_position < m_text.size() && m_text[m_position] != '"') {
+            if (m_text[m_position] == '\\') {
+                // An escape needs the character it escapes.
+                if (++m_position >= m_text.size()) {
+                    fail("unterminated string");
+                }
+            }
+            result += m_text[m_position++];
+        }
+        expect('"');
+        return result;
+    }
+
+    json_value_t parse_value() {
+        skip_whitespace();
+        if (m_position >= m_text.size()) {
+            fail("unexpected end of file");
+        }
+
+        const auto c = m_text[m_position];
+        if (c == '{') {
+            auto object = std::make_unique<json_object_t>();
+            expect('{');
+            skip_whitespace();
+            if (m_text[m_position] == '}') {
+                m_position++;
+                return {std::move(object)};
+            }
+            while (true) {
+                auto key = parse_string();
+                expect(':');
+                object->emplace_back(std::move(key), parse_value());
+                skip_whitespace();
+                if (m_position < m_text.size() && m_text[m_position] == ',') {
+                    m_position++;
+                    continue;
+                }
+                expect('}');
+                return {std::move(object)};
+            }
+        }
+        if (c == '"') {
+            return {parse_string()};
+        }
+        if (m_text.substr(m_position).starts_with("null"sv)) {
+            m_position += 4;
+            return {};
+        }
+
+        const auto start = m_text.data() + m_position;
+        char* end = nullptr;
+        const auto number = std::strtod(start, &end);
+        if (end == start) {
+            fail("expected a value");
+        }
+        m_position += static_cast<std::size_t>(end - start);
+        return {number};
+    }
+
+public:
+    json_parser_t(std::string_view text, std::string_view path) : m_text(text), m_path(path) {}
+
+    json_value_t parse() {
+        auto value = parse_value();
+        skip_whitespace();
+        if (m_position != m_text.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+};
+
+json_value_t read_json(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const auto text = contents.str();
+
+    return json_parser_t(text, path).parse();
+}
+
+void write_json(std::ostream& stream, const json_value_t& value, int indent) {
+    if (value.null()) {
+        stream << "null";
+    } else if (const auto number = value.number()) {
+        stream << *number;
+    } else if (const auto string = value.string()) {
+        stream << '"' << *string << '"';
+    } else {
+        const auto& members = *value.object();
+        // Metric entries stay on a single line, everything above them is expanded.
+        const auto flat = !members.empty() && members.front().second.object() == nullptr;
+        stream << '{';
+        for (std::size_t i = 0; i < members.size(); i++) {
+            stream << (i == 0 ? "" : ",");
+            if (flat) {
+                stream << (i == 0 ? "" : " ");
+            } else {
+                stream << '\n' << std::string(indent + 2, ' ');
+            }
+            stream << '"' << members[i].first << "\": ";
+            write_json(stream, members[i].second, indent + 2);
+        }
+        if (!flat && !members.empty()) {
+            stream << '\n' << std::string(indent, ' ');
+        }
+        stream << '}';
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4 && !(argc == 5 && argv[4] == "--update"sv)) {
+        std::cerr << "Usage: " << argv[0] << " <baseline.json> <scene> <metrics.json> [--update]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto baseline_path = argv[1];
+    const std::string_view scene = argv[2];
+    const auto update = argc == 5;
+
+    auto baseline = read_json(baseline_path);
+    const auto measured = read_json(argv[3]);
+
+    const auto measured_metrics = measured.find("metrics");
+    if (measured_metrics == nullptr || measured_metrics->object() == nullptr) {
+        std::cerr << argv[3] << ": no metrics object" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto scene_baseline = baseline.find(scene);
+    if (scene_baseline == nullptr || scene_baseline->object() == nullptr) {
+        std::cerr << baseline_path << ": no baseline for scene " << scene << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Scene " << scene << "\n";
+    std::cout << std::left << std::setw(34) << "metric" << std::right << std::setw(14) << "baseline"
+              << std::setw(14) << "measured" << std::setw(14) << "limit" << "  status\n";
+
+    auto regressions = 0;
+    for (auto& [name, entry] : *scene_baseline->object()) {
+        const auto baseline_value = entry.find("value");
+        const auto tolerance = entry.find("tolerance");
+        const auto better = entry.find("better");
+        if (baseline_value == nullptr || (baseline_value->number() == nullptr && !baseline_value->null()) ||
+            tolerance == nullptr ||
+            tolerance->number() == nullptr || better == nullptr || better->string() == nullptr) {
+            std::cerr << baseline_path << ": " << scene << "." << name
+                      << " needs a numeric value and tolerance and a better direction" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const auto recorded = !baseline_value->null();
+        const auto value = recorded ? *baseline_value->number() : 0.0;
+        const auto higher_is_better = *better->string() == "higher";
+        const auto limit = higher_is_better ? value * (1.0 - *tolerance->number())
+                                            : value * (1.0 + *tolerance->number());
+
+        const auto measured_value = measured_metrics->find(name);
+        if (measured_value == nullptr || measured_value->number() == nullptr) {
+            std::cout << std::left << std::setw(34) << name << std::right << std::setw(14) << value
+                      << std::setw(14) << "-" << std::setw(14) << limit << "  MISSING\n";
+            regressions++;
+            continue;
+        }
+
+        const auto current = *measured_value->number();
+        if (!recorded) {
+            std::cout << std::left << std::setw(34) << name << std::right << std::setw(14) << "-" << std::setw(14)
+                      << current << std::setw(14) << "-" << "  UNRECORDED\n";
+            if (!update) {
+                regressions++;
+            }
+        }
+
+        const auto regressed = recorded && (higher_is_better ? current < limit : current > limit);
+        const auto change = value != 0.0 ? (current - value) / std::abs(value) * 100.0 : 0.0;
+
+        if (recorded) {
+            std::cout << std::left << std::setw(34) << name << std::right << std::setw(14) << value << std::setw(14)
+                      << current << std::setw(14) << limit << "  " << (regressed ? "REGRESSED " : "ok ")
+                      << std::showpos << std::fixed << std::setprecision(1) << change << "%" << std::noshowpos
+                      << std::defaultfloat << std::setprecision(6) << "\n";
+        }
+
+        if (regressed) {
+            regressions++;
+        }
+
+        if (update) {
+            // The tolerance and direction stay, only the value follows the new measurement.
+            for (auto& [key, field] : *entry.object()) {
+                if (key == "value") {
+                    field.m_value = current;
+                }
+            }
+        }
+    }
+
+    if (update) {
+        std::ofstream file(baseline_path, std::ios::binary);
+        write_json(file, baseline, 0);
+        file << "\n";
+        std::cout << "Updated " << baseline_path << "\n";
+        return file.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (regressions > 0) {
+        std::cout << regressions << " metric(s) regressed against or missing from " << baseline_path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
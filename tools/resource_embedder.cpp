@@ -6,22 +6,54 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <cstdlib>
 #include <algorithm>
+#include <array>
+#include <regex>
+#include <vector>
 
 
-void embed_resource(std::ofstream& resources_cpp_file,
-                    std::stringstream& resources_hpp_file_contents,
-                    std::string path) {
-    std::string filename = path.substr(path.find_last_of("/\\") + 1);
-    std::ranges::replace(filename, ' ', '_');
-    std::ranges::replace(filename, '.', '_');
+// How a GLSL type is handed to OpenGL from C++.
+struct glsl_type_t {
+    std::string_view m_glsl_name;
+    std::string_view m_cpp_type;
+    // Components per location and their type, as passed to glVertexAttribPointer.
+    int m_size;
+    std::string_view m_gl_type;
+    // Attribute locations taken up, a matrix takes one per column.
+    int m_locations;
+};
 
-    resources_hpp_file_contents << "extern const std::string_view " << filename << ";\n";
+constexpr std::array glsl_types = {
+    glsl_type_t{"float", "GLfloat", 1, "GL_FLOAT", 1},
+    glsl_type_t{"vec2", "glm::vec2", 2, "GL_FLOAT", 1},
+    glsl_type_t{"vec3", "glm::vec3", 3, "GL_FLOAT", 1},
+    glsl_type_t{"vec4", "glm::vec4", 4, "GL_FLOAT", 1},
+    glsl_type_t{"mat4", "glm::mat4", 4, "GL_FLOAT", 4},
+    glsl_type_t{"int", "GLint", 1, "GL_INT", 1},
+    glsl_type_t{"uint", "GLuint", 1, "GL_UNSIGNED_INT", 1},
+};
 
-    resources_cpp_file << "const std::string_view resources::" << filename << " = \"";
+const glsl_type_t* find_glsl_type(std::string_view name) {
+    const auto it = std::ranges::find(glsl_types, name, &glsl_type_t::m_glsl_name);
+    return it != glsl_types.end() ? &*it : nullptr;
+}
 
+bool is_sampler(std::string_view type) {
+    return type.starts_with("sampler") || type.starts_with("isampler") || type.starts_with("usampler");
+}
+
+[[noreturn]] void shader_error(const std::string& path, int line_number, std::string_view message) {
+    std::cerr << path << ":" << line_number << ": " << message << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+// Uniform blocks by name. Every shader declaring a block gets the same binding point for it.
+std::vector<std::string> uniform_blocks;
+
+std::string read_file(const std::string& path) {
     std::ifstream file(path, std::ios::binary);
 
     if (!file.is_open()) {
@@ -29,9 +61,195 @@ void embed_resource(std::ofstream& resources_cpp_file,
         std::exit(EXIT_FAILURE);
     }
 
+    std::stringstream file_contents;
+    file_contents << file.rdbuf();
+    return file_contents.str();
+}
+
+// Replaces #include "file" lines with the file, relative to the shader. GLSL has no includes of its own.
+std::string expand_includes(const std::string& path, const std::string& source) {
+    static const std::regex include_regex(R"re(^\s*#include\s+"([^"]+)"\s*\r?$)re");
+
+    const auto directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+    std::stringstream output;
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (std::smatch match; std::regex_match(line, match, include_regex)) {
+            const auto include_path = directory + match[1].str();
+            output << expand_includes(include_path, read_file(include_path));
+        } else {
+            output << line << "\n";
+        }
+    }
+    return output.str();
+}
+
+std::string resource_name(const std::string& path) {
+    std::string filename = path.substr(path.find_last_of("/\\") + 1);
+    std::ranges::replace(filename, ' ', '_');
+    std::ranges::replace(filename, '.', '_');
+    return filename;
+}
+
+// Gives every vertex input, fragment output, sampler, uniform block and shader storage block an explicit layout, and
+// writes a struct describing the interface of the shader to the bindings header. Returns the source with the layouts
+// in it.
+std::string reflect_shader(const std::string& path, const std::string& source, std::stringstream& bindings) {
+    const auto vertex_shader = path.ends_with(".vsh");
+
+    // Top level declarations only, one per line. A comment saying Instanced marks a per-instance attribute.
+    static const std::regex declaration_regex(R"(^(\s*)(in|out|uniform)\s+(\w+)\s+(\w+)\s*;\s*(//.*)?$)");
+    static const std::regex block_regex(R"(^(\s*)uniform\s+(\w+)\s*(\{.*)?$)");
+    static const std::regex storage_block_regex(
+            R"(^(\s*)((?:(?:readonly|writeonly|restrict|coherent)\s+)*)buffer\s+(\w+)\s*(\{.*)?$)");
+    // Anything else that starts like an interface declaration, e.g. with an interpolation qualifier, an array or
+    // several names. It would get neither a layout nor a binding, so it is rejected instead of passed through.
+    static const std::regex interface_regex(
+            R"(^\s*(?:(?:flat|smooth|noperspective|centroid|sample|invariant|precise|highp|mediump|lowp)\s+)*)"
+            R"((?:in|out|uniform)\b)");
+    static const std::regex layout_regex(R"(^\s*layout\s*\()");
+    // The work group size of a compute shader is the one layout written by hand, the dispatch is sized from it.
+    static const std::regex local_size_regex(R"(^\s*layout\s*\(\s*local_size_x\s*=\s*(\d+)\s*\)\s*in\s*;)");
+
+    std::stringstream output;
+    std::stringstream members;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    auto attribute_location = 0;
+    auto output_location = 0;
+    auto sampler_binding = 0;
+    auto storage_block_binding = 0;
+    auto depth = 0;
+    auto line_number = 0;
+
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        std::smatch match;
+        if (depth == 0 && std::regex_match(line, match, local_size_regex)) {
+            members << "    static constexpr GLuint local_size_x = " << match[1].str() << ";\n";
+            output << line << "\n";
+            continue;
+        }
+
+        if (depth == 0 && std::regex_search(line, layout_regex)) {
+            shader_error(path, line_number, "layouts are assigned by resource_embedder, remove it");
+        }
+
+        if (depth == 0 && std::regex_match(line, match, storage_block_regex)) {
+            members << "    static constexpr gl::storage_block_binding_t " << match[3].str() << "{"
+                    << storage_block_binding << "};\n";
+            depth += static_cast<int>(std::ranges::count(line, '{')) - static_cast<int>(std::ranges::count(line, '}'));
+            output << match[1].str() << "layout(std430, binding = " << storage_block_binding++ << ") "
+                   << line.substr(match[1].length()) << "\n";
+            continue;
+        }
+
+        if (depth == 0 && std::regex_match(line, match, block_regex)) {
+            const auto name = match[2].str();
+            auto binding = std::ranges::find(uniform_blocks, name) - uniform_blocks.begin();
+            if (binding == static_cast<std::ptrdiff_t>(uniform_blocks.size())) {
+                uniform_blocks.push_back(name);
+            }
+
+            members << "    static constexpr gl::uniform_block_binding_t " << name << "{" << binding << "};\n";
+            depth += static_cast<int>(std::ranges::count(line, '{'));
+            output << match[1].str() << "layout(std140, binding = " << binding << ") "
+                   << line.substr(match[1].length()) << "\n";
+            continue;
+        }
+
+        if (depth == 0 && !std::regex_match(line, match, declaration_regex) &&
+            std::regex_search(line, interface_regex)) {
+            shader_error(path, line_number,
+                         "cannot parse the declaration, write it as <in|out|uniform> <type> <name>; on its own line");
+        }
+
+        if (depth != 0 || !std::regex_match(line, match, declaration_regex)) {
+            depth += static_cast<int>(std::ranges::count(line, '{')) - static_cast<int>(std::ranges::count(line, '}'));
+            output << line << "\n";
+            continue;
+        }
+
+        const auto indentation = match[1].str();
+        const auto qualifier = match[2].str();
+        const auto type_name = match[3].str();
+        const auto name = match[4].str();
+        const auto instanced = match[5].str().find("Instanced") != std::string::npos;
+        const auto* type = find_glsl_type(type_name);
+
+        std::string layout;
+        if (qualifier == "uniform") {
+            if (is_sampler(type_name)) {
+                layout = "layout(binding = " + std::to_string(sampler_binding) + ") ";
+                members << "    static constexpr gl::sampler_binding_t " << name << "{" << sampler_binding << "};\n";
+                sampler_binding++;
+            } else if (type != nullptr) {
+                // Explicit uniform locations are 4.3, the location is looked up by this name once at startup.
+                members << "    static constexpr gl::uniform_binding_t<" << type->m_cpp_type << "> " << name
+                        << "{\"" << name << "\"};\n";
+            } else {
+                shader_error(path, line_number, "unsupported uniform type " + type_name);
+            }
+        } else if (qualifier == "in" && vertex_shader) {
+            if (type == nullptr) {
+                shader_error(path, line_number, "unsupported attribute type " + type_name);
+            }
+            layout = "layout(location = " + std::to_string(attribute_location) + ") ";
+            members << "    static constexpr gl::attribute_binding_t<" << type->m_cpp_type << ", " << type->m_size
+                    << ", " << type->m_gl_type << ", " << (instanced ? "true" : "false") << "> " << name << "{"
+                    << attribute_location << "};\n";
+            attribute_location += type->m_locations;
+        } else if (qualifier == "out" && !vertex_shader) {
+            layout = "layout(location = " + std::to_string(output_location++) + ") ";
+        } else {
+            // Between the stages, matched by name.
+            (qualifier == "in" ? inputs : outputs).push_back("{\"" + name + "\"sv, \"" + type_name + "\"sv}");
+        }
+
+        output << indentation << layout << line.substr(indentation.size()) << "\n";
+    }
+
+    const auto write_varyings = [&](std::string_view member, const std::vector<std::string>& varyings) {
+        bindings << "    static constexpr std::array<gl::varying_t, " << varyings.size() << "> " << member << "{{";
+        for (std::size_t i = 0; i < varyings.size(); i++) {
+            bindings << (i == 0 ? "" : ", ") << varyings[i];
+        }
+        bindings << "}};\n";
+    };
+
+    bindings << "struct " << resource_name(path) << " {\n" << members.str();
+    write_varyings("inputs", inputs);
+    write_varyings("outputs", outputs);
+    bindings << "};\n\n";
+
+    return output.str();
+}
+
+void embed_resource(std::ofstream& resources_cpp_file,
+                    std::stringstream& resources_hpp_file_contents,
+                    std::stringstream& bindings_hpp_file_contents,
+                    std::string path) {
+    const auto filename = resource_name(path);
 
-    char c;
-    while (file >> std::noskipws >> c) {
+    resources_hpp_file_contents << "extern const std::string_view " << filename << ";\n";
+
+    resources_cpp_file << "const std::string_view resources::" << filename << " = \"";
+
+    auto contents = read_file(path);
+
+    if (path.ends_with(".vsh") || path.ends_with(".fsh") || path.ends_with(".csh")) {
+        contents = reflect_shader(path, expand_includes(path, contents), bindings_hpp_file_contents);
+    }
+
+    for (const auto c : contents) {
         switch (c) {
             case '\r':
                 resources_cpp_file << "\\r";
@@ -41,6 +259,14 @@ void embed_resource(std::ofstream& resources_cpp_file,
                 resources_cpp_file << "\\n";
                 break;
 
+            case '"':
+                resources_cpp_file << "\\\"";
+                break;
+
+            case '\\':
+                resources_cpp_file << "\\\\";
+                break;
+
             default:
                 resources_cpp_file << c;
                 break;
@@ -50,8 +276,34 @@ void embed_resource(std::ofstream& resources_cpp_file,
     resources_cpp_file << "\";\n";
 }
 
+// Only writes the file when it changed, so the files including it are not recompiled.
+bool write_if_changed(const char* path, const std::string& contents) {
+    if (std::ifstream file_in(path, std::ios::binary); file_in.is_open()) {
+        std::stringstream old_contents;
+        old_contents << file_in.rdbuf();
+
+        if (old_contents.str() == contents) {
+            std::cout << path << " has not changed." << std::endl;
+            return true;
+        }
+
+        std::cout << path << " has changed. Generating" << std::endl;
+    } else {
+        std::cout << path << " does not exist. Generating..." << std::endl;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file " << path << std::endl;
+        return false;
+    }
+
+    file << contents;
+    return true;
+}
+
 int main(int argc, char** argv) {
-    assert(argc > 3);
+    assert(argc > 4);
 
     auto resource_hpp_path = argv[1];
     std::stringstream resource_hpp_file_contents;
@@ -59,8 +311,11 @@ int main(int argc, char** argv) {
     auto resource_cpp_path = argv[2];
     std::ofstream resource_cpp_file(resource_cpp_path, std::ios::binary);
 
+    auto bindings_hpp_path = argv[3];
+    std::stringstream bindings_hpp_file_contents;
+
     if (!resource_cpp_file.is_open()) {
-        std::cerr << "Failed to open file " << resource_hpp_path << std::endl;
+        std::cerr << "Failed to open file " << resource_cpp_path << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -77,9 +332,18 @@ int main(int argc, char** argv) {
             << "using namespace std::string_view_literals;\n" //
             << "namespace resources {\n";
 
-    for (int i = 3; i < argc; i++) {
+    bindings_hpp_file_contents //
+            << "// This file is auto-generated by resource_embedder\n" //
+            << "#ifndef SHADER_BINDINGS_HPP\n" //
+            << "#define SHADER_BINDINGS_HPP\n" //
+            << "#include \"wrappers/opengl/shader_binding.hpp\"\n" //
+            << "#include <array>\n" //
+            << "namespace shader_bindings {\n" //
+            << "using namespace std::string_view_literals;\n\n";
+
+    for (int i = 4; i < argc; i++) {
         std::cout << "Processing file " << argv[i] << std::endl;
-        embed_resource(resource_cpp_file, resource_hpp_file_contents, argv[i]);
+        embed_resource(resource_cpp_file, resource_hpp_file_contents, bindings_hpp_file_contents, argv[i]);
     }
 
     // Epilog
@@ -87,30 +351,20 @@ int main(int argc, char** argv) {
             << "}\n" //
             << "#endif\n";
 
-    std::string resource_hpp_file_contents_string = resource_hpp_file_contents.str();
-    if (std::ifstream resource_hpp_file_in(resource_hpp_path, std::ios::binary); resource_hpp_file_in.is_open()) {
-        std::stringstream old_resource_hpp_file_contents;
-        old_resource_hpp_file_contents << resource_hpp_file_in.rdbuf();
-
-        // We are the same don't update this file.
-        // This means that we don't need to recompile other files than the resource cpp file.
-        if (std::string old_resource_hpp_file_contents_string = old_resource_hpp_file_contents.str();
-            old_resource_hpp_file_contents_string == resource_hpp_file_contents_string) {
-            std::cout << resource_hpp_path << " has not changed." << std::endl;
-            return EXIT_SUCCESS;
-        }
-
-        std::cout << resource_hpp_path << " has changed. Generating" << std::endl;
-    } else {
-        std::cout << resource_hpp_path << " does not exist. Generating..." << std::endl;
+    // The binding point of every uniform block, the same in every shader.
+    bindings_hpp_file_contents << "namespace blocks {\n";
+    for (std::size_t i = 0; i < uniform_blocks.size(); i++) {
+        bindings_hpp_file_contents << "constexpr gl::uniform_block_binding_t " << uniform_blocks[i] << "{" << i
+                                   << "};\n";
     }
+    bindings_hpp_file_contents << "}\n";
 
-    // There are changes.
-    // A recompile is necessary.
-    std::ofstream resource_hpp_file(resource_hpp_path, std::ios::binary);
-    if (!resource_hpp_file.is_open()) {
-        std::cerr << "Failed to open file " << resource_hpp_path << std::endl;
-    }
+    bindings_hpp_file_contents //
+            << "}\n" //
+            << "#endif\n";
 
-    resource_hpp_file << resource_hpp_file_contents_string;
+    if (!write_if_changed(resource_hpp_path, resource_hpp_file_contents.str()) ||
+        !write_if_changed(bindings_hpp_path, bindings_hpp_file_contents.str())) {
+        return EXIT_FAILURE;
+    }
 }
@@ -0,0 +1,142 @@
+// Joins the Y4M captures of the windows of a video wall into one Y4M of the whole canvas.
+//
+// Usage: stitch_y4m <columns>x<rows> <output.y4m> <captures...>
+//
+// The captures are given row by row, starting at the top left, and must all be 4:4:4 of the same size and frame rate,
+// as fireworks_cpp --capture writes them. Stops at the end of the shortest capture.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using file_t = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+// The stream header or a frame header, without the newline. False at the end of the stream.
+bool read_line(std::FILE* file, std::string& line) {
+    line.clear();
+    for (auto character = std::fgetc(file); character != '\n'; character = std::fgetc(file)) {
+        if (character == EOF) {
+            return false;
+        }
+        line.push_back(static_cast<char>(character));
+    }
+    return true;
+}
+
+struct stream_header_t {
+    int m_width = 0;
+    int m_height = 0;
+    // Everything after the size, passed on to the output as is.
+    std::string m_parameters;
+};
+
+bool parse_header(const std::string& line, stream_header_t& header) {
+    std::istringstream tokens(line);
+    std::string token;
+    if (!(tokens >> token) || token != "YUV4MPEG2") {
+        return false;
+    }
+
+    auto chroma_444 = false;
+    while (tokens >> token) {
+        if (token[0] == 'W') {
+            header.m_width = std::atoi(token.c_str() + 1);
+        } else if (token[0] == 'H') {
+            header.m_height = std::atoi(token.c_str() + 1);
+        } else {
+            chroma_444 |= token == "C444";
+            header.m_parameters += " " + token;
+        }
+    }
+    return chroma_444 && header.m_width > 0 && header.m_height > 0;
+}
+}
+
+int main(int argc, char** argv) {
+    auto columns = 0;
+    auto rows = 0;
+    auto length = 0;
+    if (argc < 4 || std::sscanf(argv[1], "%dx%d%n", &columns, &rows, &length) != 2 || argv[1][length] != '\0' ||
+        columns <= 0 || rows <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <columns>x<rows> <output.y4m> <captures...>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (argc - 3 != columns * rows) {
+        std::cerr << "A " << columns << "x" << rows << " wall needs " << columns * rows << " captures, not "
+                  << argc - 3 << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<file_t> inputs;
+    stream_header_t header;
+    std::string line;
+    for (auto i = 3; i < argc; i++) {
+        auto& input = inputs.emplace_back(std::fopen(argv[i], "rb"), &std::fclose);
+        if (!input) {
+            std::perror(argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        stream_header_t input_header;
+        if (!read_line(input.get(), line) || !parse_header(line, input_header)) {
+            std::cerr << argv[i] << " is not a 4:4:4 Y4M stream" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (i == 3) {
+            header = input_header;
+        } else if (input_header.m_width != header.m_width || input_header.m_height != header.m_height ||
+                   input_header.m_parameters != header.m_parameters) {
+            std::cerr << argv[i] << " does not match the size or format of " << argv[3] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    file_t output(std::fopen(argv[2], "wb"), &std::fclose);
+    if (!output) {
+        std::perror(argv[2]);
+        return EXIT_FAILURE;
+    }
+    std::fprintf(output.get(), "YUV4MPEG2 W%d H%d%s\n", header.m_width * columns, header.m_height * rows,
+                 header.m_parameters.c_str());
+
+    // Every plane of the output has the rows of all windows side by side, so the whole frame is read first.
+    const auto width = static_cast<std::size_t>(header.m_width);
+    const auto height = static_cast<std::size_t>(header.m_height);
+    const auto frame_size = 3 * width * height;
+    std::vector<std::uint8_t> frame(inputs.size() * frame_size);
+
+    auto frames = 0;
+    while (true) {
+        // A capture cut short ends the stitched one too.
+        for (std::size_t i = 0; i < inputs.size(); i++) {
+            if (!read_line(inputs[i].get(), line)) {
+                std::clog << "Stitched " << frames << " frames" << std::endl;
+                return EXIT_SUCCESS;
+            }
+            if (std::fread(&frame[i * frame_size], 1, frame_size, inputs[i].get()) != frame_size) {
+                std::cerr << argv[3 + i] << " ends in the middle of frame " << frames << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::fputs("FRAME\n", output.get());
+        for (std::size_t plane = 0; plane < 3; plane++) {
+            for (std::size_t row = 0; row < static_cast<std::size_t>(rows); row++) {
+                for (std::size_t y = 0; y < height; y++) {
+                    for (std::size_t column = 0; column < static_cast<std::size_t>(columns); column++) {
+                        const auto input = row * static_cast<std::size_t>(columns) + column;
+                        std::fwrite(&frame[input * frame_size + (plane * height + y) * width], 1, width,
+                                    output.get());
+                    }
+                }
+            }
+        }
+        frames++;
+    }
+}
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Renders a video wall on this machine, one headless fireworks_cpp per window, and stitches their captures into one
+# Y4M of the whole canvas.
+#
+# Usage: video_wall_capture.sh <build directory> <columns>x<rows> <frames> <output.y4m> [fireworks_cpp options]
+#
+# The options go to every window, e.g. --generate tapers --seed 7. Without a display, run with
+# SDL_VIDEODRIVER=offscreen. "ctest -L video_wall" does the same for a 2x2 wall and checks that its windows line up.
+
+set -eu
+
+if [ $# -lt 4 ]; then
+    echo "Usage: $0 <build directory> <columns>x<rows> <frames> <output.y4m> [fireworks_cpp options]" >&2
+    exit 1
+fi
+
+build=$1
+grid=$2
+frames=$3
+output=$4
+shift 4
+
+columns=${grid%x*}
+rows=${grid#*x}
+name=/fireworks_wall_$$
+captures=$(mktemp -d)
+trap 'rm -rf "$captures"' EXIT
+
+pids=
+tiles=
+row=0
+while [ "$row" -lt "$rows" ]; do
+    column=0
+    while [ "$column" -lt "$columns" ]; do
+        tile=$captures/tile_${column}_${row}.y4m
+        "$build/fireworks_cpp" --headless --offline --quit-after "$frames" --capture "$tile" \
+            --wall "$name" --wall-grid "$grid" --wall-tile "$column,$row" "$@" &
+        pids="$pids $!"
+        tiles="$tiles $tile"
+        column=$((column + 1))
+    done
+    row=$((row + 1))
+done
+
+status=0
+for pid in $pids; do
+    wait "$pid" || status=1
+done
+if [ "$status" -ne 0 ]; then
+    echo "A window of the video wall failed" >&2
+    exit 1
+fi
+
+# shellcheck disable=SC2086
+"$build/stitch_y4m" "$grid" "$output" $tiles